@@ -0,0 +1,276 @@
+#include "sdkconfig.h"
+
+#if CONFIG_ALARM
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "alarm.h"
+#include "lvgl_screen_ui.h"
+#include "protocols/telemetry.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+#define ALARM_TASK_STACK_SIZE   3072
+#define ALARM_QUEUE_LEN         8
+#define ALARM_TEXT_MAX          48
+
+#if CONFIG_ALARM_GPIO_ACTIVE_HIGH
+#define ALARM_GPIO_LEVEL(on)    ((on) ? 1 : 0)
+#else
+#define ALARM_GPIO_LEVEL(on)    ((on) ? 0 : 1)
+#endif
+
+static const char *TAG = "alarm";
+
+// 状态变化事件：由判定路径入队，告警任务发送网络消息
+typedef struct {
+    uint32_t sample_ms;      // 触发样本的到达时刻
+    int32_t  value;
+    uint16_t gpio_ms;        // 判定路径上写 GPIO 时已经过的时间
+    uint8_t  sensor_id;
+    bool     active;
+} alarm_event_t;
+
+typedef struct {
+    bool     active;
+    uint32_t raised_ms;
+} alarm_state_t;
+
+static alarm_config_t g_config[SENSOR_ID_MAX];
+// 只由该传感器的生产任务读写
+static alarm_state_t g_state[SENSOR_ID_MAX];
+static uint32_t g_active_mask = 0;
+static alarm_latency_t g_latency;
+static bool g_ui_pending = false;
+static uint32_t g_ui_pending_ms;     // 尚未刷出的最早一次状态变化的样本时刻
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t g_events = NULL;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticQueue_t g_events_struct;
+static uint8_t g_events_storage[ALARM_QUEUE_LEN * sizeof(alarm_event_t)];
+static StackType_t g_task_stack[ALARM_TASK_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// 记录一次延迟，超出预算返回 true；调用者持有 g_lock
+static bool latency_record(uint32_t *last, uint32_t *max, uint32_t ms)
+{
+    *last = ms;
+    if (ms > *max) {
+        *max = ms;
+    }
+    if (ms > CONFIG_ALARM_LATENCY_BUDGET_MS) {
+        g_latency.over_budget++;
+        return true;
+    }
+    return false;
+}
+
+void alarm_evaluate(const sensor_sample_t *sample)
+{
+    if (sample->sensor_id >= SENSOR_ID_MAX || sample->channel != SENSOR_CH_HCHO ||
+        !(sample->flags & SAMPLE_FLAG_VALID) || (sample->flags & SAMPLE_FLAG_WARMING)) {
+        return;
+    }
+    uint8_t id = sample->sensor_id;
+    alarm_state_t *st = &g_state[id];
+
+    portENTER_CRITICAL(&g_lock);
+    alarm_config_t cfg = g_config[id];
+    portEXIT_CRITICAL(&g_lock);
+
+    // 滞回：高于触发阈值即告警；回落到解除阈值以下且已保持足够时间才解除
+    bool next = st->active;
+    if (!st->active && sample->value >= cfg.raise_level) {
+        next = true;
+        st->raised_ms = sample->timestamp_ms;
+    } else if (st->active && sample->value <= cfg.clear_level &&
+               sample->timestamp_ms - st->raised_ms >= cfg.min_hold_ms) {
+        next = false;
+    }
+    if (next == st->active) {
+        return;
+    }
+    st->active = next;
+
+    portENTER_CRITICAL(&g_lock);
+    if (next) {
+        g_active_mask |= 1U << id;
+    } else {
+        g_active_mask &= ~(1U << id);
+    }
+#if CONFIG_ALARM_GPIO >= 0
+    // 在锁内写，多个生产任务同时切换时输出与位图保持一致
+    gpio_set_level(CONFIG_ALARM_GPIO, ALARM_GPIO_LEVEL(g_active_mask != 0));
+#endif
+    uint32_t gpio_ms = now_ms() - sample->timestamp_ms;
+    g_latency.transitions++;
+    latency_record(&g_latency.gpio_last_ms, &g_latency.gpio_max_ms, gpio_ms);
+    if (!g_ui_pending) {
+        g_ui_pending = true;
+        g_ui_pending_ms = sample->timestamp_ms;
+    }
+    portEXIT_CRITICAL(&g_lock);
+
+    alarm_event_t evt = {
+        .sample_ms = sample->timestamp_ms,
+        .value = sample->value,
+        .gpio_ms = (uint16_t)MIN(gpio_ms, UINT16_MAX),
+        .sensor_id = id,
+        .active = next,
+    };
+    if (xQueueSend(g_events, &evt, 0) != pdTRUE) {
+        portENTER_CRITICAL(&g_lock);
+        g_latency.net_failed++;
+        portEXIT_CRITICAL(&g_lock);
+    }
+    lvgl_ui_notify();
+}
+
+static void alarm_task(void *pvParameters)
+{
+    alarm_event_t evt;
+    char text[ALARM_TEXT_MAX];
+    while (1) {
+        xQueueReceive(g_events, &evt, portMAX_DELAY);
+        int len = snprintf(text, sizeof(text), "%s,%s,%ld,%lu", sensor_id_name(evt.sensor_id),
+                           evt.active ? "raised" : "cleared", (long)sensor_hcho_to_ugm3(evt.value),
+                           (unsigned long)evt.sample_ms);
+        bool sent = telemetry_publish_alarm(text, (size_t)MIN(len, (int)sizeof(text) - 1));
+        uint32_t net_ms = now_ms() - evt.sample_ms;
+
+        bool late = false;
+        portENTER_CRITICAL(&g_lock);
+        if (sent) {
+            late = latency_record(&g_latency.net_last_ms, &g_latency.net_max_ms, net_ms);
+        } else {
+            g_latency.net_failed++;
+        }
+        portEXIT_CRITICAL(&g_lock);
+
+        if (evt.active) {
+            ESP_LOGW(TAG, "%s raised at %ld ug/m3: gpio %u ms, network %s %lu ms%s", sensor_id_name(evt.sensor_id),
+                     (long)sensor_hcho_to_ugm3(evt.value), evt.gpio_ms, sent ? "sent" : "failed",
+                     (unsigned long)net_ms, late ? " (over budget)" : "");
+        } else {
+            ESP_LOGI(TAG, "%s cleared at %ld ug/m3: gpio %u ms, network %s %lu ms%s", sensor_id_name(evt.sensor_id),
+                     (long)sensor_hcho_to_ugm3(evt.value), evt.gpio_ms, sent ? "sent" : "failed",
+                     (unsigned long)net_ms, late ? " (over budget)" : "");
+        }
+    }
+}
+
+bool alarm_set_config(sensor_id_t id, const alarm_config_t *cfg)
+{
+    if (id >= SENSOR_ID_MAX || cfg->clear_level >= cfg->raise_level) {
+        return false;
+    }
+    portENTER_CRITICAL(&g_lock);
+    g_config[id] = *cfg;
+    portEXIT_CRITICAL(&g_lock);
+    return true;
+}
+
+bool alarm_get_config(sensor_id_t id, alarm_config_t *out)
+{
+    if (id >= SENSOR_ID_MAX) {
+        return false;
+    }
+    portENTER_CRITICAL(&g_lock);
+    *out = g_config[id];
+    portEXIT_CRITICAL(&g_lock);
+    return true;
+}
+
+uint32_t alarm_active_mask(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    uint32_t mask = g_active_mask;
+    portEXIT_CRITICAL(&g_lock);
+    return mask;
+}
+
+void alarm_note_displayed(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    bool pending = g_ui_pending;
+    uint32_t ui_ms = now_ms() - g_ui_pending_ms;
+    bool late = false;
+    if (pending) {
+        g_ui_pending = false;
+        late = latency_record(&g_latency.ui_last_ms, &g_latency.ui_max_ms, ui_ms);
+    }
+    portEXIT_CRITICAL(&g_lock);
+    if (late) {
+        ESP_LOGW(TAG, "Banner shown %lu ms after sample (over budget)", (unsigned long)ui_ms);
+    } else if (pending) {
+        ESP_LOGI(TAG, "Banner shown %lu ms after sample", (unsigned long)ui_ms);
+    }
+}
+
+void alarm_get_latency(alarm_latency_t *out)
+{
+    portENTER_CRITICAL(&g_lock);
+    *out = g_latency;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void alarm_init(void)
+{
+    _Static_assert(CONFIG_ALARM_CLEAR_UGM3 < CONFIG_ALARM_RAISE_UGM3, "ALARM_CLEAR_UGM3 must be below ALARM_RAISE_UGM3");
+    const alarm_config_t defaults = {
+        .raise_level = sensor_hcho_ugm3_to_ppb(CONFIG_ALARM_RAISE_UGM3 * SENSOR_HCHO_SCALE),
+        .clear_level = sensor_hcho_ugm3_to_ppb(CONFIG_ALARM_CLEAR_UGM3 * SENSOR_HCHO_SCALE),
+        .min_hold_ms = CONFIG_ALARM_MIN_HOLD_S * 1000U,
+    };
+    for (int id = 0; id < SENSOR_ID_MAX; id++) {
+        g_config[id] = defaults;
+    }
+
+#if CONFIG_ALARM_GPIO >= 0
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_ALARM_GPIO,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    gpio_set_level(CONFIG_ALARM_GPIO, ALARM_GPIO_LEVEL(false));
+    ESP_LOGI(TAG, "Alarm output on GPIO %d", CONFIG_ALARM_GPIO);
+#endif
+
+#if CONFIG_STATIC_ALLOCATION
+    g_events = xQueueCreateStatic(ALARM_QUEUE_LEN, sizeof(alarm_event_t), g_events_storage, &g_events_struct);
+#else
+    g_events = xQueueCreate(ALARM_QUEUE_LEN, sizeof(alarm_event_t));
+#endif
+
+    // QoS 1 发布会在 esp-mqtt 的 outbox 中分配消息副本，本任务不纳入稳态零分配检查
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(alarm_task, "alarm_task", ALARM_TASK_STACK_SIZE, NULL, TASK_PRIO_ALARM,
+                                         g_task_stack, &g_task_tcb, TASK_CORE_ALARM);
+#else
+    xTaskCreatePinnedToCore(alarm_task, "alarm_task", ALARM_TASK_STACK_SIZE, NULL, TASK_PRIO_ALARM, &task,
+                            TASK_CORE_ALARM);
+#endif
+    mem_profiler_register_task(task, ALARM_TASK_STACK_SIZE);
+    ESP_LOGI(TAG, "Raise %d ug/m3, clear %d ug/m3, hold %d s", CONFIG_ALARM_RAISE_UGM3, CONFIG_ALARM_CLEAR_UGM3,
+             CONFIG_ALARM_MIN_HOLD_S);
+}
+
+#endif // CONFIG_ALARM
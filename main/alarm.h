@@ -0,0 +1,82 @@
+#ifndef __ALARM_H__
+#define __ALARM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor.h"
+
+/**
+ * 甲醛阈值告警
+ *
+ * 在生产任务中逐帧判定，位于采样调度、聚合与发布队列之前，告警延迟与遥测/聚合周期无关。
+ * 每个传感器独立的触发/解除阈值（滞回）与最短保持时间；预热中或无效的样本不参与判定。
+ * 状态变化时在判定路径上直接驱动 GPIO（蜂鸣器/LED），再交给高优先级告警任务发送
+ * 网络消息并唤醒 UI 立即刷出横幅。各输出相对样本到达时刻的延迟分别统计。
+ */
+
+typedef struct {
+    int32_t  raise_level;    // 触发阈值，HCHO 定点值（ppb * SENSOR_HCHO_SCALE）
+    int32_t  clear_level;    // 解除阈值，须低于触发阈值
+    uint32_t min_hold_ms;    // 触发后至少保持的时间
+} alarm_config_t;
+
+// 样本到达（帧末字节）到各输出生效的延迟，毫秒
+typedef struct {
+    uint32_t transitions;
+    uint32_t gpio_last_ms;
+    uint32_t gpio_max_ms;
+    uint32_t net_last_ms;
+    uint32_t net_max_ms;
+    uint32_t ui_last_ms;
+    uint32_t ui_max_ms;
+    uint32_t net_failed;     // 未连接、发送失败或事件队列满
+    uint32_t over_budget;    // 超过 CONFIG_ALARM_LATENCY_BUDGET_MS 的输出次数
+} alarm_latency_t;
+
+#if CONFIG_ALARM
+
+/**
+ * @brief 配置输出 GPIO、加载默认阈值并启动告警任务，需在传感器启动前调用
+ */
+void alarm_init(void);
+
+/**
+ * @brief 判定一个刚解析出的样本，在生产任务中逐帧调用
+ *
+ * 不阻塞：只做比较、写 GPIO 与非阻塞入队。
+ */
+void alarm_evaluate(const sensor_sample_t *sample);
+
+/**
+ * @brief 修改单个传感器的阈值，立即对下一帧生效
+ * @return 传感器无效或解除阈值不低于触发阈值时返回 false
+ */
+bool alarm_set_config(sensor_id_t id, const alarm_config_t *cfg);
+
+bool alarm_get_config(sensor_id_t id, alarm_config_t *out);
+
+/**
+ * @brief 当前处于告警的传感器位图（bit = sensor_id）
+ */
+uint32_t alarm_active_mask(void);
+
+/**
+ * @brief UI 刷出横幅变化后调用，记录横幅延迟
+ */
+void alarm_note_displayed(void);
+
+void alarm_get_latency(alarm_latency_t *out);
+
+#else
+
+static inline void alarm_init(void) {}
+static inline void alarm_evaluate(const sensor_sample_t *sample) {}
+static inline bool alarm_set_config(sensor_id_t id, const alarm_config_t *cfg) { return false; }
+static inline bool alarm_get_config(sensor_id_t id, alarm_config_t *out) { return false; }
+static inline uint32_t alarm_active_mask(void) { return 0; }
+static inline void alarm_note_displayed(void) {}
+static inline void alarm_get_latency(alarm_latency_t *out) {}
+
+#endif // CONFIG_ALARM
+
+#endif // __ALARM_H__
@@ -0,0 +1,79 @@
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+
+#if CONFIG_STATIC_ALLOCATION_CHECK
+
+static const char *TAG = "alloc_guard";
+
+static TaskHandle_t g_tracked[TASK_COUNT_MAX];
+static volatile int g_tracked_count = 0;
+static volatile bool g_sealed = false;
+static volatile uint32_t g_violations = 0;
+static volatile size_t g_last_size = 0;
+static volatile uint32_t g_last_caps = 0;
+static volatile TaskHandle_t g_last_task = NULL;
+static uint32_t g_reported = 0;
+
+void alloc_guard_track_task(TaskHandle_t task)
+{
+    if (!task) {
+        return;
+    }
+    if (g_tracked_count >= TASK_COUNT_MAX) {
+        ESP_LOGW(TAG, "Task table full (%d), %s not checked; raise TASK_COUNT_MAX in task_config.h", TASK_COUNT_MAX,
+                 pcTaskGetName(task));
+        return;
+    }
+    // 先写条目再增加计数，分配钩子随时可能读取
+    g_tracked[g_tracked_count] = task;
+    g_tracked_count++;
+}
+
+void alloc_guard_seal(void)
+{
+    g_sealed = true;
+    ESP_LOGI(TAG, "Boot allocations sealed, tracking %d tasks, internal heap free %u", g_tracked_count,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+}
+
+// heap 组件在每次分配成功后调用；可能处于中断或持锁上下文，这里只做计数
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    if (!g_sealed) {
+        return;
+    }
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < g_tracked_count; i++) {
+        if (g_tracked[i] == self) {
+            g_violations++;
+            g_last_size = size;
+            g_last_caps = caps;
+            g_last_task = self;
+            return;
+        }
+    }
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+}
+
+uint32_t alloc_guard_check(void)
+{
+    uint32_t violations = g_violations;
+    if (violations != g_reported) {
+        ESP_LOGE(TAG, "%lu heap allocations after boot (last: %u bytes, caps 0x%lx, task %s)",
+                 (unsigned long)(violations - g_reported), (unsigned)g_last_size, (unsigned long)g_last_caps,
+                 g_last_task ? pcTaskGetName(g_last_task) : "?");
+        g_reported = violations;
+#if CONFIG_STATIC_ALLOCATION_CHECK_ABORT
+        abort();
+#endif
+    }
+    return violations;
+}
+
+#endif // CONFIG_STATIC_ALLOCATION_CHECK
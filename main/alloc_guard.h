@@ -0,0 +1,39 @@
+#ifndef __ALLOC_GUARD_H__
+#define __ALLOC_GUARD_H__
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * 稳态零分配检查
+ *
+ * 启动完成后调用 alloc_guard_seal()，此后已登记任务中发生的任何堆分配都会被计数，
+ * alloc_guard_check() 在普通任务上下文中报告（可选直接终止）。
+ * 依赖 ESP-IDF 的 heap 分配钩子，只统计 main/ 中的任务，Wi-Fi/lwIP 等系统任务不受约束。
+ */
+
+#if CONFIG_STATIC_ALLOCATION_CHECK
+
+void alloc_guard_track_task(TaskHandle_t task);
+
+/**
+ * @brief 标记启动结束，之后已登记任务中的分配视为违规
+ */
+void alloc_guard_seal(void);
+
+/**
+ * @brief 报告自上次检查以来新增的违规分配
+ * @return 启动结束以来的违规分配总数
+ */
+uint32_t alloc_guard_check(void);
+
+#else
+
+static inline void alloc_guard_track_task(TaskHandle_t task) {}
+static inline void alloc_guard_seal(void) {}
+static inline uint32_t alloc_guard_check(void) { return 0; }
+
+#endif // CONFIG_STATIC_ALLOCATION_CHECK
+
+#endif // __ALLOC_GUARD_H__
@@ -0,0 +1,222 @@
+#include "sdkconfig.h"
+
+#if CONFIG_CPU_PROFILER
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "cpu_profiler.h"
+#include "lvgl_screen_ui.h"
+#include "protocols/mqtt_device.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+#define CPU_PROFILER_MAX_TASKS      32
+#define CPU_PROFILER_STACK_SIZE     3072
+#define CPU_PROFILER_REPORT_MAX     (96 + CPU_PROFILER_MAX_TASKS * (configMAX_TASK_NAME_LEN + 8))
+
+static const char *TAG = "cpu_prof";
+
+typedef struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} cpu_profiler_prev_t;
+
+// 只在分析任务中使用，放在静态区以免占用任务栈
+static TaskStatus_t g_status[CPU_PROFILER_MAX_TASKS];
+static cpu_profiler_prev_t g_prev[CPU_PROFILER_MAX_TASKS];
+static UBaseType_t g_prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE g_prev_total = 0;
+static int64_t g_prev_us = 0;
+static uint16_t g_permille[CPU_PROFILER_MAX_TASKS];
+static uint8_t g_order[CPU_PROFILER_MAX_TASKS];
+static char g_report[CPU_PROFILER_REPORT_MAX];
+
+static volatile bool g_enabled = false;
+static volatile bool g_once = false;
+static TaskHandle_t g_task = NULL;
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_task_stack[CPU_PROFILER_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+static configRUN_TIME_COUNTER_TYPE prev_runtime(TaskHandle_t handle)
+{
+    for (UBaseType_t i = 0; i < g_prev_count; i++) {
+        if (g_prev[i].handle == handle) {
+            return g_prev[i].runtime;
+        }
+    }
+    // 区间内新建的任务从 0 开始计
+    return 0;
+}
+
+static void report_appendf(size_t *len, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void report_appendf(size_t *len, const char *fmt, ...)
+{
+    if (*len >= sizeof(g_report) - 1) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(g_report + *len, sizeof(g_report) - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += (size_t)n;
+        if (*len > sizeof(g_report) - 1) {
+            *len = sizeof(g_report) - 1;
+        }
+    }
+}
+
+// 采样一次并输出自上次采样以来的占用
+static void cpu_profiler_sample(void)
+{
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(g_status, CPU_PROFILER_MAX_TASKS, &total);
+    if (count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, raise CPU_PROFILER_MAX_TASKS", CPU_PROFILER_MAX_TASKS);
+        return;
+    }
+    int64_t now_us = esp_timer_get_time();
+    // 计数器为 32 位时约 71 分钟回绕一次，无符号差值仍然正确
+    configRUN_TIME_COUNTER_TYPE elapsed = total - g_prev_total;
+    uint32_t interval_ms = (uint32_t)((now_us - g_prev_us) / 1000);
+
+    uint32_t idle_permille = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        configRUN_TIME_COUNTER_TYPE delta = g_status[i].ulRunTimeCounter - prev_runtime(g_status[i].xHandle);
+        g_permille[i] = elapsed ? (uint16_t)((uint64_t)delta * 1000 / elapsed) : 0;
+        if (strncmp(g_status[i].pcTaskName, "IDLE", 4) == 0) {
+            idle_permille += g_permille[i];
+        }
+        // 按占用从高到低插入排序
+        UBaseType_t pos = i;
+        while (pos > 0 && g_permille[g_order[pos - 1]] < g_permille[i]) {
+            g_order[pos] = g_order[pos - 1];
+            pos--;
+        }
+        g_order[pos] = (uint8_t)i;
+    }
+    for (UBaseType_t i = 0; i < count; i++) {
+        g_prev[i].handle = g_status[i].xHandle;
+        g_prev[i].runtime = g_status[i].ulRunTimeCounter;
+    }
+    g_prev_count = count;
+    g_prev_total = total;
+    g_prev_us = now_us;
+
+    uint32_t capacity = portNUM_PROCESSORS * 1000;
+    uint32_t load_permille = (capacity > idle_permille) ? (capacity - idle_permille) / portNUM_PROCESSORS : 0;
+    lvgl_ui_stats_t ui;
+    lvgl_ui_take_stats(&ui);
+    uint32_t ui_avg_us = ui.loops ? ui.busy_us / ui.loops : 0;
+
+    ESP_LOGI(TAG, "Last %lu ms: load %lu.%lu%% over %d core(s), %u tasks", (unsigned long)interval_ms,
+             (unsigned long)(load_permille / 10), (unsigned long)(load_permille % 10), portNUM_PROCESSORS,
+             (unsigned)count);
+    ESP_LOGI(TAG, "%-16s %6s %4s %5s", "task", "cpu%", "prio", "state");
+    size_t len = 0;
+    report_appendf(&len, "cpu,%lu,%lu,%u,%lu,%lu,%lu,%lu,%lu,%u", (unsigned long)interval_ms,
+                   (unsigned long)load_permille, (unsigned)portNUM_PROCESSORS, (unsigned long)ui.loops,
+                   (unsigned long)ui_avg_us, (unsigned long)ui.busy_max_us, (unsigned long)ui.mem_used,
+                   (unsigned long)ui.mem_free, ui.mem_frag_pct);
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *t = &g_status[g_order[i]];
+        uint16_t pm = g_permille[g_order[i]];
+        ESP_LOGI(TAG, "%-16s %4u.%u %4u %5d", t->pcTaskName, pm / 10, pm % 10, (unsigned)t->uxCurrentPriority,
+                 (int)t->eCurrentState);
+        report_appendf(&len, "\n%s,%u", t->pcTaskName, pm);
+    }
+    ESP_LOGI(TAG, "LVGL: %lu loops, busy avg %lu us max %lu us; heap used %lu free %lu frag %u%%",
+             (unsigned long)ui.loops, (unsigned long)ui_avg_us, (unsigned long)ui.busy_max_us,
+             (unsigned long)ui.mem_used, (unsigned long)ui.mem_free, ui.mem_frag_pct);
+
+    if (!mqtt_device_publish_raw(CONFIG_CPU_PROFILER_TOPIC, g_report, len)) {
+        ESP_LOGD(TAG, "Report not published (MQTT not connected)");
+    }
+}
+
+static void cpu_profiler_task(void *arg)
+{
+    // 建立基线，第一份报告覆盖启动后的第一个周期
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(g_status, CPU_PROFILER_MAX_TASKS, &total);
+    for (UBaseType_t i = 0; i < count; i++) {
+        g_prev[i].handle = g_status[i].xHandle;
+        g_prev[i].runtime = g_status[i].ulRunTimeCounter;
+    }
+    g_prev_count = count;
+    g_prev_total = total;
+    g_prev_us = esp_timer_get_time();
+
+    while (1) {
+        TickType_t wait = g_enabled ? pdMS_TO_TICKS(CONFIG_CPU_PROFILER_PERIOD_S * 1000) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (g_enabled || g_once) {
+            g_once = false;
+            cpu_profiler_sample();
+        }
+    }
+}
+
+void cpu_profiler_enable(bool enable)
+{
+    g_enabled = enable;
+    ESP_LOGI(TAG, "Periodic report %s", enable ? "on" : "off");
+    if (g_task) {
+        // 唤醒任务按新的状态重新计时；开启时先输出一份到当前为止的报告
+        xTaskNotifyGive(g_task);
+    }
+}
+
+void cpu_profiler_handle_command(const char *data, size_t len)
+{
+    if (len == 2 && memcmp(data, "on", 2) == 0) {
+        cpu_profiler_enable(true);
+    } else if (len == 3 && memcmp(data, "off", 3) == 0) {
+        cpu_profiler_enable(false);
+    } else if (len == 4 && memcmp(data, "once", 4) == 0) {
+        g_once = true;
+        if (g_task) {
+            xTaskNotifyGive(g_task);
+        }
+    } else if (len == 10 && memcmp(data, "overlay on", 10) == 0) {
+        lvgl_ui_set_sysmon(true);
+    } else if (len == 11 && memcmp(data, "overlay off", 11) == 0) {
+        lvgl_ui_set_sysmon(false);
+    } else {
+        ESP_LOGW(TAG, "Unknown command: %.*s", (int)len, data);
+    }
+}
+
+void cpu_profiler_start(void)
+{
+#if CONFIG_CPU_PROFILER_AUTOSTART
+    g_enabled = true;
+#endif
+#if CONFIG_CPU_PROFILER_OVERLAY
+    lvgl_ui_set_sysmon(true);
+#endif
+
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(cpu_profiler_task, "cpu_prof", CPU_PROFILER_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                                         g_task_stack, &g_task_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(cpu_profiler_task, "cpu_prof", CPU_PROFILER_STACK_SIZE, NULL, TASK_PRIO_AUX, &task,
+                            TASK_CORE_AUX);
+#endif
+    g_task = task;
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, CPU_PROFILER_STACK_SIZE);
+}
+
+#endif // CONFIG_CPU_PROFILER
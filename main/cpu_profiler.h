@@ -0,0 +1,44 @@
+#ifndef __CPU_PROFILER_H__
+#define __CPU_PROFILER_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * 任务 CPU 占用分析
+ *
+ * 周期性读取 FreeRTOS 运行时统计（uxTaskGetSystemState），按两次采样之间的差值
+ * 计算每个任务在该区间内的 CPU 占用（以单核 100% 计，多核合计可超过 100%），
+ * 连同各核负载与 LVGL 任务的渲染耗时、LVGL 堆用量一起输出到日志并发布到 MQTT。
+ * 同时可在屏幕上切换 LVGL 的性能/内存监视叠加层。
+ *
+ * 运行时通过请求主题控制："on" / "off" 启停周期报告，"once" 立即报告一次，
+ * "overlay on" / "overlay off" 切换叠加层。
+ */
+
+#if CONFIG_CPU_PROFILER
+
+/**
+ * @brief 启动分析任务，按 Kconfig 决定是否立即开始周期报告与显示叠加层
+ */
+void cpu_profiler_start(void);
+
+/**
+ * @brief 启停周期报告，可在任意任务中调用
+ */
+void cpu_profiler_enable(bool enable);
+
+/**
+ * @brief 处理请求主题上的一条消息，在 MQTT 任务中调用
+ */
+void cpu_profiler_handle_command(const char *data, size_t len);
+
+#else
+
+static inline void cpu_profiler_start(void) {}
+static inline void cpu_profiler_enable(bool enable) {}
+static inline void cpu_profiler_handle_command(const char *data, size_t len) {}
+
+#endif // CONFIG_CPU_PROFILER
+
+#endif // __CPU_PROFILER_H__
@@ -2,13 +2,15 @@
 #define __DART_SENSOR_H__
 
 #include <stdint.h>
-
-
-
-extern float g_dart_hcho_mg;
-extern uint32_t g_dart_hcho_timestamp;
+#include <stdbool.h>
 
 void dart_sensor_init(void);
 void dart_sensor_start(void); // 启动传感器任务和打印任务
+// 修正系数须在 [SENSOR_CORRECTION_MIN, SENSOR_CORRECTION_MAX] 内，否则忽略并返回 false
+bool dart_set_ch2o_correction_factor(float factor);
+float dart_get_ch2o_correction_factor(void);
+// 请求切换工作模式（true 为主动上传，false 为问答），生产任务在下一轮读取前下发模式命令
+void dart_sensor_set_auto_mode(bool auto_upload);
+bool dart_sensor_get_auto_mode(void);
 
 #endif // __DART_SENSOR_H__
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "sdkconfig.h"
+
+#if CONFIG_DEVICE_CONTROL
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "device_control.h"
+#include "sensor.h"
+#include "sensor_scheduler.h"
+#include "sensor_filter.h"
+#include "dart_sensor.h"
+#include "winsen_sensor.h"
+#include "alarm.h"
+#include "protocols/mqtt_device.h"
+
+#define CONTROL_CMD_MAX         160
+#define CONTROL_ACK_LINE_MAX    160
+#define CONTROL_ACK_MAX         (32 + SENSOR_ID_MAX * CONTROL_ACK_LINE_MAX)
+#define CONTROL_SEP             " \t\r\n"
+
+#if CONFIG_ALARM
+#define CONTROL_HAS_ALARM       1
+#else
+#define CONTROL_HAS_ALARM       0
+#endif
+
+static const char *TAG = "device_control";
+
+typedef enum {
+    KEY_MIN_MS = 0,
+    KEY_MAX_MS,
+    KEY_SLOPE,
+    KEY_CALM,
+    KEY_WINDOW,
+    KEY_HAMPEL,
+    KEY_EMA,
+    KEY_MINDEV,
+    KEY_MODE,
+    KEY_CORR,
+    KEY_RAISE,
+    KEY_CLEAR,
+    KEY_HOLD,
+    KEY_COUNT
+} control_key_t;
+
+#define KEY_BIT(k)          (1U << (k))
+#define KEYS_SCHED          (KEY_BIT(KEY_MIN_MS) | KEY_BIT(KEY_MAX_MS) | KEY_BIT(KEY_SLOPE) | KEY_BIT(KEY_CALM))
+#define KEYS_FILTER         (KEY_BIT(KEY_WINDOW) | KEY_BIT(KEY_HAMPEL) | KEY_BIT(KEY_EMA) | KEY_BIT(KEY_MINDEV))
+#define KEYS_LOCAL          (KEY_BIT(KEY_MODE) | KEY_BIT(KEY_CORR))
+#define KEYS_ALARM          (KEY_BIT(KEY_RAISE) | KEY_BIT(KEY_CLEAR) | KEY_BIT(KEY_HOLD))
+
+// 整数参数的取值范围与 Kconfig 一致；mode 与 corr 单独解析
+typedef struct {
+    const char *name;
+    int32_t min;
+    int32_t max;
+} control_key_def_t;
+
+static const control_key_def_t g_keys[KEY_COUNT] = {
+    [KEY_MIN_MS] = {"min_ms", 500, 60000},
+    [KEY_MAX_MS] = {"max_ms", 500, 600000},
+    [KEY_SLOPE]  = {"slope", 1, 10000},
+    [KEY_CALM]   = {"calm", 1, 100},
+    [KEY_WINDOW] = {"window", 0, SENSOR_FILTER_MAX_WINDOW},
+    [KEY_HAMPEL] = {"hampel", 10, 100},
+    [KEY_EMA]    = {"ema", 0, 255},
+    [KEY_MINDEV] = {"mindev", 0, 1000},
+    [KEY_MODE]   = {"mode", 0, 1},
+    [KEY_CORR]   = {"corr", 0, 0},
+    [KEY_RAISE]  = {"raise", 1, 5000},
+    [KEY_CLEAR]  = {"clear", 0, 5000},
+    [KEY_HOLD]   = {"hold", 0, 3600},
+};
+
+typedef struct {
+    uint32_t set;            // KEY_BIT 位图
+    int32_t  val[KEY_COUNT];
+    float    corr;
+} control_cmd_t;
+
+// 本地直连传感器的模式与修正系数接口
+typedef struct {
+    bool  (*set_corr)(float factor);
+    float (*get_corr)(void);
+    void  (*set_auto)(bool auto_upload);
+    bool  (*get_auto)(void);
+} local_sensor_ops_t;
+
+static const local_sensor_ops_t g_local_ops[SENSOR_ID_LOCAL_COUNT] = {
+    [SENSOR_ID_DART] = {
+        dart_set_ch2o_correction_factor, dart_get_ch2o_correction_factor,
+        dart_sensor_set_auto_mode, dart_sensor_get_auto_mode,
+    },
+    [SENSOR_ID_WINSEN] = {
+        winsen_set_ch2o_correction_factor, winsen_get_ch2o_correction_factor,
+        winsen_sensor_set_auto_mode, winsen_sensor_get_auto_mode,
+    },
+};
+
+// 每个目标传感器合并后的待提交配置
+typedef struct {
+    sensor_scheduler_config_t sched;
+    sensor_filter_config_t filter;
+    alarm_config_t alarm;
+} control_stage_t;
+
+// 只在 MQTT 任务中使用，放在静态区以免占用其任务栈
+static char g_line[CONTROL_CMD_MAX + 1];
+static char g_ack[CONTROL_ACK_MAX];
+static control_stage_t g_stage[SENSOR_ID_MAX];
+
+static uint32_t key_support_mask(sensor_id_t id)
+{
+    uint32_t mask = KEYS_SCHED | KEYS_FILTER;
+    if (id < SENSOR_ID_LOCAL_COUNT) {
+        mask |= KEYS_LOCAL;
+    }
+    if (CONTROL_HAS_ALARM) {
+        mask |= KEYS_ALARM;
+    }
+    return mask;
+}
+
+static void reply(const char *text, size_t len)
+{
+    if (!mqtt_device_publish_raw(CONFIG_DEVICE_CONTROL_ACK_TOPIC, text, len)) {
+        ESP_LOGW(TAG, "Ack not sent: %.*s", (int)len, text);
+    }
+}
+
+static void reply_error(const char *id, const char *key, const char *reason)
+{
+    int len = snprintf(g_ack, sizeof(g_ack), "%s err %s %s", id, key, reason);
+    ESP_LOGW(TAG, "Command %s rejected: %s %s", id, key, reason);
+    reply(g_ack, (size_t)len);
+}
+
+static void ack_appendf(size_t *len, const char *fmt, ...)
+{
+    if (*len >= sizeof(g_ack)) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(g_ack + *len, sizeof(g_ack) - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += (size_t)n;
+        if (*len > sizeof(g_ack) - 1) {
+            *len = sizeof(g_ack) - 1;
+        }
+    }
+}
+
+// 目标传感器位图："*" 为全部，否则按名称匹配；可配置的参数都针对甲醛，辅助传感器不在其中
+static uint32_t resolve_target(const char *target)
+{
+    if (strcmp(target, "*") == 0) {
+        return (1U << SENSOR_ID_AUX_FIRST) - 1;
+    }
+    for (int id = 0; id < SENSOR_ID_AUX_FIRST; id++) {
+        if (strcmp(target, sensor_id_name(id)) == 0) {
+            return 1U << id;
+        }
+    }
+    return 0;
+}
+
+// 解析一个 key=value，失败时返回出错的参数名
+static const char *parse_pair(char *tok, control_cmd_t *cmd, const char **reason)
+{
+    char *eq = strchr(tok, '=');
+    if (!eq) {
+        *reason = "expected key=value";
+        return tok;
+    }
+    *eq = '\0';
+    const char *value = eq + 1;
+    int key = 0;
+    while (key < KEY_COUNT && strcmp(tok, g_keys[key].name) != 0) {
+        key++;
+    }
+    if (key == KEY_COUNT) {
+        *reason = "unknown key";
+        return tok;
+    }
+
+    char *end = NULL;
+    if (key == KEY_MODE) {
+        if (strcmp(value, "auto") == 0) {
+            cmd->val[key] = 1;
+        } else if (strcmp(value, "qna") == 0) {
+            cmd->val[key] = 0;
+        } else {
+            *reason = "expected auto or qna";
+            return tok;
+        }
+    } else if (key == KEY_CORR) {
+        cmd->corr = strtof(value, &end);
+        if (end == value || *end != '\0' || !(cmd->corr >= SENSOR_CORRECTION_MIN && cmd->corr <= SENSOR_CORRECTION_MAX)) {
+            *reason = "out of range";
+            return tok;
+        }
+    } else {
+        long v = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || v < g_keys[key].min || v > g_keys[key].max) {
+            *reason = "out of range";
+            return tok;
+        }
+        cmd->val[key] = (int32_t)v;
+    }
+    cmd->set |= KEY_BIT(key);
+    return NULL;
+}
+
+// 在当前配置上叠加命令参数并校验组合约束
+static const char *stage_target(sensor_id_t id, const control_cmd_t *cmd, control_stage_t *st, const char **reason)
+{
+    sensor_scheduler_get_config(sensor_scheduler_get(id), &st->sched);
+    sensor_filter_get_config(sensor_filter_get(id), &st->filter);
+    alarm_get_config(id, &st->alarm);
+    const int32_t *v = cmd->val;
+    uint32_t set = cmd->set;
+
+    if (set & KEY_BIT(KEY_MIN_MS)) {
+        st->sched.min_interval_ms = (uint32_t)v[KEY_MIN_MS];
+    }
+    if (set & KEY_BIT(KEY_MAX_MS)) {
+        st->sched.max_interval_ms = (uint32_t)v[KEY_MAX_MS];
+    }
+    if (set & KEY_BIT(KEY_SLOPE)) {
+        st->sched.slope_threshold = v[KEY_SLOPE] * SENSOR_HCHO_SCALE;
+    }
+    if (set & KEY_BIT(KEY_CALM)) {
+        st->sched.calm_samples = (uint8_t)v[KEY_CALM];
+    }
+    if (st->sched.max_interval_ms < st->sched.min_interval_ms) {
+        *reason = "below min_ms";
+        return g_keys[KEY_MAX_MS].name;
+    }
+
+    if (set & KEY_BIT(KEY_WINDOW)) {
+        if (v[KEY_WINDOW] > 0 && v[KEY_WINDOW] < 3) {
+            *reason = "must be 0 or 3..15";
+            return g_keys[KEY_WINDOW].name;
+        }
+        st->filter.window = (uint8_t)v[KEY_WINDOW];
+    }
+    if (set & KEY_BIT(KEY_HAMPEL)) {
+        st->filter.hampel_k_x10 = (uint8_t)v[KEY_HAMPEL];
+    }
+    if (set & KEY_BIT(KEY_EMA)) {
+        st->filter.ema_alpha_q8 = (uint8_t)v[KEY_EMA];
+    }
+    if (set & KEY_BIT(KEY_MINDEV)) {
+        st->filter.min_deviation = v[KEY_MINDEV] * SENSOR_HCHO_SCALE;
+    }
+
+    if (set & KEY_BIT(KEY_RAISE)) {
+        st->alarm.raise_level = sensor_hcho_ugm3_to_ppb(v[KEY_RAISE] * SENSOR_HCHO_SCALE);
+    }
+    if (set & KEY_BIT(KEY_CLEAR)) {
+        st->alarm.clear_level = sensor_hcho_ugm3_to_ppb(v[KEY_CLEAR] * SENSOR_HCHO_SCALE);
+    }
+    if (set & KEY_BIT(KEY_HOLD)) {
+        st->alarm.min_hold_ms = (uint32_t)v[KEY_HOLD] * 1000U;
+    }
+    if (CONTROL_HAS_ALARM && st->alarm.clear_level >= st->alarm.raise_level) {
+        *reason = "not below raise";
+        return g_keys[KEY_CLEAR].name;
+    }
+    return NULL;
+}
+
+static void commit_target(sensor_id_t id, const control_cmd_t *cmd, const control_stage_t *st)
+{
+    uint32_t set = cmd->set & key_support_mask(id);
+    if (set & KEYS_SCHED) {
+        sensor_scheduler_set_config(sensor_scheduler_get(id), &st->sched);
+    }
+    if (set & KEYS_FILTER) {
+        sensor_filter_set_config(sensor_filter_get(id), &st->filter);
+    }
+    if (set & KEYS_ALARM) {
+        alarm_set_config(id, &st->alarm);
+    }
+    if (set & KEY_BIT(KEY_CORR)) {
+        g_local_ops[id].set_corr(cmd->corr);
+    }
+    if (set & KEY_BIT(KEY_MODE)) {
+        g_local_ops[id].set_auto(cmd->val[KEY_MODE] != 0);
+    }
+}
+
+static void ack_append_config(size_t *len, sensor_id_t id)
+{
+    sensor_scheduler_config_t sched;
+    sensor_filter_config_t filter;
+    sensor_scheduler_get_config(sensor_scheduler_get(id), &sched);
+    sensor_filter_get_config(sensor_filter_get(id), &filter);
+    ack_appendf(len, "\n%s min_ms=%lu max_ms=%lu slope=%ld calm=%u window=%u hampel=%u ema=%u mindev=%ld",
+                sensor_id_name(id), (unsigned long)sched.min_interval_ms, (unsigned long)sched.max_interval_ms,
+                (long)(sched.slope_threshold / SENSOR_HCHO_SCALE), sched.calm_samples, filter.window,
+                filter.hampel_k_x10, filter.ema_alpha_q8, (long)(filter.min_deviation / SENSOR_HCHO_SCALE));
+    if (id < SENSOR_ID_LOCAL_COUNT) {
+        const local_sensor_ops_t *ops = &g_local_ops[id];
+        ack_appendf(len, " mode=%s corr=%.3f", ops->get_auto() ? "auto" : "qna", (double)ops->get_corr());
+    }
+#if CONFIG_ALARM
+    alarm_config_t alarm;
+    alarm_get_config(id, &alarm);
+    ack_appendf(len, " raise=%ld clear=%ld hold=%lu", (long)sensor_hcho_to_ugm3(alarm.raise_level),
+                (long)sensor_hcho_to_ugm3(alarm.clear_level), (unsigned long)(alarm.min_hold_ms / 1000));
+#endif
+}
+
+void device_control_handle_command(const char *data, size_t len)
+{
+    if (len > CONTROL_CMD_MAX) {
+        reply_error("-", "-", "too long");
+        return;
+    }
+    memcpy(g_line, data, len);
+    g_line[len] = '\0';
+
+    char *save = NULL;
+    const char *id = strtok_r(g_line, CONTROL_SEP, &save);
+    const char *target = strtok_r(NULL, CONTROL_SEP, &save);
+    if (!id || !target) {
+        reply_error(id ? id : "-", "-", "expected <id> <target>");
+        return;
+    }
+    uint32_t targets = resolve_target(target);
+    if (!targets) {
+        reply_error(id, target, "unknown sensor");
+        return;
+    }
+
+    control_cmd_t cmd = {0};
+    const char *reason = NULL;
+    for (char *tok = strtok_r(NULL, CONTROL_SEP, &save); tok; tok = strtok_r(NULL, CONTROL_SEP, &save)) {
+        const char *bad = parse_pair(tok, &cmd, &reason);
+        if (bad) {
+            reply_error(id, bad, reason);
+            return;
+        }
+    }
+
+    // 第一遍：逐个目标合并并校验，任何失败都不改动配置
+    uint32_t supported = 0;
+    for (int sid = 0; sid < SENSOR_ID_MAX; sid++) {
+        if (!(targets & (1U << sid))) {
+            continue;
+        }
+        uint32_t mask = key_support_mask(sid);
+        supported |= cmd.set & mask;
+        const char *bad = stage_target(sid, &cmd, &g_stage[sid], &reason);
+        if (bad) {
+            reply_error(id, bad, reason);
+            return;
+        }
+    }
+    if (cmd.set & ~supported) {
+        for (int key = 0; key < KEY_COUNT; key++) {
+            if ((cmd.set & ~supported) & KEY_BIT(key)) {
+                reply_error(id, g_keys[key].name, "not supported by target");
+                return;
+            }
+        }
+    }
+
+    // 第二遍：提交
+    size_t ack_len = 0;
+    ack_appendf(&ack_len, "%s ok", id);
+    for (int sid = 0; sid < SENSOR_ID_MAX; sid++) {
+        if (targets & (1U << sid)) {
+            commit_target(sid, &cmd, &g_stage[sid]);
+            ack_append_config(&ack_len, sid);
+        }
+    }
+    if (cmd.set) {
+        ESP_LOGI(TAG, "Command %s applied to %s", id, target);
+    }
+    reply(g_ack, ack_len);
+}
+
+#endif // CONFIG_DEVICE_CONTROL
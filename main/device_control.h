@@ -0,0 +1,36 @@
+#ifndef __DEVICE_CONTROL_H__
+#define __DEVICE_CONTROL_H__
+
+#include <stddef.h>
+
+/**
+ * 远程控制：经 MQTT 命令主题在线调整采样、滤波、传感器模式、修正系数与告警阈值
+ *
+ * 命令为单行文本 "<id> <target> [key=value ...]"，target 为传感器名（dart、winsen、bus1...）
+ * 或 "*"（全部甲醛传感器，跳过不支持该参数的传感器；SHT4x 不可配置）。不带参数即查询当前配置。
+ *
+ *   min_ms / max_ms / slope / calm   采样调度：最短/最长间隔（ms）、变化率阈值（ppb/min）、平稳样本数
+ *   window / hampel / ema / mindev   滤波：中值窗口、Hampel k*10、EMA alpha*256、最小离群偏差（ppb）
+ *   mode=auto|qna / corr             本地传感器：工作模式、修正系数
+ *   raise / clear / hold             告警：触发/解除阈值（ug/m3）、最短保持（s）
+ *
+ * 整条命令先全部解析并对每个目标传感器校验合并后的配置，任一项不合法则不改动任何配置；
+ * 通过后一次性提交，各子系统在下一个样本边界整体替换配置。
+ * 应答发到应答主题："<id> ok" 后每个目标传感器一行生效后的配置，或 "<id> err <key> <原因>"。
+ * 解析就地进行，缓冲区均为静态分配，不使用堆。配置只保存在 RAM 中，重启后恢复 Kconfig 默认值。
+ */
+
+#if CONFIG_DEVICE_CONTROL
+
+/**
+ * @brief 处理命令主题上的一条消息，在 MQTT 任务中调用
+ */
+void device_control_handle_command(const char *data, size_t len);
+
+#else
+
+static inline void device_control_handle_command(const char *data, size_t len) {}
+
+#endif // CONFIG_DEVICE_CONTROL
+
+#endif // __DEVICE_CONTROL_H__
@@ -0,0 +1,137 @@
+#include "esp_log.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "driver/gpio.h"
+#include "display_power.h"
+#include "i2c_arbiter.h"
+#include "energy_meter.h"
+
+#if CONFIG_DISPLAY_POWER_MGMT
+
+static const char *TAG = "display_power";
+
+// SSD1306 与 SH1107 共用的对比度命令
+#define DISPLAY_CMD_SET_CONTRAST   0x81
+
+extern esp_lcd_panel_handle_t panel_handle;
+extern esp_lcd_panel_io_handle_t io_handle;
+
+static display_power_state_t g_state = DISPLAY_POWER_ON;
+static uint32_t g_last_activity_ms = 0;
+static volatile bool g_wake_pending = true;   // 上电视为一次活动
+static TaskHandle_t g_ui_task = NULL;
+
+static const char *const g_state_names[] = {
+    [DISPLAY_POWER_ON]  = "on",
+    [DISPLAY_POWER_DIM] = "dim",
+    [DISPLAY_POWER_OFF] = "off",
+};
+
+static const energy_meter_t g_energy_states[] = {
+    [DISPLAY_POWER_ON]  = ENERGY_METER_DISPLAY_ON,
+    [DISPLAY_POWER_DIM] = ENERGY_METER_DISPLAY_DIM,
+    [DISPLAY_POWER_OFF] = ENERGY_METER_DISPLAY_OFF,
+};
+
+static void IRAM_ATTR wake_button_isr(void *arg)
+{
+    g_wake_pending = true;
+    if (g_ui_task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(g_ui_task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+static void set_contrast(uint8_t level)
+{
+    esp_err_t err = esp_lcd_panel_io_tx_param(io_handle, DISPLAY_CMD_SET_CONTRAST, &level, 1);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Set contrast failed: %s", esp_err_to_name(err));
+    }
+}
+
+// 执行状态切换对应的面板操作，只在状态变化时访问 I2C
+static void enter_state(display_power_state_t next)
+{
+    if (next == g_state) {
+        return;
+    }
+    i2c_arbiter_display_begin();
+    if (g_state == DISPLAY_POWER_OFF) {
+        esp_lcd_panel_disp_on_off(panel_handle, true);
+    }
+    switch (next) {
+    case DISPLAY_POWER_ON:
+        set_contrast(CONFIG_DISPLAY_ACTIVE_CONTRAST);
+        break;
+    case DISPLAY_POWER_DIM:
+        set_contrast(CONFIG_DISPLAY_DIM_CONTRAST);
+        break;
+    case DISPLAY_POWER_OFF:
+        esp_lcd_panel_disp_on_off(panel_handle, false);
+        break;
+    }
+    i2c_arbiter_display_end();
+    ESP_LOGI(TAG, "Display %s -> %s", g_state_names[g_state], g_state_names[next]);
+    g_state = next;
+    energy_meter_set_state(ENERGY_DOMAIN_DISPLAY, g_energy_states[next]);
+}
+
+void display_power_init(TaskHandle_t ui_task)
+{
+    g_ui_task = ui_task;
+    i2c_arbiter_display_begin();
+    set_contrast(CONFIG_DISPLAY_ACTIVE_CONTRAST);
+    i2c_arbiter_display_end();
+
+#if CONFIG_DISPLAY_WAKE_GPIO >= 0
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_DISPLAY_WAKE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,   // 按键接地，按下为下降沿
+    };
+    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // 已安装时返回 INVALID_STATE
+        ESP_ERROR_CHECK(err);
+    }
+    ESP_ERROR_CHECK(gpio_isr_handler_add(CONFIG_DISPLAY_WAKE_GPIO, wake_button_isr, NULL));
+    ESP_LOGI(TAG, "Wake button on GPIO %d", CONFIG_DISPLAY_WAKE_GPIO);
+#endif
+}
+
+void display_power_wake(void)
+{
+    g_wake_pending = true;
+    if (g_ui_task) {
+        xTaskNotifyGive(g_ui_task);
+    }
+}
+
+display_power_state_t display_power_update(uint32_t now_ms, bool alert)
+{
+    if (g_wake_pending || alert) {
+        g_wake_pending = false;
+        g_last_activity_ms = now_ms;
+    }
+
+    uint32_t idle_ms = now_ms - g_last_activity_ms;
+    display_power_state_t next = DISPLAY_POWER_ON;
+    if (CONFIG_DISPLAY_OFF_TIMEOUT_S > 0 && idle_ms >= CONFIG_DISPLAY_OFF_TIMEOUT_S * 1000U) {
+        next = DISPLAY_POWER_OFF;
+    } else if (CONFIG_DISPLAY_DIM_TIMEOUT_S > 0 && idle_ms >= CONFIG_DISPLAY_DIM_TIMEOUT_S * 1000U) {
+        next = DISPLAY_POWER_DIM;
+    }
+    enter_state(next);
+    return g_state;
+}
+
+display_power_state_t display_power_get_state(void)
+{
+    return g_state;
+}
+
+#endif // CONFIG_DISPLAY_POWER_MGMT
@@ -0,0 +1,42 @@
+#ifndef __DISPLAY_POWER_H__
+#define __DISPLAY_POWER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * 显示屏电源管理
+ *
+ * 无人操作一段时间后先降低对比度，再关闭面板；按键或浓度告警立即唤醒。
+ * 面板关闭期间由 UI 任务暂停 LVGL 渲染和 tick，本模块只负责面板本身与唤醒源。
+ */
+
+typedef enum {
+    DISPLAY_POWER_ON = 0,
+    DISPLAY_POWER_DIM,
+    DISPLAY_POWER_OFF,
+} display_power_state_t;
+
+/**
+ * @brief 初始化电源管理并配置唤醒按键
+ * @param ui_task 面板关闭时阻塞等待唤醒的 UI 任务，按键中断会通知它
+ */
+void display_power_init(TaskHandle_t ui_task);
+
+/**
+ * @brief 根据空闲时间和告警状态推进状态机，并执行对应的面板操作
+ * @param alert 当前是否有传感器处于告警浓度，告警期间屏幕保持点亮
+ * @return 更新后的状态
+ */
+display_power_state_t display_power_update(uint32_t now_ms, bool alert);
+
+/**
+ * @brief 记录一次用户活动，可在任意任务中调用
+ */
+void display_power_wake(void);
+
+display_power_state_t display_power_get_state(void);
+
+#endif // __DISPLAY_POWER_H__
@@ -0,0 +1,294 @@
+#include "sdkconfig.h"
+
+#if CONFIG_ENERGY_METER
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+#include "esp_attr.h"
+#include "esp_pm.h"
+#endif
+#include "energy_meter.h"
+#include "protocols/telemetry.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+#define ENERGY_METER_STACK_SIZE     3072
+#define ENERGY_METER_REPORT_MAX     (64 + ENERGY_METER_MAX * 32)
+// 电荷单位：uA * us = 1e-12 C（pC）；1 uAh = 3.6e9 pC
+#define ENERGY_PC_PER_UAH           3600000000ULL
+
+static const char *TAG = "energy";
+
+static const char *const g_meter_names[ENERGY_METER_MAX] = {
+    [ENERGY_METER_CPU_ACTIVE]       = "cpu_active",
+    [ENERGY_METER_CPU_IDLE]         = "cpu_idle",
+    [ENERGY_METER_CPU_SLEEP]        = "cpu_sleep",
+    [ENERGY_METER_RADIO_OFF]        = "radio_off",
+    [ENERGY_METER_RADIO_RX]         = "radio_rx",
+    [ENERGY_METER_RADIO_CONNECTED]  = "radio_conn",
+    [ENERGY_METER_RADIO_AIR]        = "radio_air",
+    [ENERGY_METER_DISPLAY_ON]       = "display_on",
+    [ENERGY_METER_DISPLAY_DIM]      = "display_dim",
+    [ENERGY_METER_DISPLAY_OFF]      = "display_off",
+    [ENERGY_METER_SENSORS]          = "sensors",
+    [ENERGY_METER_UART]             = "uart",
+};
+
+// 电流模型（uA）；RADIO_AIR 与 UART 为叠加在所在状态之上的额外电流
+static const uint32_t g_current_ua[ENERGY_METER_MAX] = {
+    [ENERGY_METER_CPU_ACTIVE]       = CONFIG_ENERGY_CPU_ACTIVE_UA,
+    [ENERGY_METER_CPU_IDLE]         = CONFIG_ENERGY_CPU_IDLE_UA,
+    [ENERGY_METER_CPU_SLEEP]        = CONFIG_ENERGY_CPU_SLEEP_UA,
+    [ENERGY_METER_RADIO_OFF]        = 0,
+    [ENERGY_METER_RADIO_RX]         = CONFIG_ENERGY_RADIO_RX_UA,
+    [ENERGY_METER_RADIO_CONNECTED]  = CONFIG_ENERGY_RADIO_CONNECTED_UA,
+    [ENERGY_METER_RADIO_AIR]        = CONFIG_ENERGY_RADIO_AIR_UA,
+    [ENERGY_METER_DISPLAY_ON]       = CONFIG_ENERGY_DISPLAY_ON_UA,
+    [ENERGY_METER_DISPLAY_DIM]      = CONFIG_ENERGY_DISPLAY_DIM_UA,
+    [ENERGY_METER_DISPLAY_OFF]      = CONFIG_ENERGY_DISPLAY_OFF_UA,
+    [ENERGY_METER_SENSORS]          = CONFIG_ENERGY_SENSORS_UA,
+    [ENERGY_METER_UART]             = CONFIG_ENERGY_UART_UA,
+};
+
+typedef struct {
+    energy_meter_t state;
+    int64_t since_us;
+} energy_domain_state_t;
+
+// 以下由 g_lock 保护
+static energy_domain_state_t g_domains[ENERGY_DOMAIN_MAX];
+static uint64_t g_state_us[ENERGY_METER_MAX];   // 互斥状态与事件的累计时间
+static uint32_t g_samples = 0;
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static uint64_t g_sleep_us = 0;
+#endif
+
+// 只在报告任务中使用
+static uint64_t g_prev_state_us[ENERGY_METER_MAX];
+static uint32_t g_prev_samples = 0;
+static int64_t g_prev_us = 0;
+static configRUN_TIME_COUNTER_TYPE g_prev_idle[portNUM_PROCESSORS];
+static configRUN_TIME_COUNTER_TYPE g_prev_counter = 0;
+static uint32_t g_prev_frames = 0;
+static uint32_t g_prev_ip_bytes = 0;
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static uint64_t g_prev_sleep_us = 0;
+#endif
+static char g_report[ENERGY_METER_REPORT_MAX];
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_task_stack[ENERGY_METER_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+void energy_meter_set_state(energy_domain_t domain, energy_meter_t state)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&g_lock);
+    energy_domain_state_t *d = &g_domains[domain];
+    if (d->state != state) {
+        g_state_us[d->state] += (uint64_t)(now - d->since_us);
+        d->state = state;
+        d->since_us = now;
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void energy_meter_add_us(energy_meter_t meter, uint32_t us)
+{
+    portENTER_CRITICAL(&g_lock);
+    g_state_us[meter] += us;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void energy_meter_note_sample(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    g_samples++;
+    portEXIT_CRITICAL(&g_lock);
+}
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+// 浅睡退出回调，在关中断的睡眠路径中运行
+static esp_err_t IRAM_ATTR energy_meter_sleep_exit(int64_t sleep_time_us, void *arg)
+{
+    portENTER_CRITICAL_ISR(&g_lock);
+    g_sleep_us += (uint64_t)sleep_time_us;
+    portEXIT_CRITICAL_ISR(&g_lock);
+    return ESP_OK;
+}
+#endif
+
+// 指定核上空闲任务的累计运行时间
+static configRUN_TIME_COUNTER_TYPE idle_counter(int core)
+{
+    return ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+}
+
+static void report_appendf(size_t *len, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void report_appendf(size_t *len, const char *fmt, ...)
+{
+    if (*len >= sizeof(g_report) - 1) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(g_report + *len, sizeof(g_report) - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += (size_t)n;
+        if (*len > sizeof(g_report) - 1) {
+            *len = sizeof(g_report) - 1;
+        }
+    }
+}
+
+static void energy_meter_report(void)
+{
+    uint64_t interval_us_by_meter[ENERGY_METER_MAX];
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&g_lock);
+    // 把各子系统当前状态已停留的时间结算进去，再取区间差值
+    for (int d = 0; d < ENERGY_DOMAIN_MAX; d++) {
+        g_state_us[g_domains[d].state] += (uint64_t)(now - g_domains[d].since_us);
+        g_domains[d].since_us = now;
+    }
+    for (int m = 0; m < ENERGY_METER_MAX; m++) {
+        interval_us_by_meter[m] = g_state_us[m] - g_prev_state_us[m];
+        g_prev_state_us[m] = g_state_us[m];
+    }
+    uint32_t samples = g_samples - g_prev_samples;
+    g_prev_samples = g_samples;
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    uint64_t sleep_us = g_sleep_us - g_prev_sleep_us;
+    g_prev_sleep_us = g_sleep_us;
+#else
+    uint64_t sleep_us = 0;
+#endif
+    portEXIT_CRITICAL(&g_lock);
+
+    uint64_t interval_us = (uint64_t)(now - g_prev_us);
+    g_prev_us = now;
+    if (interval_us == 0) {
+        return;
+    }
+
+    // CPU：按各核平均空闲比例折算整芯片的活动时间，浅睡发生在空闲任务中
+    configRUN_TIME_COUNTER_TYPE counter = portGET_RUN_TIME_COUNTER_VALUE();
+    configRUN_TIME_COUNTER_TYPE elapsed = counter - g_prev_counter;
+    g_prev_counter = counter;
+    uint64_t idle = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        configRUN_TIME_COUNTER_TYPE cur = idle_counter(core);
+        idle += cur - g_prev_idle[core];
+        g_prev_idle[core] = cur;
+    }
+    uint64_t capacity = (uint64_t)elapsed * portNUM_PROCESSORS;
+    uint64_t idle_us = capacity ? interval_us * (idle > capacity ? capacity : idle) / capacity : 0;
+    sleep_us = (sleep_us > idle_us) ? idle_us : sleep_us;
+    interval_us_by_meter[ENERGY_METER_CPU_ACTIVE] = interval_us - idle_us;
+    interval_us_by_meter[ENERGY_METER_CPU_IDLE] = idle_us - sleep_us;
+    interval_us_by_meter[ENERGY_METER_CPU_SLEEP] = sleep_us;
+
+    // 射频空口：与遥测开销统计同一估算方法
+    transport_stats_t stats;
+    telemetry_get_stats(&stats);
+    uint32_t frames = stats.messages + stats.acked;
+    uint32_t ip_bytes = stats.wire_bytes + stats.rx_bytes;
+    interval_us_by_meter[ENERGY_METER_RADIO_AIR] += telemetry_airtime_us(frames - g_prev_frames,
+                                                                         ip_bytes - g_prev_ip_bytes);
+    g_prev_frames = frames;
+    g_prev_ip_bytes = ip_bytes;
+
+    interval_us_by_meter[ENERGY_METER_SENSORS] = interval_us;
+
+    uint64_t total_pc = 0;
+    uint64_t charge_pc[ENERGY_METER_MAX];
+    for (int m = 0; m < ENERGY_METER_MAX; m++) {
+        charge_pc[m] = interval_us_by_meter[m] * g_current_ua[m];
+        total_pc += charge_pc[m];
+    }
+    uint32_t avg_ua = (uint32_t)(total_pc / interval_us);
+    // 按当前平均电流折算一天：uA * 24 h = uAh/天
+    uint32_t uah_per_day = avg_ua * 24;
+    // 每样本电荷，单位 nAh
+    uint32_t nah_per_sample = samples ? (uint32_t)(total_pc / samples / (ENERGY_PC_PER_UAH / 1000)) : 0;
+    // 每样本能量，单位 uJ：pC * mV = 1e-15 J
+    uint32_t uj_per_sample = samples ? (uint32_t)(total_pc / samples * CONFIG_ENERGY_SUPPLY_MV / 1000000000ULL) : 0;
+
+    ESP_LOGI(TAG, "Last %lu ms: avg %lu uA, %lu.%03lu mAh/day, %lu samples, %lu.%03lu uAh (%lu uJ) per sample",
+             (unsigned long)(interval_us / 1000), (unsigned long)avg_ua, (unsigned long)(uah_per_day / 1000),
+             (unsigned long)(uah_per_day % 1000), (unsigned long)samples, (unsigned long)(nah_per_sample / 1000),
+             (unsigned long)(nah_per_sample % 1000), (unsigned long)uj_per_sample);
+    ESP_LOGI(TAG, "%-12s %10s %7s %8s %6s", "state", "time_ms", "avg_uA", "mAh/day", "share");
+    size_t len = 0;
+    report_appendf(&len, "energy,%lu,%lu,%lu,%lu,%lu", (unsigned long)(interval_us / 1000), (unsigned long)samples,
+                   (unsigned long)avg_ua, (unsigned long)nah_per_sample, (unsigned long)uj_per_sample);
+    for (int m = 0; m < ENERGY_METER_MAX; m++) {
+        if (interval_us_by_meter[m] == 0) {
+            continue;
+        }
+        uint32_t meter_ua = (uint32_t)(charge_pc[m] / interval_us);
+        uint32_t meter_uah_day = meter_ua * 24;
+        uint32_t share = total_pc ? (uint32_t)(charge_pc[m] * 100 / total_pc) : 0;
+        ESP_LOGI(TAG, "%-12s %10lu %7lu %4lu.%03lu %5lu%%", g_meter_names[m],
+                 (unsigned long)(interval_us_by_meter[m] / 1000), (unsigned long)meter_ua,
+                 (unsigned long)(meter_uah_day / 1000), (unsigned long)(meter_uah_day % 1000), (unsigned long)share);
+        report_appendf(&len, "\n%s,%lu,%lu", g_meter_names[m], (unsigned long)(interval_us_by_meter[m] / 1000),
+                       (unsigned long)meter_ua);
+    }
+    if (!mqtt_device_publish_raw(CONFIG_ENERGY_METER_TOPIC, g_report, len)) {
+        ESP_LOGD(TAG, "Report not published (MQTT not connected)");
+    }
+}
+
+static void energy_meter_task(void *arg)
+{
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_ENERGY_METER_PERIOD_S * 1000));
+        energy_meter_report();
+    }
+}
+
+void energy_meter_start(void)
+{
+    int64_t now = esp_timer_get_time();
+    g_domains[ENERGY_DOMAIN_RADIO] = (energy_domain_state_t){ENERGY_METER_RADIO_OFF, now};
+    g_domains[ENERGY_DOMAIN_DISPLAY] = (energy_domain_state_t){ENERGY_METER_DISPLAY_ON, now};
+    g_prev_us = now;
+    g_prev_counter = portGET_RUN_TIME_COUNTER_VALUE();
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        g_prev_idle[core] = idle_counter(core);
+    }
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = energy_meter_sleep_exit,
+    };
+    ESP_ERROR_CHECK(esp_pm_light_sleep_register_cbs(&cbs));
+#endif
+
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(energy_meter_task, "energy", ENERGY_METER_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                                         g_task_stack, &g_task_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(energy_meter_task, "energy", ENERGY_METER_STACK_SIZE, NULL, TASK_PRIO_AUX, &task,
+                            TASK_CORE_AUX);
+#endif
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, ENERGY_METER_STACK_SIZE);
+}
+
+#endif // CONFIG_ENERGY_METER
@@ -0,0 +1,78 @@
+#ifndef __ENERGY_METER_H__
+#define __ENERGY_METER_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 分子系统能耗估算
+ *
+ * 统计各耗电状态的停留时间，按 Kconfig 中每个状态的电流模型折算为电荷：
+ *   - 互斥状态（射频、显示屏）：各子系统在状态切换处调用 energy_meter_set_state
+ *   - 事件时间（射频空口、UART 线上字节）：按额外电流叠加在所在状态之上
+ *   - CPU 活动/空闲/浅睡：报告时由 FreeRTOS 空闲任务运行时间与浅睡回调推算
+ *   - 传感器模块：常开，按固定电流计
+ * 周期性输出每个状态的时间与平均电流、每个样本的 uAh 与按当前速率折算的每日 mAh。
+ */
+
+typedef enum {
+    ENERGY_METER_CPU_ACTIVE = 0,
+    ENERGY_METER_CPU_IDLE,
+    ENERGY_METER_CPU_SLEEP,
+    ENERGY_METER_RADIO_OFF,
+    ENERGY_METER_RADIO_RX,          // 已启动未关联：扫描/关联中，接收机常开
+    ENERGY_METER_RADIO_CONNECTED,   // 已连接，modem sleep 下的平均电流
+    ENERGY_METER_RADIO_AIR,         // 估算的收发空口时间，额外电流
+    ENERGY_METER_DISPLAY_ON,
+    ENERGY_METER_DISPLAY_DIM,
+    ENERGY_METER_DISPLAY_OFF,
+    ENERGY_METER_SENSORS,           // 传感器模块常开电流
+    ENERGY_METER_UART,              // UART 线上字节时间，额外电流（RS-485 收发器等）
+    ENERGY_METER_MAX
+} energy_meter_t;
+
+// 互斥状态所属的子系统
+typedef enum {
+    ENERGY_DOMAIN_RADIO = 0,
+    ENERGY_DOMAIN_DISPLAY,
+    ENERGY_DOMAIN_MAX
+} energy_domain_t;
+
+#if CONFIG_ENERGY_METER
+
+/**
+ * @brief 开始计时并启动报告任务，需在其他子系统启动前调用
+ */
+void energy_meter_start(void);
+
+/**
+ * @brief 子系统进入新状态，可在任意任务中调用
+ */
+void energy_meter_set_state(energy_domain_t domain, energy_meter_t state);
+
+/**
+ * @brief 累加一段事件时间（微秒），只用于 RADIO_AIR 与 UART
+ */
+void energy_meter_add_us(energy_meter_t meter, uint32_t us);
+
+/**
+ * @brief 记录一个已发布的样本，用于折算每样本电荷
+ */
+void energy_meter_note_sample(void);
+
+#else
+
+static inline void energy_meter_start(void) {}
+static inline void energy_meter_set_state(energy_domain_t domain, energy_meter_t state) {}
+static inline void energy_meter_add_us(energy_meter_t meter, uint32_t us) {}
+static inline void energy_meter_note_sample(void) {}
+
+#endif // CONFIG_ENERGY_METER
+
+// 按 8N1 计算 UART 线上字节时间
+static inline void energy_meter_note_uart(size_t bytes, uint32_t baud)
+{
+    energy_meter_add_us(ENERGY_METER_UART, (uint32_t)(bytes * 10 * 1000000ULL / baud));
+}
+
+#endif // __ENERGY_METER_H__
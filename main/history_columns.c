@@ -0,0 +1,178 @@
+#include <string.h>
+#include "history_columns.h"
+
+void history_columns_init(history_columns_t *h, history_col_block_t *blocks, history_col_summary_t *summary,
+                          uint16_t nblocks)
+{
+    h->blocks = blocks;
+    h->summary = summary;
+    h->nblocks = nblocks;
+    h->head = 0;
+    h->total = 0;
+    memset(summary, 0, sizeof(*summary) * nblocks);
+}
+
+void history_columns_append(history_columns_t *h, uint32_t t_ms, int32_t value)
+{
+    history_col_summary_t *s = &h->summary[h->head];
+    if (s->count == HISTORY_COL_BLOCK_LEN) {
+        // 当前块已满，覆盖最旧的块
+        h->head = (uint16_t)((h->head + 1) % h->nblocks);
+        s = &h->summary[h->head];
+        s->count = 0;
+    }
+    history_col_block_t *b = &h->blocks[h->head];
+    if (s->count == 0) {
+        s->t_first_ms = t_ms;
+        s->sum = 0;
+        s->min = value;
+        s->max = value;
+    }
+    b->t_ms[s->count] = t_ms;
+    b->value[s->count] = value;
+    s->t_last_ms = t_ms;
+    s->sum += value;
+    if (value < s->min) {
+        s->min = value;
+    }
+    if (value > s->max) {
+        s->max = value;
+    }
+    s->count++;
+    h->total++;
+}
+
+uint32_t history_columns_count(const history_columns_t *h)
+{
+    uint32_t n = 0;
+    for (uint16_t i = 0; i < h->nblocks; i++) {
+        n += h->summary[i].count;
+    }
+    return n;
+}
+
+// 块内第一个时间不早于 t_ms 的下标
+static uint16_t lower_bound(const uint32_t *t, uint16_t count, uint32_t t_ms)
+{
+    uint16_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t)((lo + hi) / 2);
+        if (t[mid] < t_ms) {
+            lo = (uint16_t)(mid + 1);
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// 块与区间的关系：0 不相交，1 完全包含，2 部分重叠（下标范围写入 lo/hi）
+static int block_range(const history_columns_t *h, uint16_t idx, uint32_t from_ms, uint32_t to_ms, uint16_t *lo,
+                       uint16_t *hi)
+{
+    const history_col_summary_t *s = &h->summary[idx];
+    if (s->count == 0 || s->t_last_ms < from_ms || s->t_first_ms >= to_ms) {
+        return 0;
+    }
+    if (s->t_first_ms >= from_ms && s->t_last_ms < to_ms) {
+        return 1;
+    }
+    const uint32_t *t = h->blocks[idx].t_ms;
+    *lo = lower_bound(t, s->count, from_ms);
+    *hi = lower_bound(t, s->count, to_ms);
+    return 2;
+}
+
+uint32_t history_columns_aggregate(const history_columns_t *h, uint32_t from_ms, uint32_t to_ms,
+                                   history_col_agg_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->min = INT32_MAX;
+    out->max = INT32_MIN;
+    for (uint16_t i = 0; i < h->nblocks; i++) {
+        uint16_t lo = 0, hi = 0;
+        int overlap = block_range(h, i, from_ms, to_ms, &lo, &hi);
+        if (overlap == 0) {
+            continue;
+        }
+        if (overlap == 1) {
+            const history_col_summary_t *s = &h->summary[i];
+            out->count += s->count;
+            out->sum += s->sum;
+            out->min = (s->min < out->min) ? s->min : out->min;
+            out->max = (s->max > out->max) ? s->max : out->max;
+            out->blocks_summarized++;
+            continue;
+        }
+        const int32_t *v = h->blocks[i].value;
+        int64_t sum = 0;
+        int32_t min = out->min, max = out->max;
+        for (uint16_t j = lo; j < hi; j++) {
+            sum += v[j];
+            min = (v[j] < min) ? v[j] : min;
+            max = (v[j] > max) ? v[j] : max;
+        }
+        out->count += hi - lo;
+        out->sum += sum;
+        out->min = min;
+        out->max = max;
+        out->samples_read += hi - lo;
+    }
+    return out->count;
+}
+
+// 区间内不大于 x 的样本数；摘要能判定的整块不读值列
+static uint32_t count_le(const history_columns_t *h, uint32_t from_ms, uint32_t to_ms, int32_t x)
+{
+    uint32_t n = 0;
+    for (uint16_t i = 0; i < h->nblocks; i++) {
+        const history_col_summary_t *s = &h->summary[i];
+        uint16_t lo = 0, hi = s->count;
+        int overlap = block_range(h, i, from_ms, to_ms, &lo, &hi);
+        if (overlap == 0) {
+            continue;
+        }
+        if (overlap == 1) {
+            if (s->max <= x) {
+                n += s->count;
+                continue;
+            }
+            if (s->min > x) {
+                continue;
+            }
+        }
+        const int32_t *v = h->blocks[i].value;
+        for (uint16_t j = lo; j < hi; j++) {
+            n += (v[j] <= x);
+        }
+    }
+    return n;
+}
+
+bool history_columns_percentile(const history_columns_t *h, uint32_t from_ms, uint32_t to_ms, uint8_t pct,
+                                int32_t *out)
+{
+    history_col_agg_t agg;
+    if (history_columns_aggregate(h, from_ms, to_ms, &agg) == 0) {
+        return false;
+    }
+    if (pct > 100) {
+        pct = 100;
+    }
+    // 最近秩：第 ceil(pct/100 * n) 个，至少为第 1 个
+    uint32_t rank = (uint32_t)(((uint64_t)pct * agg.count + 99) / 100);
+    if (rank == 0) {
+        rank = 1;
+    }
+    int64_t lo = agg.min, hi = agg.max;
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (count_le(h, from_ms, to_ms, (int32_t)mid) >= rank) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *out = (int32_t)lo;
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef __HISTORY_COLUMNS_H__
+#define __HISTORY_COLUMNS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * 列式内存历史：按块分段的定点样本环
+ *
+ * 只依赖标准 C，不含任务、锁与日志，可在主机上运行（见 tools/history_bench）。调用者负责互斥。
+ *
+ * 每块 HISTORY_COL_BLOCK_LEN 个样本，时间列与值列各自连续存放；另有一份块摘要
+ * （首末时间、count/sum/min/max）单独成列。区间扫描先按摘要跳过区间外的块，完全落在区间内的块
+ * 直接使用摘要，只有区间两端的块才按时间列二分定位、再顺序读取值列。求均值/最大值时
+ * 每个样本只读取 4 字节，缓存行里全是有用数据；百分位数在值域上二分，每轮只遍历值列。
+ *
+ * 写满后覆盖最旧的块。时间为开机以来毫秒，要求基本单调（乱序样本只影响所在块的摘要范围）。
+ */
+
+#define HISTORY_COL_BLOCK_LEN   256
+
+typedef struct {
+    uint32_t t_ms[HISTORY_COL_BLOCK_LEN];
+    int32_t  value[HISTORY_COL_BLOCK_LEN];   // 定点值，缩放同 sensor_sample_t.value
+} history_col_block_t;
+
+typedef struct {
+    uint32_t t_first_ms;
+    uint32_t t_last_ms;
+    int64_t  sum;
+    int32_t  min;
+    int32_t  max;
+    uint16_t count;          // 块内样本数，0 表示空块
+} history_col_summary_t;
+
+typedef struct {
+    history_col_block_t   *blocks;      // 调用者提供，nblocks 个
+    history_col_summary_t *summary;     // 调用者提供，nblocks 个
+    uint16_t nblocks;
+    uint16_t head;           // 当前写入块
+    uint32_t total;          // 累计追加的样本数
+} history_columns_t;
+
+typedef struct {
+    uint32_t count;
+    int64_t  sum;
+    int32_t  min;
+    int32_t  max;
+    uint32_t blocks_summarized;   // 直接使用摘要的块数
+    uint32_t samples_read;        // 实际读取的值列元素数
+} history_col_agg_t;
+
+/**
+ * @brief 绑定存储并清空
+ */
+void history_columns_init(history_columns_t *h, history_col_block_t *blocks, history_col_summary_t *summary,
+                          uint16_t nblocks);
+
+void history_columns_append(history_columns_t *h, uint32_t t_ms, int32_t value);
+
+/**
+ * @brief 当前保留的样本数
+ */
+uint32_t history_columns_count(const history_columns_t *h);
+
+/**
+ * @brief 统计 [from_ms, to_ms) 内样本的 count/sum/min/max
+ * @return 区间内的样本数
+ */
+uint32_t history_columns_aggregate(const history_columns_t *h, uint32_t from_ms, uint32_t to_ms,
+                                   history_col_agg_t *out);
+
+/**
+ * @brief [from_ms, to_ms) 内样本的第 pct 百分位数（最近秩法），不需要额外缓冲区
+ *
+ * 在 [min, max] 值域上二分，每轮统计不大于中点的样本数，约 32 轮值列扫描。
+ * @return false 表示区间内没有样本
+ */
+bool history_columns_percentile(const history_columns_t *h, uint32_t from_ms, uint32_t to_ms, uint8_t pct,
+                                int32_t *out);
+
+#endif // __HISTORY_COLUMNS_H__
@@ -0,0 +1,238 @@
+#include "sdkconfig.h"
+
+#if CONFIG_HISTORY_EXPORT
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_http_client.h"
+#include "history_export.h"
+#include "history_store.h"
+#include "protocols/mqtt_device.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+// HTTP 客户端与 TCP 发送在本任务栈上运行
+#define HISTORY_EXPORT_STACK_SIZE       6144
+#define HISTORY_EXPORT_HTTP_TIMEOUT_MS  5000
+#define HISTORY_EXPORT_HTTP_BUFFER      512
+
+static const char *TAG = "history_export";
+
+typedef struct {
+    history_export_target_t target;
+    esp_http_client_handle_t http;
+    uint32_t bytes;
+    uint32_t sectors;
+    uint32_t recycled;
+    size_t min_free;         // 导出期间观察到的最小空闲堆
+} export_ctx_t;
+
+static QueueHandle_t g_requests = NULL;
+static history_export_stats_t g_last;
+static bool g_last_valid = false;
+static portMUX_TYPE g_last_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticQueue_t g_requests_struct;
+static uint8_t g_requests_storage[sizeof(history_export_target_t)];
+static StackType_t g_task_stack[HISTORY_EXPORT_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+static void export_account(export_ctx_t *c, size_t len)
+{
+    c->bytes += len;
+    c->sectors++;
+    c->min_free = MIN(c->min_free, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+}
+
+// esp-mqtt 的 QoS 0 发布在负载超过发送缓冲时直接从 data 分段写入套接字
+static bool mqtt_chunk(const void *data, size_t len, void *ctx)
+{
+    if (!mqtt_device_publish_raw(CONFIG_HISTORY_EXPORT_TOPIC, data, len)) {
+        return false;
+    }
+    export_account(ctx, len);
+    return true;
+}
+
+// 自行封装 chunk：长度行与结尾 CRLF 之间直接写映射的扇区
+static bool http_write_chunk(export_ctx_t *c, const void *data, size_t len)
+{
+    char size_line[12];
+    int n = snprintf(size_line, sizeof(size_line), "%x\r\n", (unsigned)len);
+    return esp_http_client_write(c->http, size_line, n) == n &&
+           esp_http_client_write(c->http, data, (int)len) == (int)len &&
+           esp_http_client_write(c->http, "\r\n", 2) == 2;
+}
+
+static bool http_chunk(const void *data, size_t len, void *ctx)
+{
+    if (!http_write_chunk(ctx, data, len)) {
+        return false;
+    }
+    export_account(ctx, len);
+    return true;
+}
+
+// 发送期间被擦除复用的扇区：紧跟一条文本标记 "drop,层,序号"，接收端丢弃刚收到的同层同序号扇区
+static bool export_recycled(uint8_t tier, uint32_t seq, void *ctx)
+{
+    export_ctx_t *c = ctx;
+    char mark[24];
+    int len = snprintf(mark, sizeof(mark), "drop,%u,%lu", tier, (unsigned long)seq);
+    c->recycled++;
+    return (c->target == HISTORY_EXPORT_HTTP) ? http_write_chunk(c, mark, len)
+                                              : mqtt_device_publish_raw(CONFIG_HISTORY_EXPORT_TOPIC, mark, len);
+}
+
+static esp_err_t export_http(export_ctx_t *c)
+{
+    if (CONFIG_HISTORY_EXPORT_URL[0] == '\0') {
+        ESP_LOGW(TAG, "HISTORY_EXPORT_URL not set");
+        return ESP_ERR_INVALID_STATE;
+    }
+    const esp_http_client_config_t cfg = {
+        .url = CONFIG_HISTORY_EXPORT_URL,
+        .method = HTTP_METHOD_POST,
+        .timeout_ms = HISTORY_EXPORT_HTTP_TIMEOUT_MS,
+        .buffer_size = HISTORY_EXPORT_HTTP_BUFFER,
+        .buffer_size_tx = HISTORY_EXPORT_HTTP_BUFFER,
+    };
+    c->http = esp_http_client_init(&cfg);
+    if (!c->http) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_http_client_set_header(c->http, "Content-Type", "application/octet-stream");
+    // 长度为负时使用 chunked 传输编码，总长度无需事先计算
+    esp_err_t err = esp_http_client_open(c->http, -1);
+    if (err == ESP_OK) {
+        err = history_store_export(http_chunk, export_recycled, c);
+    }
+    if (err == ESP_OK && esp_http_client_write(c->http, "0\r\n\r\n", 5) != 5) {
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK && esp_http_client_fetch_headers(c->http) < 0) {
+        err = ESP_FAIL;
+    }
+    if (err == ESP_OK) {
+        int status = esp_http_client_get_status_code(c->http);
+        if (status / 100 != 2) {
+            ESP_LOGW(TAG, "Server replied %d", status);
+            err = ESP_FAIL;
+        }
+    }
+    esp_http_client_cleanup(c->http);
+    c->http = NULL;
+    return err;
+}
+
+static void export_run(history_export_target_t target)
+{
+    export_ctx_t c = {.target = target, .min_free = heap_caps_get_free_size(MALLOC_CAP_8BIT)};
+    const size_t start_free = c.min_free;
+    const int64_t start_us = esp_timer_get_time();
+
+    esp_err_t err = (target == HISTORY_EXPORT_HTTP) ? export_http(&c)
+                                                    : history_store_export(mqtt_chunk, export_recycled, &c);
+
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    history_export_stats_t stats = {
+        .bytes = c.bytes,
+        .sectors = c.sectors,
+        .recycled = c.recycled,
+        .elapsed_ms = elapsed_ms,
+        .kbps = elapsed_ms ? (uint32_t)((uint64_t)c.bytes * 1000 / 1024 / elapsed_ms) : 0,
+        .heap_peak = (uint32_t)(start_free - c.min_free),
+        .stack_peak = HISTORY_EXPORT_STACK_SIZE - uxTaskGetStackHighWaterMark(NULL),
+        .err = err,
+    };
+    portENTER_CRITICAL(&g_last_lock);
+    g_last = stats;
+    g_last_valid = true;
+    portEXIT_CRITICAL(&g_last_lock);
+
+    ESP_LOGI(TAG,
+             "%s export %s: %lu B in %lu sectors (%lu recycled), %lu ms, %lu KB/s, peak RAM %lu B heap + %lu B stack",
+             (target == HISTORY_EXPORT_HTTP) ? "HTTP" : "MQTT", esp_err_to_name(err), (unsigned long)stats.bytes,
+             (unsigned long)stats.sectors, (unsigned long)stats.recycled, (unsigned long)stats.elapsed_ms,
+             (unsigned long)stats.kbps,
+             (unsigned long)stats.heap_peak, (unsigned long)stats.stack_peak);
+
+    // 文本结束标记，扇区负载总以二进制魔数开头，不会与之混淆
+    if (target == HISTORY_EXPORT_MQTT) {
+        char end[80];
+        int len = snprintf(end, sizeof(end), "end,%d,%lu,%lu,%lu,%lu,%lu", err, (unsigned long)stats.bytes,
+                           (unsigned long)stats.elapsed_ms, (unsigned long)stats.kbps,
+                           (unsigned long)(stats.heap_peak + stats.stack_peak), (unsigned long)stats.recycled);
+        mqtt_device_publish_raw(CONFIG_HISTORY_EXPORT_TOPIC, end, len);
+    }
+}
+
+static void history_export_task(void *pvParameters)
+{
+    history_export_target_t target;
+    while (1) {
+        if (xQueueReceive(g_requests, &target, portMAX_DELAY) == pdTRUE) {
+            export_run(target);
+        }
+    }
+}
+
+bool history_export_request(history_export_target_t target)
+{
+    return g_requests && xQueueSend(g_requests, &target, 0) == pdTRUE;
+}
+
+void history_export_handle_command(const char *data, size_t len)
+{
+    history_export_target_t target = (len == 4 && memcmp(data, "http", 4) == 0) ? HISTORY_EXPORT_HTTP
+                                                                                : HISTORY_EXPORT_MQTT;
+    if (!history_export_request(target)) {
+        ESP_LOGW(TAG, "Export already pending");
+    }
+}
+
+bool history_export_get_last(history_export_stats_t *out)
+{
+    portENTER_CRITICAL(&g_last_lock);
+    bool valid = g_last_valid;
+    if (valid) {
+        *out = g_last;
+    }
+    portEXIT_CRITICAL(&g_last_lock);
+    return valid;
+}
+
+void history_export_init(void)
+{
+#if CONFIG_STATIC_ALLOCATION
+    g_requests = xQueueCreateStatic(1, sizeof(history_export_target_t), g_requests_storage, &g_requests_struct);
+#else
+    g_requests = xQueueCreate(1, sizeof(history_export_target_t));
+#endif
+
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(history_export_task, "history_export", HISTORY_EXPORT_STACK_SIZE, NULL,
+                                         TASK_PRIO_AUX, g_task_stack, &g_task_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(history_export_task, "history_export", HISTORY_EXPORT_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                            &task, TASK_CORE_AUX);
+#endif
+    // HTTP 导出按需创建客户端，配置了导出 URL 时本任务不纳入稳态零分配检查
+    if (CONFIG_HISTORY_EXPORT_URL[0] == '\0') {
+        alloc_guard_track_task(task);
+    }
+    mem_profiler_register_task(task, HISTORY_EXPORT_STACK_SIZE);
+}
+
+#endif // CONFIG_HISTORY_EXPORT
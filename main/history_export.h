@@ -0,0 +1,64 @@
+#ifndef __HISTORY_EXPORT_H__
+#define __HISTORY_EXPORT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**
+ * 长期历史的整分区导出
+ *
+ * 按请求把 storage 分区中各层已写入的扇区原样发送：MQTT 每个扇区一条消息，
+ * HTTP 为一次 chunked POST、每个扇区一个 chunk。数据直接从 esp_partition_mmap 映射的 flash 发送，
+ * 不复制到 RAM，发送期间不持存储锁。负载格式即扇区格式（见 history_ring.h），
+ * 扇区头携带层与序号，接收端可据此排序并丢弃重复；发送期间被擦除复用的扇区随后跟一条
+ * "drop,层,序号" 文本标记。导出结束后记录吞吐（KB/s）与峰值 RAM（堆的最大降幅 + 导出任务栈峰值）。
+ */
+
+typedef enum {
+    HISTORY_EXPORT_MQTT = 0,
+    HISTORY_EXPORT_HTTP,
+} history_export_target_t;
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t sectors;
+    uint32_t recycled;       // 发送期间被擦除复用、已标记丢弃的扇区数
+    uint32_t elapsed_ms;
+    uint32_t kbps;           // KB/s
+    uint32_t heap_peak;      // 导出期间空闲堆的最大降幅（字节），含其他任务的分配
+    uint32_t stack_peak;     // 导出任务栈峰值（字节）
+    esp_err_t err;
+} history_export_stats_t;
+
+#if CONFIG_HISTORY_EXPORT
+
+void history_export_init(void);
+
+/**
+ * @brief 请求一次导出，在导出任务中执行
+ * @return 已有请求在排队时返回 false
+ */
+bool history_export_request(history_export_target_t target);
+
+/**
+ * @brief 处理请求主题上的消息，负载为 "mqtt" 或 "http"
+ */
+void history_export_handle_command(const char *data, size_t len);
+
+/**
+ * @brief 最近一次导出的结果，尚未导出过时返回 false
+ */
+bool history_export_get_last(history_export_stats_t *out);
+
+#else
+
+static inline void history_export_init(void) {}
+static inline bool history_export_request(history_export_target_t target) { return false; }
+static inline void history_export_handle_command(const char *data, size_t len) {}
+static inline bool history_export_get_last(history_export_stats_t *out) { return false; }
+
+#endif // CONFIG_HISTORY_EXPORT
+
+#endif // __HISTORY_EXPORT_H__
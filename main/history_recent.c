@@ -0,0 +1,275 @@
+#include "sdkconfig.h"
+
+#if CONFIG_HISTORY_RECENT
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "sensor_channel.h"
+#include "history_recent.h"
+
+static const char *TAG = "history_recent";
+
+#define RECENT_SERIES       CONFIG_HISTORY_RECENT_SERIES
+#define RECENT_BLOCKS       CONFIG_HISTORY_RECENT_BLOCKS
+#define SERIES_NONE         0xFF
+
+#if CONFIG_HISTORY_RECENT_PSRAM
+#define RECENT_CAPS         (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define RECENT_CAPS         (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+#if CONFIG_HISTORY_RECENT_PSRAM
+static history_col_block_t *g_blocks = NULL;
+#else
+static history_col_block_t g_blocks[RECENT_SERIES * RECENT_BLOCKS];
+#endif
+// 摘要列很小，始终放在内部 RAM
+static history_col_summary_t g_summary[RECENT_SERIES * RECENT_BLOCKS];
+static history_columns_t g_series[RECENT_SERIES];
+// 通道槽位 -> 序列下标，首次追加时按到达顺序分配
+static uint8_t g_series_of_slot[SENSOR_CH_SLOTS];
+static uint8_t g_series_used = 0;
+// 追加与查询之间的互斥；查询耗时与序列长度成正比，不能放进临界区
+static SemaphoreHandle_t g_lock = NULL;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticSemaphore_t g_lock_buf;
+#endif
+
+void history_recent_start(void)
+{
+#if CONFIG_HISTORY_RECENT_PSRAM
+    g_blocks = heap_caps_calloc(RECENT_SERIES * RECENT_BLOCKS, sizeof(history_col_block_t), RECENT_CAPS);
+    if (!g_blocks) {
+        ESP_LOGE(TAG, "No PSRAM for %u blocks, recent history disabled", RECENT_SERIES * RECENT_BLOCKS);
+        return;
+    }
+#endif
+#if CONFIG_STATIC_ALLOCATION
+    g_lock = xSemaphoreCreateMutexStatic(&g_lock_buf);
+#else
+    g_lock = xSemaphoreCreateMutex();
+#endif
+    memset(g_series_of_slot, SERIES_NONE, sizeof(g_series_of_slot));
+    for (int i = 0; i < RECENT_SERIES; i++) {
+        history_columns_init(&g_series[i], &g_blocks[i * RECENT_BLOCKS], &g_summary[i * RECENT_BLOCKS], RECENT_BLOCKS);
+    }
+    ESP_LOGI(TAG, "%u series x %u samples, %u KB", RECENT_SERIES, RECENT_BLOCKS * HISTORY_COL_BLOCK_LEN,
+             (unsigned)(RECENT_SERIES * RECENT_BLOCKS * sizeof(history_col_block_t) / 1024));
+}
+
+// 调用者持有 g_lock
+static history_columns_t *series_of(int slot, bool assign)
+{
+    uint8_t s = g_series_of_slot[slot];
+    if (s == SERIES_NONE && assign && g_series_used < RECENT_SERIES) {
+        s = g_series_used++;
+        g_series_of_slot[slot] = s;
+        sensor_id_t id;
+        sensor_channel_t ch;
+        if (sensor_channel_slot_source(slot, &id, &ch)) {
+            ESP_LOGI(TAG, "%s/%s -> series %u", sensor_id_name(id), sensor_channel_name(ch), s);
+        }
+    }
+    return (s == SERIES_NONE) ? NULL : &g_series[s];
+}
+
+bool history_recent_track(sensor_id_t id, sensor_channel_t channel)
+{
+    int slot = sensor_channel_find_slot(id, channel);
+    if (!g_lock || slot < 0) {
+        return false;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    bool ok = series_of(slot, true) != NULL;
+    xSemaphoreGive(g_lock);
+    return ok;
+}
+
+void history_recent_append(const sensor_sample_t *sample)
+{
+    int slot = sensor_channel_find_slot(sample->sensor_id, sample->channel);
+    if (!g_lock || slot < 0) {
+        return;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    history_columns_t *h = series_of(slot, true);
+    if (h) {
+        history_columns_append(h, sample->timestamp_ms, sample->value);
+    }
+    xSemaphoreGive(g_lock);
+}
+
+uint32_t history_recent_aggregate(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms, uint32_t to_ms,
+                                  history_col_agg_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    int slot = sensor_channel_find_slot(id, channel);
+    if (!g_lock || slot < 0) {
+        return 0;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    history_columns_t *h = series_of(slot, false);
+    uint32_t n = h ? history_columns_aggregate(h, from_ms, to_ms, out) : 0;
+    xSemaphoreGive(g_lock);
+    return n;
+}
+
+bool history_recent_percentile(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms, uint32_t to_ms,
+                               uint8_t pct, int32_t *out)
+{
+    int slot = sensor_channel_find_slot(id, channel);
+    if (!g_lock || slot < 0) {
+        return false;
+    }
+    xSemaphoreTake(g_lock, portMAX_DELAY);
+    history_columns_t *h = series_of(slot, false);
+    bool ok = h && history_columns_percentile(h, from_ms, to_ms, pct, out);
+    xSemaphoreGive(g_lock);
+    return ok;
+}
+
+#if CONFIG_HISTORY_RECENT_BENCH
+
+#define BENCH_SAMPLES       CONFIG_HISTORY_RECENT_BENCH_SAMPLES
+#define BENCH_BLOCKS        ((BENCH_SAMPLES + HISTORY_COL_BLOCK_LEN - 1) / HISTORY_COL_BLOCK_LEN)
+#define BENCH_PERIOD_MS     1000
+#define BENCH_REPS          10
+
+// 改为定点样本之前的 RAM 历史记录布局，16 字节
+typedef struct {
+    float    ch2o_ugm3;
+    float    ch2o_ppb;
+    uint32_t timestamp;
+    uint32_t count;
+} legacy_record_t;
+
+static int cmp_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static int32_t bench_value(uint32_t *state, int i)
+{
+    *state = *state * 1664525u + 1013904223u;
+    // 30 ppb 基线、缓慢起伏加 ±2 ppb 噪声，0.1 ppb 定点
+    return 300 + (i / 600 % 10) * 20 + (int32_t)((*state >> 16) % 41) - 20;
+}
+
+static void bench_run(legacy_record_t *legacy, float *scratch, history_col_block_t *blocks,
+                      history_col_summary_t *summary)
+{
+    history_columns_t cols;
+    history_columns_init(&cols, blocks, summary, BENCH_BLOCKS);
+    uint32_t rng = 1;
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        int32_t v = bench_value(&rng, i);
+        uint32_t t = (uint32_t)i * BENCH_PERIOD_MS;
+        legacy[i].ch2o_ppb = (float)v / SENSOR_HCHO_SCALE;
+        legacy[i].ch2o_ugm3 = legacy[i].ch2o_ppb * SENSOR_HCHO_UGM3_PER_PPB_X1000 / 1000.0f;
+        legacy[i].timestamp = t;
+        legacy[i].count = 1;
+        history_columns_append(&cols, t, v);
+    }
+    // 查询后一半样本，两端落在块中间
+    uint32_t from_ms = (BENCH_SAMPLES / 2 + 17) * BENCH_PERIOD_MS;
+    uint32_t to_ms = (BENCH_SAMPLES - 5) * BENCH_PERIOD_MS;
+
+    // 旧布局：逐条读 16 字节记录，百分位需拷出后排序
+    float l_sum = 0, l_max = -1e9f, l_p95 = 0;
+    int64_t t0 = esp_timer_get_time();
+    for (int r = 0; r < BENCH_REPS; r++) {
+        l_sum = 0;
+        l_max = -1e9f;
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            if (legacy[i].timestamp >= from_ms && legacy[i].timestamp < to_ms) {
+                l_sum += legacy[i].ch2o_ppb;
+                l_max = (legacy[i].ch2o_ppb > l_max) ? legacy[i].ch2o_ppb : l_max;
+            }
+        }
+    }
+    int64_t t1 = esp_timer_get_time();
+    uint32_t n = 0;
+    for (int r = 0; r < BENCH_REPS; r++) {
+        n = 0;
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            if (legacy[i].timestamp >= from_ms && legacy[i].timestamp < to_ms) {
+                scratch[n++] = legacy[i].ch2o_ppb;
+            }
+        }
+        qsort(scratch, n, sizeof(float), cmp_float);
+        l_p95 = scratch[(95 * n + 99) / 100 - 1];
+    }
+    int64_t t2 = esp_timer_get_time();
+
+    // 值列逐样本扫描，不使用块摘要
+    int64_t r_sum = 0;
+    int32_t r_max = INT32_MIN;
+    for (int r = 0; r < BENCH_REPS; r++) {
+        r_sum = 0;
+        r_max = INT32_MIN;
+        for (int b = 0; b < BENCH_BLOCKS; b++) {
+            const history_col_block_t *blk = &blocks[b];
+            for (int j = 0; j < summary[b].count; j++) {
+                if (blk->t_ms[j] >= from_ms && blk->t_ms[j] < to_ms) {
+                    r_sum += blk->value[j];
+                    r_max = (blk->value[j] > r_max) ? blk->value[j] : r_max;
+                }
+            }
+        }
+    }
+    int64_t t3 = esp_timer_get_time();
+
+    // 块摘要 + 两端块扫描
+    history_col_agg_t agg;
+    for (int r = 0; r < BENCH_REPS; r++) {
+        history_columns_aggregate(&cols, from_ms, to_ms, &agg);
+    }
+    int64_t t4 = esp_timer_get_time();
+    int32_t c_p95 = 0;
+    for (int r = 0; r < BENCH_REPS; r++) {
+        history_columns_percentile(&cols, from_ms, to_ms, 95, &c_p95);
+    }
+    int64_t t5 = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "bench %lu of %u samples, mean/max/p95 (0.1 ppb): legacy %ld/%ld/%ld columns %ld/%ld/%ld",
+             (unsigned long)agg.count, BENCH_SAMPLES, (long)(l_sum * SENSOR_HCHO_SCALE / n),
+             (long)(l_max * SENSOR_HCHO_SCALE), (long)(l_p95 * SENSOR_HCHO_SCALE),
+             (long)(agg.sum / agg.count), (long)agg.max, (long)c_p95);
+    ESP_LOGI(TAG, "bench mean+max: legacy AoS %lld us, value column %lld us (max %ld, sum %lld), block summaries %lld us "
+             "(%lu blocks summarized, %lu samples read)",
+             (long long)((t1 - t0) / BENCH_REPS), (long long)((t3 - t2) / BENCH_REPS), (long)r_max,
+             (long long)r_sum, (long long)((t4 - t3) / BENCH_REPS), (unsigned long)agg.blocks_summarized,
+             (unsigned long)agg.samples_read);
+    ESP_LOGI(TAG, "bench p95: legacy copy+qsort %lld us, value-domain bisection %lld us",
+             (long long)((t2 - t1) / BENCH_REPS), (long long)((t5 - t4) / BENCH_REPS));
+}
+
+void history_recent_bench(void)
+{
+    legacy_record_t *legacy = heap_caps_malloc(BENCH_SAMPLES * sizeof(legacy_record_t), RECENT_CAPS);
+    float *scratch = heap_caps_malloc(BENCH_SAMPLES * sizeof(float), RECENT_CAPS);
+    history_col_block_t *blocks = heap_caps_malloc(BENCH_BLOCKS * sizeof(history_col_block_t), RECENT_CAPS);
+    history_col_summary_t *summary = heap_caps_malloc(BENCH_BLOCKS * sizeof(history_col_summary_t),
+                                                      MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (legacy && scratch && blocks && summary) {
+        bench_run(legacy, scratch, blocks, summary);
+    } else {
+        ESP_LOGE(TAG, "bench: no memory for %u samples", BENCH_SAMPLES);
+    }
+    heap_caps_free(legacy);
+    heap_caps_free(scratch);
+    heap_caps_free(blocks);
+    heap_caps_free(summary);
+}
+
+#endif // CONFIG_HISTORY_RECENT_BENCH
+
+#endif // CONFIG_HISTORY_RECENT
@@ -0,0 +1,73 @@
+#ifndef __HISTORY_RECENT_H__
+#define __HISTORY_RECENT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "sensor.h"
+#include "history_columns.h"
+
+/**
+ * 近期原始样本的列式内存历史
+ *
+ * 为若干个 (传感器, 通道) 各保留一条 history_columns_t 序列，按到达顺序保存滤波后的定点值，
+ * 供设备端在最近几十分钟内做均值/极值/百分位统计而不必读 flash（静态布局的传感器页即由此显示
+ * 窗口均值与 p95）。序列先分给 history_recent_track 预留的来源，其余按首次发布的顺序分配。
+ * 与 sensor_history 的按时间桶降采样不同，这里保留每个样本；与 history_store 不同，
+ * 时间为开机以来毫秒，不依赖对时。容量见 Kconfig HISTORY_RECENT_BLOCKS。
+ */
+
+#if CONFIG_HISTORY_RECENT
+
+/**
+ * @brief 分配序列存储，需在传感器开始发布前调用
+ */
+void history_recent_start(void);
+
+/**
+ * @brief 为来源预留一条序列，需在 history_recent_start 之后、传感器开始发布前调用
+ * @return 序列已用完或来源无效时返回 false
+ */
+bool history_recent_track(sensor_id_t id, sensor_channel_t channel);
+
+/**
+ * @brief 追加一个样本，由 sensor_publish 调用；未分到序列的来源直接忽略
+ */
+void history_recent_append(const sensor_sample_t *sample);
+
+/**
+ * @brief 统计 [from_ms, to_ms) 内的样本（开机以来毫秒）
+ * @return 区间内的样本数，来源没有序列时返回 0
+ */
+uint32_t history_recent_aggregate(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms, uint32_t to_ms,
+                                  history_col_agg_t *out);
+
+/**
+ * @brief [from_ms, to_ms) 内样本的第 pct 百分位数
+ * @return false 表示区间内没有样本
+ */
+bool history_recent_percentile(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms, uint32_t to_ms,
+                               uint8_t pct, int32_t *out);
+
+#if CONFIG_HISTORY_RECENT_BENCH
+/**
+ * @brief 比较旧 AoS 记录、逐样本值列扫描与块摘要三种方式的 mean/max/p95 耗时并打印
+ *
+ * 临时缓冲区在函数内分配并释放，需在 alloc_guard_seal() 之前调用。
+ */
+void history_recent_bench(void);
+#endif
+
+#else
+
+static inline void history_recent_start(void) {}
+static inline bool history_recent_track(sensor_id_t id, sensor_channel_t channel) { return false; }
+static inline void history_recent_append(const sensor_sample_t *sample) {}
+static inline uint32_t history_recent_aggregate(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms,
+                                                uint32_t to_ms, history_col_agg_t *out) { return 0; }
+static inline bool history_recent_percentile(sensor_id_t id, sensor_channel_t channel, uint32_t from_ms,
+                                             uint32_t to_ms, uint8_t pct, int32_t *out) { return false; }
+
+#endif // CONFIG_HISTORY_RECENT
+
+#endif // __HISTORY_RECENT_H__
@@ -0,0 +1,285 @@
+#include <stddef.h>
+#include <string.h>
+#include "history_ring.h"
+
+#define HISTORY_SECTOR_MAGIC    0x54534948   // "HIST"
+
+// 扇区头；环的布局写入头中，改变扇区划分后旧扇区自动视为未格式化
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;            // 扇区启用顺序，环内逐扇区加一
+    uint8_t  tier;
+    uint8_t  reserved;
+    uint16_t first_sector;   // 所属环在分区内的起始扇区
+    uint16_t sectors;        // 所属环的扇区数
+    uint16_t reserved2;
+} history_sector_header_t;
+
+_Static_assert(sizeof(history_sector_header_t) == sizeof(history_record_t), "header must fill one record slot");
+
+static inline uint32_t sector_offset(const history_ring_t *r, uint16_t idx)
+{
+    return (uint32_t)(r->first_sector + idx) * HISTORY_SECTOR_SIZE;
+}
+
+static inline uint32_t record_offset(const history_ring_t *r, uint16_t idx, uint16_t slot)
+{
+    return sector_offset(r, idx) + (uint32_t)(slot + 1) * sizeof(history_record_t);
+}
+
+// 环内位置（0 为最旧扇区）换算为扇区下标
+static inline uint16_t pos_to_idx(const history_ring_t *r, uint16_t pos)
+{
+    return (uint16_t)((r->head + 1 + pos) % r->sectors);
+}
+
+static inline uint16_t used_slots(const history_ring_t *r, uint16_t idx)
+{
+    return (idx == r->head) ? r->head_slot : HISTORY_RECORDS_PER_SECTOR;
+}
+
+static bool read_header(const history_ring_t *r, uint16_t idx, uint32_t *seq)
+{
+    history_sector_header_t hdr;
+    if (esp_partition_read(r->part, sector_offset(r, idx), &hdr, sizeof(hdr)) != ESP_OK) {
+        return false;
+    }
+    if (hdr.magic != HISTORY_SECTOR_MAGIC || hdr.tier != r->tier || hdr.first_sector != r->first_sector ||
+        hdr.sectors != r->sectors) {
+        return false;
+    }
+    *seq = hdr.seq;
+    return true;
+}
+
+static uint32_t read_time(const history_ring_t *r, uint16_t idx, uint16_t slot)
+{
+    uint32_t t_s = HISTORY_ERASED_TIME;
+    esp_partition_read(r->part, record_offset(r, idx, slot), &t_s, sizeof(t_s));
+    return t_s;
+}
+
+// 擦除扇区并写入扇区头，最旧的数据随之淘汰
+static esp_err_t start_sector(history_ring_t *r, uint16_t idx, uint32_t seq)
+{
+    esp_err_t err = esp_partition_erase_range(r->part, sector_offset(r, idx), HISTORY_SECTOR_SIZE);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const history_sector_header_t hdr = {
+        .magic = HISTORY_SECTOR_MAGIC,
+        .seq = seq,
+        .tier = r->tier,
+        .first_sector = r->first_sector,
+        .sectors = r->sectors,
+    };
+    err = esp_partition_write(r->part, sector_offset(r, idx), &hdr, sizeof(hdr));
+    if (err != ESP_OK) {
+        return err;
+    }
+    r->head = idx;
+    r->head_seq = seq;
+    r->head_slot = 0;
+    r->first_t[idx] = HISTORY_ERASED_TIME;
+    r->erased++;
+    return ESP_OK;
+}
+
+esp_err_t history_ring_recover(history_ring_t *r)
+{
+    bool found = false;
+    for (uint16_t idx = 0; idx < r->sectors; idx++) {
+        uint32_t seq;
+        if (!read_header(r, idx, &seq)) {
+            // 未格式化的扇区只会出现在最旧一端，索引记为 0 使二分查找越过它们
+            r->first_t[idx] = 0;
+            continue;
+        }
+        r->first_t[idx] = read_time(r, idx, 0);
+        if (!found || (int32_t)(seq - r->head_seq) > 0) {
+            r->head = idx;
+            r->head_seq = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        return start_sector(r, 0, 1);
+    }
+
+    // 记录按顺序追加，已用槽位构成前缀
+    uint16_t lo = 0, hi = HISTORY_RECORDS_PER_SECTOR;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (read_time(r, r->head, mid) != HISTORY_ERASED_TIME) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    r->head_slot = lo;
+    return ESP_OK;
+}
+
+esp_err_t history_ring_append(history_ring_t *r, const history_record_t *rec)
+{
+    if (r->head_slot >= HISTORY_RECORDS_PER_SECTOR) {
+        esp_err_t err = start_sector(r, (r->head + 1) % r->sectors, r->head_seq + 1);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    esp_err_t err = esp_partition_write(r->part, record_offset(r, r->head, r->head_slot), rec, sizeof(*rec));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (r->head_slot == 0) {
+        r->first_t[r->head] = rec->t_s;
+    }
+    r->head_slot++;
+    return ESP_OK;
+}
+
+// 扇区按序号依次启用，序号在最近 sectors 个之内的扇区尚未被擦除复用
+static inline bool seq_live(const history_ring_t *r, uint32_t seq)
+{
+    return (uint32_t)(r->head_seq - seq) < r->sectors;
+}
+
+static inline uint16_t seq_to_idx(const history_ring_t *r, uint32_t seq)
+{
+    return (uint16_t)((r->head + r->sectors - (r->head_seq - seq)) % r->sectors);
+}
+
+bool history_ring_seq_live(const history_ring_t *r, uint32_t seq)
+{
+    return seq_live(r, seq);
+}
+
+bool history_ring_sector_span(const history_ring_t *r, uint32_t seq, uint32_t *offset, uint32_t *len)
+{
+    if (!seq_live(r, seq)) {
+        return false;
+    }
+    uint16_t idx = seq_to_idx(r, seq);
+    uint32_t hdr_seq;
+    if (!read_header(r, idx, &hdr_seq) || hdr_seq != seq) {
+        return false;
+    }
+    *offset = sector_offset(r, idx);
+    *len = (uint32_t)(used_slots(r, idx) + 1) * sizeof(history_record_t);
+    return true;
+}
+
+// 写入端绕过遍历位置时，跳过已被复用的扇区并计为丢失
+static void iter_next_sector(const history_ring_t *r, history_ring_iter_t *it)
+{
+    if ((int32_t)(it->seq - r->head_seq) >= 0) {
+        it->done = true;
+        return;
+    }
+    it->seq++;
+    if (!seq_live(r, it->seq)) {
+        uint32_t oldest = r->head_seq - r->sectors + 1;
+        it->lost += oldest - it->seq;
+        it->seq = oldest;
+    }
+    it->idx = seq_to_idx(r, it->seq);
+    it->slot = 0;
+}
+
+void history_ring_iter_begin(const history_ring_t *r, history_ring_iter_t *it, uint32_t from_s, uint32_t to_s,
+                             uint32_t slack_s)
+{
+    memset(it, 0, offsetof(history_ring_iter_t, batch));
+    it->from_s = from_s;
+    it->to_s = to_s;
+    it->slack_s = slack_s;
+    uint32_t key = (from_s > slack_s) ? from_s - slack_s : 0;
+
+    // 对扇区二分：最后一个首条记录时间 <= key 的扇区，都更晚时从最旧扇区开始
+    uint16_t lo = 0, hi = r->sectors;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (r->first_t[pos_to_idx(r, mid)] <= key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    uint16_t pos = lo ? lo - 1 : 0;
+    for (; pos < r->sectors; pos++) {
+        it->idx = pos_to_idx(r, pos);
+        it->flash_reads++;
+        if (read_header(r, it->idx, &it->seq)) {
+            break;
+        }
+    }
+    if (pos == r->sectors) {
+        it->done = true;
+        return;
+    }
+
+    // 扇区内二分：第一条时间 >= key 的记录
+    lo = 0;
+    hi = used_slots(r, it->idx);
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        it->flash_reads++;
+        uint32_t t_s = read_time(r, it->idx, mid);
+        if (t_s != HISTORY_ERASED_TIME && t_s < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    it->slot = lo;
+}
+
+static void iter_refill(const history_ring_t *r, history_ring_iter_t *it)
+{
+    if (!seq_live(r, it->seq)) {
+        it->lost++;
+        iter_next_sector(r, it);
+        return;
+    }
+    uint16_t used = (it->seq == r->head_seq) ? r->head_slot : HISTORY_RECORDS_PER_SECTOR;
+    if (it->slot >= used) {
+        iter_next_sector(r, it);
+        return;
+    }
+    uint16_t n = used - it->slot;
+    if (n > HISTORY_RING_ITER_BATCH) {
+        n = HISTORY_RING_ITER_BATCH;
+    }
+    it->flash_reads++;
+    if (esp_partition_read(r->part, record_offset(r, it->idx, it->slot), it->batch, n * sizeof(history_record_t)) != ESP_OK) {
+        it->done = true;
+        return;
+    }
+    it->slot += n;
+    it->pos = 0;
+    it->count = (uint8_t)n;
+}
+
+const history_record_t *history_ring_iter_next(const history_ring_t *r, history_ring_iter_t *it)
+{
+    const uint64_t stop_s = (uint64_t)it->to_s + it->slack_s;
+    while (!it->done) {
+        if (it->pos >= it->count) {
+            iter_refill(r, it);
+            continue;
+        }
+        const history_record_t *rec = &it->batch[it->pos++];
+        if (rec->t_s == HISTORY_ERASED_TIME) {
+            continue;
+        }
+        if (rec->t_s >= stop_s) {
+            it->done = true;
+            break;
+        }
+        if (rec->t_s >= it->from_s && rec->t_s < it->to_s) {
+            return rec;
+        }
+    }
+    return NULL;
+}
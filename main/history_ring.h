@@ -0,0 +1,107 @@
+#ifndef __HISTORY_RING_H__
+#define __HISTORY_RING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+/**
+ * 分区上的扇区环与稀疏时间索引
+ *
+ * 只依赖 esp_partition 读写接口，不含任务、锁与日志，可在主机上对分区镜像文件运行
+ * （见 tools/history_bench）。调用者负责互斥。
+ *
+ * 扇区布局：| 扇区头 16B | 记录 x HISTORY_RECORDS_PER_SECTOR |
+ * 记录按追加顺序写入，时间基本单调；RAM 中为每个扇区保存首条记录的时间，
+ * 定位区间起点时先对扇区二分，再在扇区内对记录二分，只读取 O(log n) 条记录。
+ */
+
+/**
+ * @brief 各层共用的 16 字节记录，原始层 count 为 1
+ */
+typedef struct {
+    uint32_t t_s;            // UTC 秒：原始层为样本时刻，汇总层为桶起始
+    int32_t  mean;           // 定点均值，缩放同 sensor_sample_t.value
+    int16_t  min;            // 桶内最小值，通道整数单位（定点值 / 通道缩放），饱和到 int16
+    int16_t  max;            // 桶内最大值，同上
+    uint16_t count;          // 桶内样本数
+    uint8_t  sensor_id : 4;  // sensor_id_t
+    uint8_t  channel   : 4;  // sensor_channel_t
+    uint8_t  flags;          // 桶内样本标志的按位或
+} history_record_t;
+
+_Static_assert(sizeof(history_record_t) == 16, "history_record_t must stay 16 bytes");
+
+#define HISTORY_SECTOR_SIZE         4096
+#define HISTORY_RECORDS_PER_SECTOR  (HISTORY_SECTOR_SIZE / sizeof(history_record_t) - 1)
+#define HISTORY_ERASED_TIME         0xFFFFFFFF   // 擦除后未写入的记录槽
+#define HISTORY_RING_ITER_BATCH     16           // 迭代器每次从 flash 读取的记录数
+
+typedef struct {
+    const esp_partition_t *part;
+    uint32_t *first_t;       // 每扇区首条记录时间（稀疏索引），长度 sectors，由调用者提供
+    uint16_t first_sector;   // 在分区内的起始扇区
+    uint16_t sectors;
+    uint8_t  tier;           // 写入扇区头，区分不同的环
+    uint16_t head;           // 当前写入扇区（环内下标）
+    uint16_t head_slot;      // 当前扇区下一个空记录槽
+    uint32_t head_seq;
+    uint32_t erased;         // 本次开机以来擦除的扇区数
+} history_ring_t;
+
+/**
+ * @brief 区间遍历器：只缓存一小批记录，不复制整个扇区
+ *
+ * 两次 next 之间不需要持有锁（每次 next 期间需要）；每次从 flash 取新一批前按序号检查当前扇区，
+ * 若该扇区已被写入端擦除复用，则跳到下一个仍然有效的扇区。
+ */
+typedef struct {
+    uint32_t from_s;
+    uint32_t to_s;
+    uint32_t slack_s;        // 记录时间允许的乱序幅度
+    uint32_t seq;            // 当前扇区序号
+    uint16_t idx;            // 当前扇区（环内下标）
+    uint16_t slot;           // 批次之后的下一个槽位
+    uint8_t  pos;            // 当前批次中的下标
+    uint8_t  count;          // 当前批次的记录数
+    bool     done;
+    uint32_t flash_reads;    // 读取 flash 的次数，用于基准测试
+    uint32_t lost;           // 遍历期间被擦除而跳过的扇区数
+    history_record_t batch[HISTORY_RING_ITER_BATCH];
+} history_ring_iter_t;
+
+/**
+ * @brief 开机时找到序号最大的扇区作为写入位置，并重建时间索引；环为空时格式化首个扇区
+ */
+esp_err_t history_ring_recover(history_ring_t *r);
+
+esp_err_t history_ring_append(history_ring_t *r, const history_record_t *rec);
+
+/**
+ * @brief 序号为 seq 的扇区在分区内已写入的字节范围，含扇区头
+ * @return 扇区尚未启用、已被擦除复用或未格式化时返回 false
+ */
+bool history_ring_sector_span(const history_ring_t *r, uint32_t seq, uint32_t *offset, uint32_t *len);
+
+/**
+ * @brief 序号为 seq 的扇区是否仍在环内、未被擦除复用
+ */
+bool history_ring_seq_live(const history_ring_t *r, uint32_t seq);
+
+/**
+ * @brief 定位区间 [from_s, to_s) 的第一条候选记录
+ * @param slack_s 记录时间相对写入顺序的最大乱序幅度，起点按 from_s - slack_s 查找
+ */
+void history_ring_iter_begin(const history_ring_t *r, history_ring_iter_t *it, uint32_t from_s, uint32_t to_s,
+                             uint32_t slack_s);
+
+/**
+ * @brief 取下一条时间落在区间内的记录
+ *
+ * 内部可能多次从 flash 取新一批并读取写入位置，整个调用期间调用者须与写入端互斥。
+ * @return NULL 表示遍历结束；返回的指针在下一次调用前有效
+ */
+const history_record_t *history_ring_iter_next(const history_ring_t *r, history_ring_iter_t *it);
+
+#endif // __HISTORY_RING_H__
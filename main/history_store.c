@@ -0,0 +1,402 @@
+#include "sdkconfig.h"
+
+#if CONFIG_HISTORY_STORE
+
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "history_store.h"
+#include "sensor_channel.h"
+#include "time_sync.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+
+#define HISTORY_PARTITION_LABEL     "storage"
+#define HISTORY_QUEUE_LEN           32
+#define HISTORY_TASK_STACK_SIZE     3072
+#define HISTORY_FLUSH_POLL_MS       1000
+// 样本经队列延迟到达，原始层记录时间允许的乱序幅度
+#define HISTORY_RAW_SLACK_S         10
+
+static const char *TAG = "history_store";
+
+// 汇总层当前桶的累加器
+typedef struct {
+    int64_t  sum;
+    int32_t  min;
+    int32_t  max;
+    uint32_t bucket_s;       // 桶起始 UTC 秒
+    uint16_t count;
+    uint8_t  flags;
+} history_acc_t;
+
+static const uint16_t g_tier_sectors[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = CONFIG_HISTORY_RAW_SECTORS,
+    [HISTORY_TIER_MINUTE] = CONFIG_HISTORY_MINUTE_SECTORS,
+    [HISTORY_TIER_HOUR]   = CONFIG_HISTORY_HOUR_SECTORS,
+};
+
+static const uint32_t g_tier_bucket_s[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = 0,
+    [HISTORY_TIER_MINUTE] = 60,
+    [HISTORY_TIER_HOUR]   = 3600,
+};
+
+static const char *const g_tier_names[HISTORY_TIER_MAX] = {
+    [HISTORY_TIER_RAW]    = "raw",
+    [HISTORY_TIER_MINUTE] = "1min",
+    [HISTORY_TIER_HOUR]   = "1h",
+};
+
+static const esp_partition_t *g_part = NULL;
+static history_ring_t g_rings[HISTORY_TIER_MAX];
+// 各层扇区首条记录时间，每扇区 4 字节
+static uint32_t g_index[CONFIG_HISTORY_RAW_SECTORS + CONFIG_HISTORY_MINUTE_SECTORS + CONFIG_HISTORY_HOUR_SECTORS];
+// 按通道槽位（见 sensor_channel.h）分配，原始层不使用
+static history_acc_t g_acc[SENSOR_CH_SLOTS][HISTORY_TIER_MAX];
+// 写入任务与查询者之间的互斥：保护环状态与 flash 内容
+static SemaphoreHandle_t g_store_lock = NULL;
+static QueueHandle_t g_queue = NULL;
+
+static history_store_stats_t g_stats;
+static portMUX_TYPE g_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticSemaphore_t g_store_lock_buf;
+static StaticQueue_t g_queue_struct;
+static uint8_t g_queue_storage[HISTORY_QUEUE_LEN * sizeof(sensor_sample_t)];
+static StackType_t g_task_stack[HISTORY_TASK_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+static void ring_append(history_tier_t tier, const history_record_t *rec)
+{
+    if (history_ring_append(&g_rings[tier], rec) != ESP_OK) {
+        ESP_LOGE(TAG, "Write failed in %s tier", g_tier_names[tier]);
+        return;
+    }
+    portENTER_CRITICAL(&g_stats_lock);
+    g_stats.written[tier]++;
+    portEXIT_CRITICAL(&g_stats_lock);
+}
+
+// min/max 只保留通道的整数单位（HCHO 为整数 ppb），饱和到 int16
+static inline int16_t minmax_coarse(sensor_channel_t channel, int32_t value)
+{
+    value /= sensor_channel_info(channel)->scale;
+    return (int16_t)MAX(MIN(value, INT16_MAX), INT16_MIN);
+}
+
+static void acc_reset(history_acc_t *a)
+{
+    a->sum = 0;
+    a->min = INT32_MAX;
+    a->max = INT32_MIN;
+    a->count = 0;
+    a->flags = 0;
+}
+
+static void acc_flush(int slot, history_tier_t tier)
+{
+    history_acc_t *a = &g_acc[slot][tier];
+    sensor_id_t id;
+    sensor_channel_t channel;
+    if (a->count == 0 || !sensor_channel_slot_source(slot, &id, &channel)) {
+        return;
+    }
+    int64_t half = (a->sum >= 0) ? a->count / 2 : -(int64_t)(a->count / 2);
+    const history_record_t rec = {
+        .t_s = a->bucket_s,
+        .mean = (int32_t)((a->sum + half) / a->count),
+        .min = minmax_coarse(channel, a->min),
+        .max = minmax_coarse(channel, a->max),
+        .count = a->count,
+        .sensor_id = id,
+        .channel = channel,
+        .flags = a->flags,
+    };
+    ring_append(tier, &rec);
+    acc_reset(a);
+}
+
+static void acc_add(int slot, history_tier_t tier, uint32_t t_s, const sensor_sample_t *sample)
+{
+    history_acc_t *a = &g_acc[slot][tier];
+    uint32_t bucket_s = t_s - t_s % g_tier_bucket_s[tier];
+    if (a->count && (a->bucket_s != bucket_s || a->count == UINT16_MAX)) {
+        acc_flush(slot, tier);
+    }
+    if (a->count == 0) {
+        a->bucket_s = bucket_s;
+    }
+    a->sum += sample->value;
+    a->min = MIN(a->min, sample->value);
+    a->max = MAX(a->max, sample->value);
+    a->flags |= sample->flags;
+    a->count++;
+}
+
+static void write_sample(uint32_t t_s, const sensor_sample_t *sample)
+{
+    int slot = sensor_channel_find_slot(sample->sensor_id, sample->channel);
+    if (slot < 0) {
+        return;
+    }
+    const history_record_t raw = {
+        .t_s = t_s,
+        .mean = sample->value,
+        .min = minmax_coarse(sample->channel, sample->value),
+        .max = minmax_coarse(sample->channel, sample->value),
+        .count = 1,
+        .sensor_id = sample->sensor_id,
+        .channel = sample->channel,
+        .flags = sample->flags,
+    };
+    ring_append(HISTORY_TIER_RAW, &raw);
+    for (int tier = HISTORY_TIER_RAW + 1; tier < HISTORY_TIER_MAX; tier++) {
+        acc_add(slot, tier, t_s, sample);
+    }
+}
+
+// 已结束但迟迟没有新样本的桶按时写出，汇总层的记录因此基本按时间有序
+static void flush_due(uint32_t now_s)
+{
+    for (int slot = 0; slot < SENSOR_CH_SLOTS; slot++) {
+        for (int tier = HISTORY_TIER_RAW + 1; tier < HISTORY_TIER_MAX; tier++) {
+            const history_acc_t *a = &g_acc[slot][tier];
+            if (a->count && now_s >= a->bucket_s + g_tier_bucket_s[tier]) {
+                acc_flush(slot, tier);
+            }
+        }
+    }
+}
+
+static void history_store_task(void *pvParameters)
+{
+    sensor_sample_t sample;
+    while (1) {
+        bool got = xQueueReceive(g_queue, &sample, pdMS_TO_TICKS(HISTORY_FLUSH_POLL_MS)) == pdTRUE;
+        time_sync_ref_t ref;
+        if (!time_sync_get_ref(&ref)) {
+            if (got) {
+                portENTER_CRITICAL(&g_stats_lock);
+                g_stats.dropped_no_time++;
+                portEXIT_CRITICAL(&g_stats_lock);
+            }
+            continue;
+        }
+
+        xSemaphoreTake(g_store_lock, portMAX_DELAY);
+        if (got) {
+            write_sample((uint32_t)(time_sync_to_utc_ms(&ref, sample.timestamp_ms) / 1000), &sample);
+        }
+        flush_due((uint32_t)(time_sync_to_utc_ms(&ref, (uint32_t)(esp_timer_get_time() / 1000)) / 1000));
+        xSemaphoreGive(g_store_lock);
+    }
+}
+
+void history_store_append(const sensor_sample_t *sample)
+{
+    if (!g_queue || sample->sensor_id >= SENSOR_ID_MAX) {
+        return;
+    }
+    if (xQueueSend(g_queue, sample, 0) != pdTRUE) {
+        portENTER_CRITICAL(&g_stats_lock);
+        g_stats.dropped_queue_full++;
+        portEXIT_CRITICAL(&g_stats_lock);
+    }
+}
+
+uint32_t history_store_tier_bucket_s(history_tier_t tier)
+{
+    return (tier < HISTORY_TIER_MAX) ? g_tier_bucket_s[tier] : 0;
+}
+
+// 桶宽不超过 resolution_s 的层中最粗的一层
+static history_tier_t tier_for_resolution(uint32_t resolution_s)
+{
+    for (int t = HISTORY_TIER_MAX - 1; t > HISTORY_TIER_RAW; t--) {
+        if (g_tier_bucket_s[t] <= resolution_s) {
+            return t;
+        }
+    }
+    return HISTORY_TIER_RAW;
+}
+
+// 汇总记录在桶结束后才写出，迟到的样本还会让同一桶再出现一次，乱序幅度按一个桶宽计
+static inline uint32_t tier_slack_s(history_tier_t tier)
+{
+    return g_tier_bucket_s[tier] + HISTORY_RAW_SLACK_S;
+}
+
+history_tier_t history_store_iter_begin(history_store_iter_t *it, sensor_id_t id, sensor_channel_t channel,
+                                        uint32_t from_s, uint32_t to_s, uint32_t resolution_s)
+{
+    it->tier = tier_for_resolution(resolution_s);
+    it->id = id;
+    it->channel = channel;
+    if (!g_part) {
+        it->ring = (history_ring_iter_t){.done = true};
+        return it->tier;
+    }
+    xSemaphoreTake(g_store_lock, portMAX_DELAY);
+    history_ring_iter_begin(&g_rings[it->tier], &it->ring, from_s, to_s, tier_slack_s(it->tier));
+    xSemaphoreGive(g_store_lock);
+    return it->tier;
+}
+
+const history_record_t *history_store_iter_next(history_store_iter_t *it)
+{
+    const history_record_t *rec;
+    do {
+        // 跳过擦除或区间外的记录后可能在内部取新一批（读 flash 与写入位置），整个调用都要持锁
+        xSemaphoreTake(g_store_lock, portMAX_DELAY);
+        rec = history_ring_iter_next(&g_rings[it->tier], &it->ring);
+        xSemaphoreGive(g_store_lock);
+    } while (rec && (rec->sensor_id != it->id || rec->channel != it->channel));
+    return rec;
+}
+
+history_tier_t history_store_query(sensor_id_t id, sensor_channel_t channel, uint32_t from_s, uint32_t to_s,
+                                   uint32_t resolution_s, history_store_cb_t cb, void *ctx)
+{
+    history_store_iter_t it;
+    history_tier_t tier = history_store_iter_begin(&it, id, channel, from_s, to_s, resolution_s);
+    const history_record_t *rec;
+    while ((rec = history_store_iter_next(&it)) != NULL) {
+        if (!cb(rec, ctx)) {
+            break;
+        }
+    }
+    return tier;
+}
+
+esp_err_t history_store_export(history_store_chunk_cb_t cb, history_store_recycled_cb_t recycled, void *ctx)
+{
+    if (!g_part) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint8_t *base;
+    esp_partition_mmap_handle_t map;
+    esp_err_t err = esp_partition_mmap(g_part, 0, g_part->size, ESP_PARTITION_MMAP_DATA, (const void **)&base, &map);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mmap failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    for (int tier = 0; tier < HISTORY_TIER_MAX && err == ESP_OK; tier++) {
+        const history_ring_t *r = &g_rings[tier];
+        xSemaphoreTake(g_store_lock, portMAX_DELAY);
+        uint32_t seq = r->head_seq - r->sectors + 1;
+        xSemaphoreGive(g_store_lock);
+        for (;; seq++) {
+            uint32_t offset, len;
+            xSemaphoreTake(g_store_lock, portMAX_DELAY);
+            bool end = (int32_t)(seq - r->head_seq) > 0;
+            // 发送上一个扇区期间已被复用的序号查不到范围，直接跳过；只有扇区头的空扇区也不导出
+            bool span = !end && history_ring_sector_span(r, seq, &offset, &len) && len > sizeof(history_record_t);
+            xSemaphoreGive(g_store_lock);
+            if (end) {
+                break;
+            }
+            if (!span) {
+                continue;
+            }
+            // 不持锁直接从映射地址发送：写入端只在范围之后追加，范围内的内容只会因整个扇区被擦除复用而改变
+            if (!cb(base + offset, len, ctx)) {
+                err = ESP_FAIL;
+                break;
+            }
+            xSemaphoreTake(g_store_lock, portMAX_DELAY);
+            bool live = history_ring_seq_live(r, seq);
+            xSemaphoreGive(g_store_lock);
+            if (!live) {
+                ESP_LOGW(TAG, "Tier %d sector %lu recycled during export", tier, (unsigned long)seq);
+                if (!recycled((uint8_t)tier, seq, ctx)) {
+                    err = ESP_FAIL;
+                    break;
+                }
+            }
+        }
+    }
+    esp_partition_munmap(map);
+    return err;
+}
+
+void history_store_get_stats(history_store_stats_t *out)
+{
+    portENTER_CRITICAL(&g_stats_lock);
+    *out = g_stats;
+    portEXIT_CRITICAL(&g_stats_lock);
+    for (int tier = 0; tier < HISTORY_TIER_MAX; tier++) {
+        out->erased[tier] = g_rings[tier].erased;
+    }
+}
+
+void history_store_init(void)
+{
+    g_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, HISTORY_PARTITION_LABEL);
+    if (!g_part) {
+        ESP_LOGE(TAG, "Partition '%s' not found, history disabled", HISTORY_PARTITION_LABEL);
+        return;
+    }
+    uint32_t total_sectors = 0;
+    for (int tier = 0; tier < HISTORY_TIER_MAX; tier++) {
+        total_sectors += g_tier_sectors[tier];
+    }
+    if (total_sectors * HISTORY_SECTOR_SIZE > g_part->size) {
+        ESP_LOGE(TAG, "%lu sectors configured but '%s' holds %lu, history disabled", (unsigned long)total_sectors,
+                 HISTORY_PARTITION_LABEL, (unsigned long)(g_part->size / HISTORY_SECTOR_SIZE));
+        g_part = NULL;
+        return;
+    }
+
+#if CONFIG_STATIC_ALLOCATION
+    g_store_lock = xSemaphoreCreateMutexStatic(&g_store_lock_buf);
+    g_queue = xQueueCreateStatic(HISTORY_QUEUE_LEN, sizeof(sensor_sample_t), g_queue_storage, &g_queue_struct);
+#else
+    g_store_lock = xSemaphoreCreateMutex();
+    g_queue = xQueueCreate(HISTORY_QUEUE_LEN, sizeof(sensor_sample_t));
+#endif
+
+    uint16_t first_sector = 0;
+    for (int tier = 0; tier < HISTORY_TIER_MAX; tier++) {
+        history_ring_t *r = &g_rings[tier];
+        r->part = g_part;
+        r->first_t = &g_index[first_sector];
+        r->first_sector = first_sector;
+        r->sectors = g_tier_sectors[tier];
+        r->tier = tier;
+        first_sector += g_tier_sectors[tier];
+        if (history_ring_recover(r) != ESP_OK) {
+            ESP_LOGE(TAG, "Recovering %s tier failed", g_tier_names[tier]);
+        }
+        ESP_LOGI(TAG, "%s tier: %u sectors, %lu records, head %u/%u", g_tier_names[tier], g_rings[tier].sectors,
+                 (unsigned long)(g_rings[tier].sectors * HISTORY_RECORDS_PER_SECTOR), g_rings[tier].head,
+                 g_rings[tier].head_slot);
+    }
+    for (int slot = 0; slot < SENSOR_CH_SLOTS; slot++) {
+        for (int tier = 0; tier < HISTORY_TIER_MAX; tier++) {
+            acc_reset(&g_acc[slot][tier]);
+        }
+    }
+
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(history_store_task, "history_store_task", HISTORY_TASK_STACK_SIZE, NULL,
+                                         TASK_PRIO_AUX, g_task_stack, &g_task_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(history_store_task, "history_store_task", HISTORY_TASK_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                            &task, TASK_CORE_AUX);
+#endif
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, HISTORY_TASK_STACK_SIZE);
+}
+
+#endif // CONFIG_HISTORY_STORE
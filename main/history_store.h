@@ -0,0 +1,124 @@
+#ifndef __HISTORY_STORE_H__
+#define __HISTORY_STORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "sensor.h"
+#include "history_ring.h"
+
+/**
+ * 分层降采样的长期历史（storage 分区）
+ *
+ * 分区按扇区划分为三层环形区域：原始样本、1 分钟汇总、1 小时汇总。
+ * 样本到达时同时写入原始层并累加到各汇总层的当前桶，桶结束时写出一条
+ * count/mean/min/max 记录，因此汇总是增量计算的，不需要回读原始数据。
+ * 每层写满后擦除最旧的扇区继续写，旧数据自动淘汰，各层保留时长由扇区数决定。
+ *
+ * 记录时间为 UTC 秒，样本在 SNTP 首次同步前不落盘。
+ * 扇区布局与时间索引见 history_ring.h，区间查询从索引定位起点，耗时与保留时长基本无关。
+ */
+
+typedef enum {
+    HISTORY_TIER_RAW = 0,
+    HISTORY_TIER_MINUTE,
+    HISTORY_TIER_HOUR,
+    HISTORY_TIER_MAX
+} history_tier_t;
+
+/**
+ * @brief 返回 false 停止遍历
+ */
+typedef bool (*history_store_cb_t)(const history_record_t *rec, void *ctx);
+
+typedef struct {
+    uint32_t written[HISTORY_TIER_MAX];   // 各层写入的记录数
+    uint32_t erased[HISTORY_TIER_MAX];    // 各层擦除（淘汰）的扇区数
+    uint32_t dropped_no_time;             // 尚未对时而丢弃的样本
+    uint32_t dropped_queue_full;
+} history_store_stats_t;
+
+/**
+ * @brief 导出时每个扇区回调一次，data 指向映射的 flash，返回 false 中止导出
+ */
+typedef bool (*history_store_chunk_cb_t)(const void *data, size_t len, void *ctx);
+
+/**
+ * @brief 刚发出的扇区在发送期间被写入端擦除复用，已发出的内容可能新旧混杂，返回 false 中止导出
+ */
+typedef bool (*history_store_recycled_cb_t)(uint8_t tier, uint32_t seq, void *ctx);
+
+/**
+ * @brief 区间遍历器，放在调用者栈上（约 300 字节）
+ */
+typedef struct {
+    history_ring_iter_t ring;
+    history_tier_t tier;
+    sensor_id_t id;
+    sensor_channel_t channel;
+} history_store_iter_t;
+
+#if CONFIG_HISTORY_STORE
+
+/**
+ * @brief 挂载 storage 分区、恢复各层写入位置并启动写入任务
+ */
+void history_store_init(void);
+
+/**
+ * @brief 追加一个（滤波后的）样本，不阻塞，由发布流水线调用
+ */
+void history_store_append(const sensor_sample_t *sample);
+
+/**
+ * @brief 开始遍历 [from_s, to_s) 内某传感器某一通道的记录
+ *
+ * 在桶宽不超过 resolution_s 的层中选最粗的一层，例如按小时分辨率取一个月的数据
+ * 只读小时层，不会扫描原始记录。起点由时间索引二分定位，之后按写入顺序逐条返回。
+ * @return 实际使用的层
+ */
+history_tier_t history_store_iter_begin(history_store_iter_t *it, sensor_id_t id, sensor_channel_t channel,
+                                        uint32_t from_s, uint32_t to_s, uint32_t resolution_s);
+
+/**
+ * @brief 取下一条记录，NULL 表示结束；返回的指针在下一次调用前有效
+ *
+ * 每次调用期间持有存储锁（可能从 flash 取新一批记录），两次调用之间写入任务照常工作；
+ * 遍历期间被擦除淘汰的扇区会被跳过。
+ */
+const history_record_t *history_store_iter_next(history_store_iter_t *it);
+
+/**
+ * @brief 以回调形式遍历，等价于 iter_begin + iter_next
+ *
+ * 回调期间不持有存储锁。
+ * @return 实际使用的层
+ */
+history_tier_t history_store_query(sensor_id_t id, sensor_channel_t channel, uint32_t from_s, uint32_t to_s,
+                                   uint32_t resolution_s, history_store_cb_t cb, void *ctx);
+
+/**
+ * @brief 按层、按写入顺序把各扇区已写入的部分（扇区头 + 记录）交给回调
+ *
+ * 用 esp_partition_mmap 映射整个分区，持存储锁只取扇区的序号与已写入范围，
+ * 释放锁后把映射地址直接交给 cb，不经过 RAM 副本，发送期间写入任务照常工作。
+ * 发送完成后按序号检查该扇区，若已被擦除复用则调用 recycled。
+ */
+esp_err_t history_store_export(history_store_chunk_cb_t cb, history_store_recycled_cb_t recycled, void *ctx);
+
+/**
+ * @brief 层的桶宽（秒），原始层为 0
+ */
+uint32_t history_store_tier_bucket_s(history_tier_t tier);
+
+void history_store_get_stats(history_store_stats_t *out);
+
+#else
+
+static inline void history_store_init(void) {}
+static inline void history_store_append(const sensor_sample_t *sample) {}
+
+#endif // CONFIG_HISTORY_STORE
+
+#endif // __HISTORY_STORE_H__
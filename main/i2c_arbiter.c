@@ -0,0 +1,141 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "i2c_arbiter.h"
+
+// 等待传感器交还总线的上限，防止传感器任务异常时显示端永久阻塞
+#define I2C_ARBITER_HANDOFF_TIMEOUT_MS  100
+
+static const char *TAG = "i2c_arbiter";
+
+static SemaphoreHandle_t g_bus_mutex = NULL;
+// 最后一个等待中的传感器事务结束时释放，唤醒让出总线的显示端
+static SemaphoreHandle_t g_handoff = NULL;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticSemaphore_t g_bus_mutex_buf;
+static StaticSemaphore_t g_handoff_buf;
+#endif
+
+static portMUX_TYPE g_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t g_sensors_pending;      // 已调用 begin 但尚未 end 的传感器事务
+static bool g_display_parked;          // 显示端已让出总线，等待 g_handoff
+static int64_t g_display_hold_since_us;
+static uint64_t g_wait_sum_us;
+static i2c_arbiter_stats_t g_stats;
+
+void i2c_arbiter_init(void)
+{
+    if (g_bus_mutex) {
+        return;
+    }
+#if CONFIG_STATIC_ALLOCATION
+    g_bus_mutex = xSemaphoreCreateMutexStatic(&g_bus_mutex_buf);
+    g_handoff = xSemaphoreCreateBinaryStatic(&g_handoff_buf);
+#else
+    g_bus_mutex = xSemaphoreCreateMutex();
+    g_handoff = xSemaphoreCreateBinary();
+#endif
+    assert(g_bus_mutex && g_handoff);
+}
+
+static void display_hold_end(void)
+{
+    uint32_t held_us = (uint32_t)(esp_timer_get_time() - g_display_hold_since_us);
+    portENTER_CRITICAL(&g_lock);
+    if (held_us > g_stats.display_hold_max_us) {
+        g_stats.display_hold_max_us = held_us;
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void i2c_arbiter_display_begin(void)
+{
+    xSemaphoreTake(g_bus_mutex, portMAX_DELAY);
+    g_display_hold_since_us = esp_timer_get_time();
+}
+
+void i2c_arbiter_display_yield(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    bool yield = g_sensors_pending > 0;
+    if (yield) {
+        g_display_parked = true;
+        g_stats.handoffs++;
+    }
+    portEXIT_CRITICAL(&g_lock);
+    if (!yield) {
+        return;
+    }
+
+    display_hold_end();
+    xSemaphoreGive(g_bus_mutex);
+    if (xSemaphoreTake(g_handoff, pdMS_TO_TICKS(I2C_ARBITER_HANDOFF_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Sensor transactions still pending after %d ms", I2C_ARBITER_HANDOFF_TIMEOUT_MS);
+        // 超时与最后一个传感器事务结束可能同时发生：若对方已清除 parked，它必然会释放
+        // g_handoff，这里把它取走，否则残留的信号会让下一次让出不等传感器完成就返回
+        portENTER_CRITICAL(&g_lock);
+        bool give_pending = !g_display_parked;
+        g_display_parked = false;
+        portEXIT_CRITICAL(&g_lock);
+        if (give_pending) {
+            xSemaphoreTake(g_handoff, portMAX_DELAY);
+        }
+    }
+    xSemaphoreTake(g_bus_mutex, portMAX_DELAY);
+    g_display_hold_since_us = esp_timer_get_time();
+}
+
+void i2c_arbiter_display_end(void)
+{
+    display_hold_end();
+    xSemaphoreGive(g_bus_mutex);
+}
+
+void i2c_arbiter_sensor_begin(void)
+{
+    portENTER_CRITICAL(&g_lock);
+    g_sensors_pending++;
+    portEXIT_CRITICAL(&g_lock);
+
+    int64_t start_us = esp_timer_get_time();
+    xSemaphoreTake(g_bus_mutex, portMAX_DELAY);
+    uint32_t wait_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    portENTER_CRITICAL(&g_lock);
+    g_stats.sensor_txns++;
+    g_wait_sum_us += wait_us;
+    if (wait_us > g_stats.sensor_wait_max_us) {
+        g_stats.sensor_wait_max_us = wait_us;
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
+
+void i2c_arbiter_sensor_end(void)
+{
+    xSemaphoreGive(g_bus_mutex);
+
+    portENTER_CRITICAL(&g_lock);
+    g_sensors_pending--;
+    bool wake_display = g_sensors_pending == 0 && g_display_parked;
+    if (wake_display) {
+        g_display_parked = false;
+    }
+    portEXIT_CRITICAL(&g_lock);
+    if (wake_display) {
+        xSemaphoreGive(g_handoff);
+    }
+}
+
+void i2c_arbiter_get_stats(i2c_arbiter_stats_t *out, bool reset)
+{
+    portENTER_CRITICAL(&g_lock);
+    *out = g_stats;
+    out->sensor_wait_avg_us = g_stats.sensor_txns ? (uint32_t)(g_wait_sum_us / g_stats.sensor_txns) : 0;
+    if (reset) {
+        g_stats = (i2c_arbiter_stats_t){0};
+        g_wait_sum_us = 0;
+    }
+    portEXIT_CRITICAL(&g_lock);
+}
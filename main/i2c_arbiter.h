@@ -0,0 +1,47 @@
+#ifndef __I2C_ARBITER_H__
+#define __I2C_ARBITER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * 显示总线仲裁
+ *
+ * OLED 与辅助传感器（SHT4x 等）共用一条 I2C 总线。显示端按页（8行）分块发送帧缓冲，
+ * 每个分块之间调用 i2c_arbiter_display_yield()：有传感器在等待时把总线交出去，
+ * 等所有等待的传感器事务完成后再继续。传感器事务因此最多等待一个分块的传输时间，
+ * 而不是整帧刷新的时间。
+ *
+ * 仲裁只在本层之上生效：所有访问该总线的代码都必须在 begin/end 之间进行。
+ */
+
+typedef struct {
+    uint32_t sensor_txns;           // 传感器事务数
+    uint32_t sensor_wait_max_us;    // 传感器等待总线的最长时间
+    uint32_t sensor_wait_avg_us;
+    uint32_t display_hold_max_us;   // 显示端一次连续占用总线的最长时间
+    uint32_t handoffs;              // 显示端在分块之间让出总线的次数
+} i2c_arbiter_stats_t;
+
+void i2c_arbiter_init(void);
+
+void i2c_arbiter_display_begin(void);
+
+/**
+ * @brief 分块之间调用；有传感器等待时让出总线，直到它们完成
+ */
+void i2c_arbiter_display_yield(void);
+
+void i2c_arbiter_display_end(void);
+
+void i2c_arbiter_sensor_begin(void);
+
+void i2c_arbiter_sensor_end(void);
+
+/**
+ * @brief 读取等待时间统计
+ * @param reset 读取后清零，用于按窗口统计
+ */
+void i2c_arbiter_get_stats(i2c_arbiter_stats_t *out, bool reset);
+
+#endif // __I2C_ARBITER_H__
@@ -0,0 +1,127 @@
+#include <math.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "jitter_bench.h"
+#include "task_config.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "protocols/mqtt_device.h"
+
+#if CONFIG_JITTER_BENCH
+
+static const char *TAG = "jitter";
+
+#define JITTER_LOAD_STACK_SIZE   3072
+#define JITTER_LOAD_PAYLOAD      256
+#define JITTER_LOAD_PERIOD_MS    20      // 每 20 ms 发布一条，约 12.8 KB/s
+#define JITTER_SCAN_PERIOD_MS    15000
+
+typedef struct {
+    int64_t  last_us;
+    uint32_t count;
+    int64_t  sum;       // 周期误差之和（us）
+    int64_t  sum_sq;    // 周期误差平方和（us^2）
+    int32_t  min;
+    int32_t  max;
+} jitter_stats_t;
+
+static jitter_stats_t g_stats[SENSOR_ID_MAX];
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_load_stack[JITTER_LOAD_STACK_SIZE];
+static StaticTask_t g_load_tcb;
+#endif
+
+static void jitter_stats_reset(jitter_stats_t *st)
+{
+    st->count = 0;
+    st->sum = 0;
+    st->sum_sq = 0;
+    st->min = INT32_MAX;
+    st->max = INT32_MIN;
+}
+
+void jitter_bench_mark(sensor_id_t id, uint32_t expected_ms)
+{
+    if (id >= SENSOR_ID_MAX) {
+        return;
+    }
+    jitter_stats_t *st = &g_stats[id];
+    int64_t now = esp_timer_get_time();
+    if (st->last_us == 0) {
+        st->last_us = now;
+        jitter_stats_reset(st);
+        return;
+    }
+
+    int32_t err = (int32_t)(now - st->last_us - (int64_t)expected_ms * 1000);
+    st->last_us = now;
+    st->count++;
+    st->sum += err;
+    st->sum_sq += (int64_t)err * err;
+    if (err < st->min) {
+        st->min = err;
+    }
+    if (err > st->max) {
+        st->max = err;
+    }
+
+    if (st->count >= CONFIG_JITTER_BENCH_WINDOW) {
+        int64_t mean = st->sum / st->count;
+        int64_t var = st->sum_sq / st->count - mean * mean;
+        ESP_LOGI(TAG, "%s: n=%lu period error mean %lld us, sd %ld us, min %ld us, max %ld us",
+                 sensor_id_name(id), (unsigned long)st->count, (long long)mean,
+                 (long)sqrtf((float)(var > 0 ? var : 0)), (long)st->min, (long)st->max);
+        jitter_stats_reset(st);
+    }
+}
+
+// 网络负载：持续发布 MQTT 消息，并周期性触发阻塞式 Wi-Fi 扫描
+static void jitter_load_task(void *arg)
+{
+    static uint8_t payload[JITTER_LOAD_PAYLOAD];
+    memset(payload, 0xA5, sizeof(payload));
+    TickType_t last_scan = xTaskGetTickCount();
+    uint32_t sent = 0, dropped = 0;
+
+    ESP_LOGI(TAG, "Network load started: %d B every %d ms, Wi-Fi scan every %d ms",
+             JITTER_LOAD_PAYLOAD, JITTER_LOAD_PERIOD_MS, JITTER_SCAN_PERIOD_MS);
+    while (1) {
+        if (mqtt_device_publish_raw(CONFIG_MQTT_TELEMETRY_TOPIC "/bench", payload, sizeof(payload))) {
+            sent++;
+        } else {
+            dropped++;
+        }
+        if (xTaskGetTickCount() - last_scan >= pdMS_TO_TICKS(JITTER_SCAN_PERIOD_MS)) {
+            // 未连上 broker 时发布直接失败，此期间的抖动报告只含扫描负载
+            ESP_LOGI(TAG, "Network load: %lu published, %lu not sent (MQTT not connected)", (unsigned long)sent,
+                     (unsigned long)dropped);
+            sent = 0;
+            dropped = 0;
+            esp_wifi_scan_start(NULL, true);
+            esp_wifi_clear_ap_list();
+            last_scan = xTaskGetTickCount();
+        }
+        vTaskDelay(pdMS_TO_TICKS(JITTER_LOAD_PERIOD_MS));
+    }
+}
+
+void jitter_bench_start_load(void)
+{
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(jitter_load_task, "jitter_load", JITTER_LOAD_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                                         g_load_stack, &g_load_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(jitter_load_task, "jitter_load", JITTER_LOAD_STACK_SIZE, NULL, TASK_PRIO_AUX, &task,
+                            TASK_CORE_AUX);
+#endif
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, JITTER_LOAD_STACK_SIZE);
+}
+
+#endif // CONFIG_JITTER_BENCH
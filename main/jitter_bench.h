@@ -0,0 +1,35 @@
+#ifndef __JITTER_BENCH_H__
+#define __JITTER_BENCH_H__
+
+#include <stdint.h>
+#include "sensor.h"
+
+/**
+ * 采样抖动测试
+ *
+ * 生产任务每个周期开始时打点，统计实际周期与计划周期之差的均值、标准差和极值，
+ * 每 CONFIG_JITTER_BENCH_WINDOW 个周期输出一次。可选的负载任务持续发布 MQTT 消息
+ * 并周期性执行 Wi-Fi 扫描，用来验证网络负载下传感器路径的时序是否稳定。
+ */
+
+#if CONFIG_JITTER_BENCH
+
+/**
+ * @brief 记录一个采样周期的开始
+ * @param expected_ms 上一周期计划的间隔
+ */
+void jitter_bench_mark(sensor_id_t id, uint32_t expected_ms);
+
+/**
+ * @brief 启动网络负载任务
+ */
+void jitter_bench_start_load(void);
+
+#else
+
+static inline void jitter_bench_mark(sensor_id_t id, uint32_t expected_ms) {}
+static inline void jitter_bench_start_load(void) {}
+
+#endif // CONFIG_JITTER_BENCH
+
+#endif // __JITTER_BENCH_H__
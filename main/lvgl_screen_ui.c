@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/lock.h>
 #include <sys/param.h>
@@ -11,21 +12,70 @@
 #include "lvgl.h"
 #include "esp_log.h"
 #include "lvgl_screen_ui.h"
+#include "sensor.h"
+#include "sensor_history.h"
+#include "history_recent.h"
+#include "display_power.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+#include "i2c_arbiter.h"
+#include "alarm.h"
 
 static const char *TAG = "screen";
 
 
 #define AIR_LVGL_TICK_PERIOD_MS    5
 #define AIR_LVGL_TASK_STACK_SIZE   (4 * 1024)
-#define AIR_LVGL_TASK_PRIORITY     2
+#define AIR_LVGL_TASK_PRIORITY     TASK_PRIO_UI
 #define AIR_LVGL_PALETTE_SIZE      8
 #define AIR_LVGL_TASK_MAX_DELAY_MS 500
 #define AIR_LVGL_TASK_MIN_DELAY_MS 1000 / CONFIG_FREERTOS_HZ
+#define AIR_LVGL_OFF_POLL_MS       1000    // 面板关闭时检查告警的周期
+// 窗口统计行只在 128x64 及以上的面板上显示，更小的面板放不下
+#define AIR_UI_RECENT_STATS        (CONFIG_UI_RECENT_STATS && AIR_LCD_H_RES >= 128 && AIR_LCD_V_RES >= 64)
 
 
 
 static lv_obj_t *dart_hcho_label = NULL;
 static lv_obj_t *winsen_hcho_label = NULL;
+static TaskHandle_t lvgl_task_handle = NULL;
+// 叠加层请求：-1 无变化，0 隐藏，1 显示；由 LVGL 任务在持锁时处理。
+// lv_display_create 在启用监视器时会自动显示叠加层，初值 0 让首轮先隐藏，按需再打开
+static volatile int8_t sysmon_request = 0;
+// 负载统计，只由 LVGL 任务写，读取方持 lvgl_api_lock
+static lvgl_ui_stats_t ui_stats;
+
+#if CONFIG_ALARM
+// 告警横幅放在顶层，不随页面轮换隐藏
+static lv_obj_t *alarm_banner = NULL;
+static uint32_t alarm_banner_mask = 0;
+#endif
+
+#if CONFIG_UI_LAYOUT_STATIC
+// 静态分页布局：每页一个传感器，定时切换，页面之间不做动画
+typedef enum {
+    UI_PAGE_DART = 0,
+    UI_PAGE_WINSEN,
+#if CONFIG_UI_TREND_PAGE
+    UI_PAGE_TREND,
+#endif
+    UI_PAGE_MAX
+} ui_page_t;
+
+static lv_obj_t *ui_pages[UI_PAGE_MAX];
+static uint8_t ui_page_current = 0;
+#endif
+
+#if CONFIG_UI_TREND_PAGE
+// 趋势页：每个本地传感器一条 sparkline，从历史环增量追加（总线节点只走 MQTT）
+static lv_obj_t *trend_charts[SENSOR_ID_LOCAL_COUNT];
+static lv_chart_series_t *trend_series[SENSOR_ID_LOCAL_COUNT];
+static uint32_t trend_total[SENSOR_ID_LOCAL_COUNT];     // 已追加到图表的历史点数
+static int32_t trend_range_ppb[SENSOR_ID_LOCAL_COUNT];  // 当前 Y 轴上限
+// 增量读取缓冲，放在静态区以免占用 LVGL 任务栈
+static int32_t trend_points[SENSOR_HISTORY_POINTS];
+#endif
 
 // To use LV_COLOR_FORMAT_I1, we need an extra buffer to hold the converted data
 static uint8_t oled_buffer[AIR_LCD_H_RES * AIR_LCD_V_RES / 8];
@@ -34,19 +84,29 @@ static uint8_t oled_buffer[AIR_LCD_H_RES * AIR_LCD_V_RES / 8];
 extern esp_lcd_panel_handle_t panel_handle;
 extern esp_lcd_panel_io_handle_t io_handle;
 
-extern float g_dart_hcho_mg, g_dart_hcho_ppb;
-extern float g_winsen_hcho_mg, g_winsen_hcho_ppb;
+static esp_timer_handle_t lvgl_tick_timer = NULL;
+
+// LVGL reserves 2 x 4 bytes in the buffer, as these are assumed to be used as a palette.
+#define AIR_LVGL_DRAW_BUF_SIZE     (AIR_LCD_H_RES * AIR_LCD_V_RES / 8 + AIR_LVGL_PALETTE_SIZE)
+
+#if CONFIG_STATIC_ALLOCATION
+static uint8_t lvgl_draw_buf[AIR_LVGL_DRAW_BUF_SIZE] __attribute__((aligned(4)));
+static StackType_t lvgl_task_stack[AIR_LVGL_TASK_STACK_SIZE];
+static StaticTask_t lvgl_task_tcb;
+#endif
 
 // LVGL library is not thread-safe, this example will call LVGL APIs from different tasks, so use a mutex to protect it
 static _lock_t lvgl_api_lock;
 
 
+#if CONFIG_I2C_DISPLAY_CHUNK_PAGES == 0
 static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t io_panel, esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
 {
     lv_display_t *disp = (lv_display_t *)user_ctx;
     lv_display_flush_ready(disp);
     return false;
 }
+#endif
 
 static void display_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
@@ -83,7 +143,26 @@ static void display_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uin
         }
     }
     // pass the draw buffer to the driver
+    i2c_arbiter_display_begin();
+#if CONFIG_I2C_DISPLAY_CHUNK_PAGES > 0
+    // 按页分块同步发送，块之间让出总线给等待中的传感器事务。
+    // FULL 渲染模式下区域总是整行宽，多页的分块在 oled_buffer 中也是连续的
+    int page_first = y1 >> 3;
+    int page_last = y2 >> 3;
+    for (int page = page_first; page <= page_last; page += CONFIG_I2C_DISPLAY_CHUNK_PAGES) {
+        int page_end = MIN(page + CONFIG_I2C_DISPLAY_CHUNK_PAGES - 1, page_last);
+        if (page != page_first) {
+            i2c_arbiter_display_yield();
+        }
+        esp_lcd_panel_draw_bitmap(panel_handle, x1, page * 8, x2 + 1, (page_end + 1) * 8,
+                                  oled_buffer + hor_res * page + x1);
+    }
+    i2c_arbiter_display_end();
+    lv_display_flush_ready(disp);
+#else
     esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2 + 1, y2 + 1, oled_buffer);
+    i2c_arbiter_display_end();
+#endif
 }
 
 static void display_increase_lvgl_tick(void *arg)
@@ -92,23 +171,180 @@ static void display_increase_lvgl_tick(void *arg)
     lv_tick_inc(AIR_LVGL_TICK_PERIOD_MS);
 }
 
+void lvgl_ui_notify(void)
+{
+    if (lvgl_task_handle) {
+        xTaskNotifyGive(lvgl_task_handle);
+    }
+}
+
+void lvgl_ui_set_sysmon(bool show)
+{
+    sysmon_request = show ? 1 : 0;
+    lvgl_ui_notify();
+}
+
+static void lvgl_apply_sysmon(lv_display_t *disp)
+{
+    int8_t req = sysmon_request;
+    if (req < 0) {
+        return;
+    }
+    sysmon_request = -1;
+#if LV_USE_PERF_MONITOR
+    if (req) {
+        lv_sysmon_show_performance(disp);
+    } else {
+        lv_sysmon_hide_performance(disp);
+    }
+#endif
+#if LV_USE_MEM_MONITOR
+    if (req) {
+        lv_sysmon_show_memory(disp);
+    } else {
+        lv_sysmon_hide_memory(disp);
+    }
+#endif
+#if !LV_USE_PERF_MONITOR && !LV_USE_MEM_MONITOR
+    // 开机时的隐藏请求在未启用 CPU_PROFILER 时是常态，不报警
+    if (req) {
+        ESP_LOGW(TAG, "Sysmon overlay not built in (enable CPU_PROFILER)");
+    }
+#endif
+}
+
+void lvgl_ui_take_stats(lvgl_ui_stats_t *out)
+{
+    _lock_acquire(&lvgl_api_lock);
+    *out = ui_stats;
+    memset(&ui_stats, 0, sizeof(ui_stats));
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    out->mem_used = (uint32_t)(mon.total_size - mon.free_size);
+    out->mem_free = (uint32_t)mon.free_size;
+    out->mem_frag_pct = mon.frag_pct;
+#endif
+    _lock_release(&lvgl_api_lock);
+}
+
+#if CONFIG_ALARM
+static void ui_create_alarm_banner(lv_display_t *disp)
+{
+    alarm_banner = lv_label_create(lv_display_get_layer_top(disp));
+    lv_label_set_long_mode(alarm_banner, LV_LABEL_LONG_CLIP);
+    lv_obj_set_width(alarm_banner, lv_display_get_horizontal_resolution(disp));
+    lv_obj_align(alarm_banner, LV_ALIGN_BOTTOM_MID, 0, 0);
+    // 反色：实心底、白字
+    lv_obj_set_style_bg_color(alarm_banner, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(alarm_banner, LV_OPA_COVER, 0);
+    lv_obj_set_style_text_color(alarm_banner, lv_color_white(), 0);
+    lv_obj_set_style_text_align(alarm_banner, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_add_flag(alarm_banner, LV_OBJ_FLAG_HIDDEN);
+}
+
+// 告警集合变化时更新横幅并立即渲染刷屏，不等下一个刷新周期
+static void lvgl_update_alarm_banner(lv_display_t *disp)
+{
+    uint32_t mask = alarm_active_mask();
+    if (!alarm_banner || mask == alarm_banner_mask) {
+        return;
+    }
+    alarm_banner_mask = mask;
+    if (mask) {
+        char buf[32];
+        int len = snprintf(buf, sizeof(buf), "HCHO ALARM");
+        for (int id = 0; id < SENSOR_ID_MAX && len < (int)sizeof(buf); id++) {
+            if (mask & (1U << id)) {
+                len += snprintf(buf + len, sizeof(buf) - len, " %s", sensor_id_name(id));
+            }
+        }
+        lv_label_set_text(alarm_banner, buf);
+        lv_obj_remove_flag(alarm_banner, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(alarm_banner, LV_OBJ_FLAG_HIDDEN);
+    }
+    lv_refr_now(disp);
+    alarm_note_displayed();
+}
+#endif
+
+#if CONFIG_DISPLAY_POWER_MGMT
+// 任一传感器的最新值达到告警浓度，或告警引擎处于告警
+static bool lvgl_alert_active(void)
+{
+    const int32_t alert_level = sensor_hcho_ugm3_to_ppb(CONFIG_SENSOR_HCHO_ALERT_UGM3 * SENSOR_HCHO_SCALE);
+    sensor_sample_t sample;
+    for (int id = 0; id < SENSOR_ID_MAX; id++) {
+        if (sensor_get_latest(id, SENSOR_CH_HCHO, &sample) && sample.value >= alert_level) {
+            return true;
+        }
+    }
+    return alarm_active_mask() != 0;
+}
+#endif
+
 static void lvgl_port_task(void *arg)
 {
     lv_disp_t *display = (lv_disp_t *)arg;
     ESP_LOGI(TAG, "Starting LVGL task");
     uint32_t time_till_next_ms = 0;
+#if CONFIG_DISPLAY_POWER_MGMT
+    // 面板命令都在本任务中发出，避免与刷屏并发访问 I2C
+    display_power_init(xTaskGetCurrentTaskHandle());
+#endif
     while (1) {
+#if CONFIG_DISPLAY_POWER_MGMT
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        if (display_power_update(now_ms, lvgl_alert_active()) == DISPLAY_POWER_OFF) {
+            // 面板关闭：停止 tick 与渲染，等待按键通知或定期检查告警
+            if (esp_timer_is_active(lvgl_tick_timer)) {
+                esp_timer_stop(lvgl_tick_timer);
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AIR_LVGL_OFF_POLL_MS));
+            continue;
+        }
+        if (!esp_timer_is_active(lvgl_tick_timer)) {
+            // 恢复显示：重新启动 tick，并让整屏重绘一次
+            esp_timer_start_periodic(lvgl_tick_timer, AIR_LVGL_TICK_PERIOD_MS * 1000);
+            _lock_acquire(&lvgl_api_lock);
+            lv_obj_invalidate(lv_display_get_screen_active(display));
+            _lock_release(&lvgl_api_lock);
+        }
+#endif
         _lock_acquire(&lvgl_api_lock);
+        int64_t busy_start = esp_timer_get_time();
+        lvgl_apply_sysmon(display);
         time_till_next_ms = lv_timer_handler();
+#if CONFIG_ALARM
+        lvgl_update_alarm_banner(display);
+#endif
         // 在主循环中刷新甲醛浓度显示
-        lvgl_update_dart_ch2o(display, g_dart_hcho_mg, g_dart_hcho_ppb);
-        lvgl_update_winsen_ch2o(display, g_winsen_hcho_mg, g_winsen_hcho_ppb);
+        sensor_sample_t sample;
+        if (sensor_get_latest(SENSOR_ID_DART, SENSOR_CH_HCHO, &sample)) {
+            lvgl_update_dart_ch2o(display, &sample);
+        }
+        if (sensor_get_latest(SENSOR_ID_WINSEN, SENSOR_CH_HCHO, &sample)) {
+            lvgl_update_winsen_ch2o(display, &sample);
+        }
+#if CONFIG_UI_TREND_PAGE
+        lvgl_update_trend(display);
+#endif
+#if CONFIG_I2C_ARBITER_BENCH
+        // 压力测试：每轮都整屏重绘，模拟持续动画下的刷屏负载
+        lv_obj_invalidate(lv_display_get_screen_active(display));
+#endif
+        uint32_t busy_us = (uint32_t)(esp_timer_get_time() - busy_start);
+        ui_stats.loops++;
+        ui_stats.busy_us += busy_us;
+        ui_stats.busy_max_us = MAX(ui_stats.busy_max_us, busy_us);
         _lock_release(&lvgl_api_lock);
         // in case of triggering a task watch dog time out
         time_till_next_ms = MAX(time_till_next_ms, AIR_LVGL_TASK_MIN_DELAY_MS);
         // in case of lvgl display not ready yet
         time_till_next_ms = MIN(time_till_next_ms, AIR_LVGL_TASK_MAX_DELAY_MS);
-        usleep(1000 * time_till_next_ms);
+        // 告警与唤醒按键通过任务通知提前结束等待
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(time_till_next_ms));
     }
 }
 
@@ -126,11 +362,14 @@ esp_err_t init_lvgl_display(void)
     
     // create draw buffer
     void *buf = NULL;
+    size_t draw_buffer_sz = AIR_LVGL_DRAW_BUF_SIZE;
+#if CONFIG_STATIC_ALLOCATION
+    buf = lvgl_draw_buf;
+#else
     ESP_LOGI(TAG, "Allocate separate LVGL draw buffers");
-    // LVGL reserves 2 x 4 bytes in the buffer, as these are assumed to be used as a palette.
-    size_t draw_buffer_sz = AIR_LCD_H_RES * AIR_LCD_V_RES / 8 + AIR_LVGL_PALETTE_SIZE;
     buf = heap_caps_calloc(1, draw_buffer_sz, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
     assert(buf);
+#endif
 
     // LVGL9 suooprt new monochromatic format.
     lv_display_set_color_format(display, LV_COLOR_FORMAT_I1);
@@ -139,24 +378,35 @@ esp_err_t init_lvgl_display(void)
     // set the callback which can copy the rendered image to an area of the display
     lv_display_set_flush_cb(display, display_lvgl_flush_cb);
 
+#if CONFIG_I2C_DISPLAY_CHUNK_PAGES == 0
     ESP_LOGI(TAG, "Register io panel event callback for LVGL flush ready notification");
     const esp_lcd_panel_io_callbacks_t cbs = {
         .on_color_trans_done = notify_lvgl_flush_ready,
     };
     /* Register done callback */
     esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, display);
+#endif
 
     ESP_LOGI(TAG, "Use esp_timer as LVGL tick timer");
     const esp_timer_create_args_t lvgl_tick_timer_args = {
         .callback = &display_increase_lvgl_tick,
         .name = "lvgl_tick"
     };
-    esp_timer_handle_t lvgl_tick_timer = NULL;
     ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, AIR_LVGL_TICK_PERIOD_MS * 1000));
 
     ESP_LOGI(TAG, "Create LVGL task");
-    xTaskCreate(lvgl_port_task, "LVGL", AIR_LVGL_TASK_STACK_SIZE, display, AIR_LVGL_TASK_PRIORITY, NULL);
+    TaskHandle_t lvgl_task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    lvgl_task = xTaskCreateStaticPinnedToCore(lvgl_port_task, "LVGL", AIR_LVGL_TASK_STACK_SIZE, display,
+                                              AIR_LVGL_TASK_PRIORITY, lvgl_task_stack, &lvgl_task_tcb, TASK_CORE_UI);
+#else
+    xTaskCreatePinnedToCore(lvgl_port_task, "LVGL", AIR_LVGL_TASK_STACK_SIZE, display, AIR_LVGL_TASK_PRIORITY,
+                            &lvgl_task, TASK_CORE_UI);
+#endif
+    lvgl_task_handle = lvgl_task;
+    alloc_guard_track_task(lvgl_task);
+    mem_profiler_register_task(lvgl_task, AIR_LVGL_TASK_STACK_SIZE);
 
     ESP_LOGI(TAG, "Display LVGL Scroll Text");
     // Lock the mutex due to the LVGL APIs are not thread-safe
@@ -167,32 +417,234 @@ esp_err_t init_lvgl_display(void)
     return ESP_OK;
 }
 
-void lvgl_update_dart_ch2o(lv_display_t *disp, float mg, float ppb)
+// 按 "x.xxx mg/m3, n ppb" 格式化 HCHO 样本，只用整数运算
+static void format_hcho(char *buf, size_t size, const char *name, const sensor_sample_t *sample)
+{
+    int32_t ugm3 = sensor_hcho_to_ugm3(sample->value);
+    long ppb = (long)(sample->value / SENSOR_HCHO_SCALE);
+#if CONFIG_UI_LAYOUT_STATIC
+    // 静态布局中传感器名称在页标题里，这里只排版数值，保证不超出屏幕
+#if AIR_LCD_H_RES < 128
+    // 64 像素宽（SH1107 竖屏）每行只放得下一个字段
+    snprintf(buf, size, "%ld.%03ld\nmg/m3\n%ld ppb", (long)(ugm3 / 1000), (long)(ugm3 % 1000), ppb);
+#elif AIR_LCD_V_RES < 64
+    // 128x32 只有标题之外的一行
+    snprintf(buf, size, "%ld.%03ld mg %ld ppb", (long)(ugm3 / 1000), (long)(ugm3 % 1000), ppb);
+#else
+    snprintf(buf, size, "%ld.%03ld mg/m3\n%ld ppb", (long)(ugm3 / 1000), (long)(ugm3 % 1000), ppb);
+#endif
+    (void)name;
+#else
+    snprintf(buf, size, "%s HCHO: %ld.%03ld mg/m3, %ld ppb", name,
+             (long)(ugm3 / 1000), (long)(ugm3 % 1000), ppb);
+#endif
+}
+
+#if AIR_UI_RECENT_STATS
+// 在数值下追加最近窗口的均值与 p95（ppb），从列式近期历史取得：整块直接用块摘要，不读 flash
+static void format_recent_stats(char *buf, size_t size, const sensor_sample_t *sample)
+{
+    const uint32_t window_ms = CONFIG_UI_RECENT_STATS_WINDOW_S * 1000;
+    uint32_t to_ms = sample->timestamp_ms + 1;
+    uint32_t from_ms = (to_ms > window_ms) ? to_ms - window_ms : 0;
+    history_col_agg_t agg;
+    int32_t p95;
+    if (history_recent_aggregate(sample->sensor_id, sample->channel, from_ms, to_ms, &agg) == 0 ||
+        !history_recent_percentile(sample->sensor_id, sample->channel, from_ms, to_ms, 95, &p95)) {
+        return;
+    }
+    size_t len = strlen(buf);
+    snprintf(buf + len, size - len, "\navg %ld p95 %ld", (long)(agg.sum / agg.count / SENSOR_HCHO_SCALE),
+             (long)(p95 / SENSOR_HCHO_SCALE));
+}
+#endif
+
+// 只有显示文本真正变化时才更新 label，避免无效的重绘和 I2C 刷屏
+static void set_label_text_if_changed(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+void lvgl_update_dart_ch2o(lv_display_t *disp, const sensor_sample_t *sample)
 {
-    static float last_mg = -1.0f;
-    if (dart_hcho_label && mg != last_mg) {
+    static uint16_t last_seq = 0;
+    if (dart_hcho_label && sample->seq != last_seq) {
         char buf[128];
-        snprintf(buf, sizeof(buf), "Dart HCHO: %.3f mg/m3, %d ppb", mg, (int)ppb);
-        lv_label_set_text(dart_hcho_label, buf);
-        last_mg = mg;
+        format_hcho(buf, sizeof(buf), "Dart", sample);
+#if AIR_UI_RECENT_STATS
+        format_recent_stats(buf, sizeof(buf), sample);
+#endif
+        set_label_text_if_changed(dart_hcho_label, buf);
+        last_seq = sample->seq;
     }
 }
 
-void lvgl_update_winsen_ch2o(lv_display_t *disp, float mg, float ppb)
+void lvgl_update_winsen_ch2o(lv_display_t *disp, const sensor_sample_t *sample)
 {
-    static float last_mg = -1.0f;
-    if (winsen_hcho_label && mg != last_mg) {
+    static uint16_t last_seq = 0;
+    if (winsen_hcho_label && sample->seq != last_seq) {
         char buf[128];
-        snprintf(buf, sizeof(buf), "Winsen HCHO: %.3f mg/m3, %d ppb", mg, (int)ppb);
-        lv_label_set_text(winsen_hcho_label, buf);
-        last_mg = mg;
+        format_hcho(buf, sizeof(buf), "Winsen", sample);
+#if AIR_UI_RECENT_STATS
+        format_recent_stats(buf, sizeof(buf), sample);
+#endif
+        set_label_text_if_changed(winsen_hcho_label, buf);
+        last_seq = sample->seq;
+    }
+}
+
+
+#if CONFIG_UI_TREND_PAGE
+void lvgl_update_trend(lv_disp_t *disp)
+{
+    for (int id = 0; id < SENSOR_ID_LOCAL_COUNT; id++) {
+        if (!trend_charts[id]) {
+            continue;
+        }
+        uint32_t n = sensor_history_read_since(id, SENSOR_CH_HCHO, trend_total[id], trend_points,
+                                               SENSOR_HISTORY_POINTS, &trend_total[id]);
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t v = trend_points[i];
+            if (v == SENSOR_HISTORY_GAP) {
+                v = LV_CHART_POINT_NONE;
+            } else {
+                v /= SENSOR_HCHO_SCALE;
+                // 超出量程时才放大 Y 轴，这是唯一需要重绘整条曲线的情况
+                if (v > trend_range_ppb[id]) {
+                    trend_range_ppb[id] = v + v / 4 + 1;
+                    lv_chart_set_range(trend_charts[id], LV_CHART_AXIS_PRIMARY_Y, 0, trend_range_ppb[id]);
+                }
+            }
+            // 环形写入下一个点，O(1)，只使图表区域失效
+            lv_chart_set_next_value(trend_charts[id], trend_series[id], v);
+        }
+    }
+}
+
+// 创建趋势页：每个本地传感器一行，左侧为名称首字母，右侧为 sparkline
+static void ui_create_trend_page(lv_display_t *disp)
+{
+    static const char *const initials[SENSOR_ID_LOCAL_COUNT] = {
+        [SENSOR_ID_DART]   = "D",
+        [SENSOR_ID_WINSEN] = "W",
+    };
+    lv_obj_t *scr = lv_display_get_screen_active(disp);
+    int32_t hor_res = lv_display_get_horizontal_resolution(disp);
+    int32_t ver_res = lv_display_get_vertical_resolution(disp);
+
+    lv_obj_t *cont = lv_obj_create(scr);
+    lv_obj_remove_style_all(cont);
+    lv_obj_set_size(cont, hor_res, ver_res);
+    lv_obj_remove_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+    ui_pages[UI_PAGE_TREND] = cont;
+
+    lv_obj_t *title_label = lv_label_create(cont);
+    lv_label_set_text_static(title_label, "HCHO trend");
+    lv_label_set_long_mode(title_label, LV_LABEL_LONG_CLIP);
+    lv_obj_set_width(title_label, hor_res);
+    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 0);
+
+    int32_t row_h = (ver_res - 16) / SENSOR_ID_LOCAL_COUNT;
+    int32_t alert_ppb = sensor_hcho_ugm3_to_ppb(CONFIG_SENSOR_HCHO_ALERT_UGM3 * SENSOR_HCHO_SCALE) / SENSOR_HCHO_SCALE;
+    for (int id = 0; id < SENSOR_ID_LOCAL_COUNT; id++) {
+        int32_t y = 16 + id * row_h;
+
+        lv_obj_t *name = lv_label_create(cont);
+        lv_label_set_text_static(name, initials[id]);
+        lv_obj_set_pos(name, 0, y);
+
+        lv_obj_t *chart = lv_chart_create(cont);
+        lv_obj_set_size(chart, hor_res - 12, row_h);
+        lv_obj_set_pos(chart, 12, y);
+        lv_obj_set_style_border_width(chart, 0, LV_PART_MAIN);
+        lv_obj_set_style_pad_all(chart, 0, LV_PART_MAIN);
+        lv_obj_set_style_radius(chart, 0, LV_PART_MAIN);
+        lv_obj_set_style_bg_opa(chart, LV_OPA_TRANSP, LV_PART_MAIN);
+        lv_obj_set_style_line_width(chart, 1, LV_PART_ITEMS);
+        lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR);   // 不画数据点
+        lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+        lv_chart_set_div_line_count(chart, 0, 0);
+        lv_chart_set_point_count(chart, sensor_history_points(SENSOR_CH_HCHO));
+        lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
+        // 初始量程覆盖告警浓度，超出后再按需放大
+        trend_range_ppb[id] = MAX(alert_ppb, 1);
+        lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 0, trend_range_ppb[id]);
+
+        trend_series[id] = lv_chart_add_series(chart, lv_color_black(), LV_CHART_AXIS_PRIMARY_Y);
+        lv_chart_set_all_value(chart, trend_series[id], LV_CHART_POINT_NONE);
+        trend_charts[id] = chart;
     }
+
+    if (UI_PAGE_TREND != ui_page_current) {
+        lv_obj_add_flag(cont, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+#endif
+
+#if CONFIG_UI_LAYOUT_STATIC
+// 定时切换页面：隐藏当前页、显示下一页，只在切换时重绘一帧
+static void ui_page_timer_cb(lv_timer_t *timer)
+{
+    lv_obj_add_flag(ui_pages[ui_page_current], LV_OBJ_FLAG_HIDDEN);
+    ui_page_current = (ui_page_current + 1) % UI_PAGE_MAX;
+    lv_obj_remove_flag(ui_pages[ui_page_current], LV_OBJ_FLAG_HIDDEN);
 }
 
+// 创建一个全屏页面，包含标题和数值两个静态 label，返回数值 label
+static lv_obj_t *ui_create_sensor_page(lv_display_t *disp, ui_page_t page, const char *title)
+{
+    lv_obj_t *scr = lv_display_get_screen_active(disp);
+    int32_t hor_res = lv_display_get_horizontal_resolution(disp);
+
+    lv_obj_t *cont = lv_obj_create(scr);
+    lv_obj_remove_style_all(cont);
+    lv_obj_set_size(cont, hor_res, lv_display_get_vertical_resolution(disp));
+    lv_obj_remove_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
+    ui_pages[page] = cont;
+
+    lv_obj_t *title_label = lv_label_create(cont);
+    lv_label_set_text_static(title_label, title);
+    lv_label_set_long_mode(title_label, LV_LABEL_LONG_CLIP);
+    lv_obj_set_width(title_label, hor_res);
+    lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 0);
+
+    // WRAP/CLIP 都不会启动动画，内容不变时整屏保持静止
+    lv_obj_t *value_label = lv_label_create(cont);
+    lv_label_set_text(value_label, "--");
+    lv_label_set_long_mode(value_label, LV_LABEL_LONG_WRAP);
+    lv_obj_set_width(value_label, hor_res);
+    lv_obj_align(value_label, LV_ALIGN_TOP_MID, 0, 16);
+
+    if (page != ui_page_current) {
+        lv_obj_add_flag(cont, LV_OBJ_FLAG_HIDDEN);
+    }
+    return value_label;
+}
+#endif
 
 void lvgl_main_ui(lv_display_t *disp)
 {
     ESP_LOGI(TAG, "lvgl_main_ui");
+#if CONFIG_ALARM
+    ui_create_alarm_banner(disp);
+#endif
+#if CONFIG_UI_LAYOUT_STATIC
+    dart_hcho_label = ui_create_sensor_page(disp, UI_PAGE_DART, "Dart HCHO");
+    winsen_hcho_label = ui_create_sensor_page(disp, UI_PAGE_WINSEN, "Winsen HCHO");
+#if AIR_UI_RECENT_STATS
+    // 在传感器开始发布前预留序列，不让其他先发布的来源占满
+    history_recent_track(SENSOR_ID_DART, SENSOR_CH_HCHO);
+    history_recent_track(SENSOR_ID_WINSEN, SENSOR_CH_HCHO);
+#endif
+#if CONFIG_UI_TREND_PAGE
+    ui_create_trend_page(disp);
+#endif
+#if CONFIG_UI_PAGE_INTERVAL_S > 0
+    lv_timer_create(ui_page_timer_cb, CONFIG_UI_PAGE_INTERVAL_S * 1000, NULL);
+#endif
+#else
     lv_obj_t *scr = lv_display_get_screen_active(disp);
     
     lv_obj_t *label = lv_label_create(scr);
@@ -223,5 +675,5 @@ void lvgl_main_ui(lv_display_t *disp)
     lv_obj_align(winsen_hcho_label, LV_ALIGN_TOP_MID, 0, 40);
     // 设置滚动速度
     lv_obj_set_style_anim_time(winsen_hcho_label, 8000, 0);
+#endif
 }
-
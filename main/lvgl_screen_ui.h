@@ -2,6 +2,7 @@
 #define LVGL_SCREEN_UI_H
 
 #include "lvgl.h"
+#include "sensor.h"
 
 // The pixel number in horizontal and vertical
 #if CONFIG_LCD_CONTROLLER_SSD1306
@@ -17,7 +18,26 @@ esp_err_t init_lvgl_display(void);
 void lvgl_main_ui(lv_display_t *disp);
 
 
-void lvgl_update_dart_ch2o(lv_disp_t *disp, float mg, float ppb);
-void lvgl_update_winsen_ch2o(lv_disp_t *disp, float mg, float ppb);
+void lvgl_update_dart_ch2o(lv_disp_t *disp, const sensor_sample_t *sample);
+void lvgl_update_winsen_ch2o(lv_disp_t *disp, const sensor_sample_t *sample);
+// 唤醒 UI 任务立即处理一轮（告警横幅等），可在任意任务中调用
+void lvgl_ui_notify(void);
+// 显示/隐藏 LVGL 性能与内存监视叠加层（需启用 LV_USE_PERF_MONITOR / LV_USE_MEM_MONITOR），可在任意任务中调用
+void lvgl_ui_set_sysmon(bool show);
+
+// UI 任务的负载统计，自上次读取以来累计
+typedef struct {
+    uint32_t loops;          // 主循环轮数
+    uint32_t busy_us;        // 持锁处理（定时器、渲染、刷屏）的累计耗时
+    uint32_t busy_max_us;    // 单轮最长耗时
+    uint32_t mem_used;       // LVGL 内置堆已用字节（未使用内置堆时为 0）
+    uint32_t mem_free;
+    uint8_t  mem_frag_pct;
+} lvgl_ui_stats_t;
+
+// 读取并清零负载统计，会短暂持有 LVGL 锁
+void lvgl_ui_take_stats(lvgl_ui_stats_t *out);
+// 把历史环中新增的点追加到趋势图（需启用 CONFIG_UI_TREND_PAGE）
+void lvgl_update_trend(lv_disp_t *disp);
 
 #endif // LVGL_SCREEN_UI_H
@@ -25,7 +25,21 @@ Air Quality Monitoring:
 #include "freertos/queue.h"
 #include "lvgl_screen_ui.h"
 #include "wifi_station.h"
-#include "protocols/mqtt_device.h"
+#include "protocols/telemetry.h"
+#include "sensor_filter.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "jitter_bench.h"
+#include "time_sync.h"
+#include "sensor_bus.h"
+#include "i2c_arbiter.h"
+#include "sht4x.h"
+#include "history_store.h"
+#include "history_export.h"
+#include "history_recent.h"
+#include "alarm.h"
+#include "cpu_profiler.h"
+#include "energy_meter.h"
 
 #if CONFIG_LCD_CONTROLLER_SH1107
 #include "esp_lcd_sh1107.h"
@@ -70,6 +84,8 @@ esp_err_t init_i2c_bus()
         .flags.enable_internal_pullup = true,
     };
     ESP_ERROR_CHECK(i2c_new_master_bus(&bus_config, &i2c_bus));
+    // 显示与辅助传感器共用本总线，访问都经过仲裁
+    i2c_arbiter_init();
     return ESP_OK;
 }
 
@@ -133,6 +149,13 @@ void app_main(void)
       ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    // 能耗计时需在射频、显示与传感器启动前开始
+    energy_meter_start();
+
+    // 长期历史需在传感器开始发布前就绪
+    history_store_init();
+    history_export_init();
+    history_recent_start();
 
     // 初始化I2C总线
     init_i2c_bus();
@@ -142,10 +165,26 @@ void app_main(void)
     init_lcd_device();
 
     init_lvgl_display();
+    // 告警需在传感器开始逐帧判定前就绪
+    alarm_init();
+    sht4x_start(i2c_bus);
+
+#if CONFIG_SENSOR_FILTER_SELFTEST
+    sensor_filter_selftest();
+#endif
+#if CONFIG_HISTORY_RECENT_BENCH
+    history_recent_bench();
+#endif
 
     // 启动 Dart 传感器功能（队列、任务、打印）
+    // RS-485 总线占用的 UART 上不再启动对应的本地传感器
+#if !(CONFIG_SENSOR_BUS && CONFIG_SENSOR_BUS_UART_PORT == 1)
     dart_sensor_start();
+#endif
+#if !(CONFIG_SENSOR_BUS && CONFIG_SENSOR_BUS_UART_PORT == 2)
     winsen_sensor_start();
+#endif
+    sensor_bus_start();
 
 
     if (CONFIG_LOG_MAXIMUM_LEVEL > CONFIG_LOG_DEFAULT_LEVEL) {
@@ -156,11 +195,26 @@ void app_main(void)
 
     // init WiFi
     wifi_init_sta();
+    time_sync_init();
+
+    mem_profiler_register_task(xTaskGetCurrentTaskHandle(), CONFIG_ESP_MAIN_TASK_STACK_SIZE);
+    mem_profiler_start();
+    cpu_profiler_start();
+#if CONFIG_JITTER_BENCH_LOAD
+    jitter_bench_start_load();
+#endif
 
-    // xTaskCreate(mqtt_task, "mqtt_task", 4096, NULL, 5, NULL);
-    // mqtt_task();
+    telemetry_start();
     
+#if CONFIG_STATIC_ALLOCATION_CHECK
+    alloc_guard_track_task(xTaskGetCurrentTaskHandle());
+    // 等各任务完成首次初始化（模式切换、首次刷屏、首次发布）后再开始检查
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_STATIC_ALLOCATION_SETTLE_S * 1000));
+    alloc_guard_seal();
+#endif
+
     while(1){
         vTaskDelay(pdMS_TO_TICKS(1000));
+        alloc_guard_check();
     }
 }
@@ -0,0 +1,124 @@
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+#if CONFIG_MEM_PROFILER
+
+static const char *TAG = "mem_prof";
+
+#define MEM_PROFILER_STACK_ALIGN   256
+#define MEM_PROFILER_TASK_STACK    3072
+
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t stack_size;
+} mem_profiler_task_t;
+
+typedef struct {
+    const char *name;
+    uint32_t caps;
+} mem_profiler_heap_t;
+
+static mem_profiler_task_t g_tasks[TASK_COUNT_MAX];
+static int g_task_count = 0;
+static portMUX_TYPE g_tasks_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_profiler_stack[MEM_PROFILER_TASK_STACK];
+static StaticTask_t g_profiler_tcb;
+#endif
+
+static const mem_profiler_heap_t g_heaps[] = {
+    { "internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT },
+    { "dma",      MALLOC_CAP_DMA },
+#if CONFIG_SPIRAM
+    { "spiram",   MALLOC_CAP_SPIRAM },
+#endif
+};
+
+void mem_profiler_register_task(TaskHandle_t task, uint32_t stack_size)
+{
+    if (!task) {
+        return;
+    }
+    bool full = false;
+    portENTER_CRITICAL(&g_tasks_lock);
+    if (g_task_count < TASK_COUNT_MAX) {
+        g_tasks[g_task_count].handle = task;
+        g_tasks[g_task_count].stack_size = stack_size;
+        g_task_count++;
+    } else {
+        full = true;
+    }
+    portEXIT_CRITICAL(&g_tasks_lock);
+    if (full) {
+        ESP_LOGW(TAG, "Task table full (%d), %s not profiled; raise TASK_COUNT_MAX in task_config.h", TASK_COUNT_MAX,
+                 pcTaskGetName(task));
+    }
+}
+
+// 建议栈大小：峰值用量加余量，向上取整到 256 字节
+static uint32_t recommend_stack(uint32_t used)
+{
+    uint32_t size = used + used * CONFIG_MEM_PROFILER_STACK_MARGIN_PCT / 100;
+    return (size + MEM_PROFILER_STACK_ALIGN - 1) / MEM_PROFILER_STACK_ALIGN * MEM_PROFILER_STACK_ALIGN;
+}
+
+void mem_profiler_report(void)
+{
+    int32_t reclaim = 0;
+    // 登记表只追加，取得数量后读取其中的条目无需持锁
+    portENTER_CRITICAL(&g_tasks_lock);
+    int count = g_task_count;
+    portEXIT_CRITICAL(&g_tasks_lock);
+
+    ESP_LOGI(TAG, "%-16s %6s %8s %6s %9s", "task", "stack", "min_free", "used", "recommend");
+    for (int i = 0; i < count; i++) {
+        const mem_profiler_task_t *t = &g_tasks[i];
+        // ESP-IDF 中 StackType_t 为字节，高水位即历史最小剩余字节数
+        uint32_t min_free = uxTaskGetStackHighWaterMark(t->handle);
+        uint32_t used = (t->stack_size > min_free) ? t->stack_size - min_free : 0;
+        uint32_t rec = recommend_stack(used);
+        reclaim += (int32_t)t->stack_size - (int32_t)rec;
+        ESP_LOGI(TAG, "%-16s %6lu %8lu %6lu %9lu%s", pcTaskGetName(t->handle), (unsigned long)t->stack_size,
+                 (unsigned long)min_free, (unsigned long)used, (unsigned long)rec,
+                 (rec > t->stack_size) ? "  <- too small" : "");
+    }
+    ESP_LOGI(TAG, "Stack reclaimable with recommended sizes: %ld bytes", (long)reclaim);
+
+    for (size_t i = 0; i < sizeof(g_heaps) / sizeof(g_heaps[0]); i++) {
+        size_t free_bytes = heap_caps_get_free_size(g_heaps[i].caps);
+        size_t largest = heap_caps_get_largest_free_block(g_heaps[i].caps);
+        // 碎片率：空闲总量中无法以单块分配出去的比例
+        unsigned frag = free_bytes ? (unsigned)(100 - largest * 100 / free_bytes) : 0;
+        ESP_LOGI(TAG, "heap %-8s total %7u free %7u min_free %7u largest %7u frag %u%%", g_heaps[i].name,
+                 (unsigned)heap_caps_get_total_size(g_heaps[i].caps), (unsigned)free_bytes,
+                 (unsigned)heap_caps_get_minimum_free_size(g_heaps[i].caps), (unsigned)largest, frag);
+    }
+}
+
+static void mem_profiler_task(void *arg)
+{
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_MEM_PROFILER_PERIOD_S * 1000));
+        mem_profiler_report();
+    }
+}
+
+void mem_profiler_start(void)
+{
+    TaskHandle_t handle = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    handle = xTaskCreateStaticPinnedToCore(mem_profiler_task, "mem_prof", MEM_PROFILER_TASK_STACK, NULL, TASK_PRIO_AUX,
+                                           g_profiler_stack, &g_profiler_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(mem_profiler_task, "mem_prof", MEM_PROFILER_TASK_STACK, NULL, TASK_PRIO_AUX, &handle,
+                            TASK_CORE_AUX);
+#endif
+    alloc_guard_track_task(handle);
+    mem_profiler_register_task(handle, MEM_PROFILER_TASK_STACK);
+}
+
+#endif // CONFIG_MEM_PROFILER
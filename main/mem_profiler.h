@@ -0,0 +1,40 @@
+#ifndef __MEM_PROFILER_H__
+#define __MEM_PROFILER_H__
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * 栈与堆水位分析
+ *
+ * 周期性采样已登记任务的栈高水位、各能力堆的最低剩余与最大空闲块，
+ * 输出每个任务的建议栈大小（实际峰值 + 余量，按 256 字节取整）以及可回收的内存总量。
+ */
+
+#if CONFIG_MEM_PROFILER
+
+/**
+ * @brief 登记一个任务及其创建时的栈大小（字节）
+ */
+void mem_profiler_register_task(TaskHandle_t task, uint32_t stack_size);
+
+/**
+ * @brief 立即输出一次报告
+ */
+void mem_profiler_report(void);
+
+/**
+ * @brief 启动周期性报告任务
+ */
+void mem_profiler_start(void);
+
+#else
+
+static inline void mem_profiler_register_task(TaskHandle_t task, uint32_t stack_size) {}
+static inline void mem_profiler_report(void) {}
+static inline void mem_profiler_start(void) {}
+
+#endif // CONFIG_MEM_PROFILER
+
+#endif // __MEM_PROFILER_H__
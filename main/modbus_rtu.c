@@ -0,0 +1,82 @@
+#include "modbus_rtu.h"
+#include <stdbool.h>
+
+// 半字节查表，16项表在速度与 ROM 占用之间折中
+static const uint16_t g_crc_nibble[16] = {
+    0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+    0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+};
+
+uint16_t modbus_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ g_crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ g_crc_nibble[crc & 0x0F];
+    }
+    return crc;
+}
+
+size_t modbus_build_read_input(uint8_t addr, uint16_t reg, uint16_t count, uint8_t *out)
+{
+    out[0] = addr;
+    out[1] = MODBUS_FC_READ_INPUT_REGS;
+    out[2] = (uint8_t)(reg >> 8);
+    out[3] = (uint8_t)reg;
+    out[4] = (uint8_t)(count >> 8);
+    out[5] = (uint8_t)count;
+    uint16_t crc = modbus_crc16(out, 6);
+    out[6] = (uint8_t)crc;
+    out[7] = (uint8_t)(crc >> 8);
+    return MODBUS_REQ_READ_SIZE;
+}
+
+static bool crc_ok(const uint8_t *frame, size_t len)
+{
+    uint16_t crc = modbus_crc16(frame, len - 2);
+    return frame[len - 2] == (uint8_t)crc && frame[len - 1] == (uint8_t)(crc >> 8);
+}
+
+modbus_status_t modbus_parse_read_response(const uint8_t *frame, size_t len, uint8_t addr,
+                                           uint16_t *regs, uint16_t count)
+{
+    if (len < MODBUS_EXCEPTION_SIZE) {
+        return MODBUS_ERR_SHORT;
+    }
+    if (frame[1] == (MODBUS_FC_READ_INPUT_REGS | MODBUS_FC_EXCEPTION_BIT)) {
+        if (!crc_ok(frame, MODBUS_EXCEPTION_SIZE)) {
+            return MODBUS_ERR_CRC;
+        }
+        return (frame[0] == addr) ? MODBUS_ERR_EXCEPTION : MODBUS_ERR_ADDR;
+    }
+    if (len < (size_t)MODBUS_RESP_READ_SIZE(count)) {
+        return MODBUS_ERR_SHORT;
+    }
+    len = MODBUS_RESP_READ_SIZE(count);
+    if (!crc_ok(frame, len)) {
+        return MODBUS_ERR_CRC;
+    }
+    if (frame[0] != addr) {
+        return MODBUS_ERR_ADDR;
+    }
+    if (frame[1] != MODBUS_FC_READ_INPUT_REGS) {
+        return MODBUS_ERR_FUNC;
+    }
+    if (frame[2] != 2 * count) {
+        return MODBUS_ERR_SHORT;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        regs[i] = (uint16_t)((frame[3 + 2 * i] << 8) | frame[4 + 2 * i]);
+    }
+    return MODBUS_OK;
+}
+
+uint32_t modbus_t35_us(uint32_t baud)
+{
+    if (baud > 19200) {
+        return 1750;
+    }
+    // 每字符11位（起始+8数据+校验/停止+停止），3.5个字符时间
+    return (uint32_t)((35ULL * 11 * 1000000 / 10 + baud - 1) / baud);
+}
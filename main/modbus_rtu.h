@@ -0,0 +1,57 @@
+#ifndef __MODBUS_RTU_H__
+#define __MODBUS_RTU_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Modbus RTU 帧编解码（主站侧），只实现轮询传感器用到的 0x04 读输入寄存器
+ *
+ * 请求：| 地址 | 0x04 | 起始寄存器 Hi/Lo | 数量 Hi/Lo | CRC Lo/Hi |
+ * 应答：| 地址 | 0x04 | 字节数 | 数据 Hi/Lo ... | CRC Lo/Hi |
+ * 异常：| 地址 | 0x84 | 异常码 | CRC Lo/Hi |
+ */
+
+#define MODBUS_FC_READ_INPUT_REGS   0x04
+#define MODBUS_FC_EXCEPTION_BIT     0x80
+
+#define MODBUS_ADDR_MIN             1
+#define MODBUS_ADDR_MAX             247
+
+#define MODBUS_REQ_READ_SIZE        8
+#define MODBUS_RESP_READ_SIZE(n)    (5 + 2 * (n))
+#define MODBUS_EXCEPTION_SIZE       5
+
+typedef enum {
+    MODBUS_OK            = 0,
+    MODBUS_ERR_SHORT     = -1,   // 长度不足或与寄存器数量不符
+    MODBUS_ERR_CRC       = -2,
+    MODBUS_ERR_ADDR      = -3,   // 从站地址不符（总线冲突或残留帧）
+    MODBUS_ERR_FUNC      = -4,   // 功能码不符
+    MODBUS_ERR_EXCEPTION = -5,   // 从站返回异常应答
+} modbus_status_t;
+
+/**
+ * @brief Modbus CRC16（多项式 0xA001，初值 0xFFFF），结果低字节在前发送
+ */
+uint16_t modbus_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief 构造读输入寄存器请求
+ * @return 帧长度（MODBUS_REQ_READ_SIZE）
+ */
+size_t modbus_build_read_input(uint8_t addr, uint16_t reg, uint16_t count, uint8_t *out);
+
+/**
+ * @brief 校验并解析读输入寄存器应答（含异常应答）
+ * @param regs 输出 count 个寄存器值
+ */
+modbus_status_t modbus_parse_read_response(const uint8_t *frame, size_t len, uint8_t addr,
+                                           uint16_t *regs, uint16_t count);
+
+/**
+ * @brief 帧间静默时间 t3.5（微秒）；波特率高于 19200 时按规范固定为 1750us
+ */
+uint32_t modbus_t35_us(uint32_t baud);
+
+#endif // __MODBUS_RTU_H__
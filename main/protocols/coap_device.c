@@ -0,0 +1,323 @@
+#include "sdkconfig.h"
+
+#if CONFIG_TELEMETRY_COAP
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "lwip/sockets.h"
+#include "lwip/netdb.h"
+#include "coap_device.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+
+#define COAP_VERSION                1
+#define COAP_TYPE_CON               0
+#define COAP_TYPE_NON               1
+#define COAP_TYPE_ACK               2
+#define COAP_TYPE_RST               3
+#define COAP_CODE_POST              0x02
+#define COAP_OPTION_URI_PATH        11
+#define COAP_OPTION_CONTENT_FORMAT  12
+#define COAP_FORMAT_TEXT            0
+#define COAP_FORMAT_OCTET_STREAM    42
+#define COAP_PAYLOAD_MARKER         0xFF
+#define COAP_HEADER_SIZE            4
+
+// RFC 7252 默认传输参数
+#define COAP_ACK_TIMEOUT_MS         2000
+#define COAP_MAX_RETRANSMIT         4
+// 告警任务串行发送，按默认参数一条告警最长要等约 90 s，后续的状态变化全部排在后面；
+// 只重传一次，最坏约 9 s 后放弃，计入 net_failed
+#define COAP_ALARM_MAX_RETRANSMIT   1
+
+#if CONFIG_COAP_CONFIRMABLE
+#define COAP_SEND_TYPE              COAP_TYPE_CON
+#define COAP_SEND_TYPE_NAME         "CON"
+#else
+#define COAP_SEND_TYPE              COAP_TYPE_NON
+#define COAP_SEND_TYPE_NAME         "NON"
+#endif
+
+#define COAP_UDP_IP_OVERHEAD        28      // IPv4 20 + UDP 8
+#define COAP_PATH_MAX               32
+#define COAP_PAYLOAD_MAX            40
+#define COAP_MSG_MAX                (COAP_HEADER_SIZE + 2 + COAP_PATH_MAX + 2 + 1 + COAP_PAYLOAD_MAX)
+#define COAP_QUEUE_LEN              16
+#define COAP_TASK_STACK_SIZE        3072
+#define COAP_RESOLVE_RETRY_MS       5000
+
+_Static_assert(sizeof(CONFIG_COAP_TELEMETRY_PATH) <= COAP_PATH_MAX, "COAP_TELEMETRY_PATH too long");
+_Static_assert(sizeof(CONFIG_COAP_TIMEREF_PATH) <= COAP_PATH_MAX, "COAP_TIMEREF_PATH too long");
+#if CONFIG_ALARM
+_Static_assert(sizeof(CONFIG_COAP_ALARM_PATH) <= COAP_PATH_MAX, "COAP_ALARM_PATH too long");
+#endif
+
+static const char *TAG = "coap";
+
+typedef enum {
+    COAP_MSG_SAMPLE = 0,
+    COAP_MSG_TIMEREF,
+} coap_msg_kind_t;
+
+typedef struct {
+    uint8_t kind;            // coap_msg_kind_t
+    uint8_t len;
+    uint8_t payload[COAP_PAYLOAD_MAX];
+} coap_msg_t;
+
+static QueueHandle_t g_queue = NULL;
+static int g_sock = -1;
+static uint16_t g_mid;
+#if CONFIG_ALARM
+// 告警走独立套接字（独立的源端口与消息 ID 空间），不与遥测任务争抢 ACK
+static int g_alarm_sock = -1;
+static uint16_t g_alarm_mid;
+#endif
+
+static transport_stats_t g_stats;
+static portMUX_TYPE g_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticQueue_t g_queue_struct;
+static uint8_t g_queue_storage[COAP_QUEUE_LEN * sizeof(coap_msg_t)];
+static StackType_t g_task_stack[COAP_TASK_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+#define STATS_ADD(field, n)                     \
+    do {                                        \
+        portENTER_CRITICAL(&g_stats_lock);      \
+        g_stats.field += (n);                   \
+        portEXIT_CRITICAL(&g_stats_lock);       \
+    } while (0)
+
+// 选项按编号递增排列，delta 与长度小于 13 时直接放在首字节
+static size_t coap_put_option(uint8_t *buf, uint16_t delta, const void *value, size_t len)
+{
+    uint8_t *p = buf + 1;
+    uint8_t d = (delta < 13) ? delta : 13;
+    uint8_t l = (len < 13) ? len : 13;
+    buf[0] = (uint8_t)((d << 4) | l);
+    if (d == 13) {
+        *p++ = (uint8_t)(delta - 13);
+    }
+    if (l == 13) {
+        *p++ = (uint8_t)(len - 13);
+    }
+    memcpy(p, value, len);
+    return (size_t)(p - buf) + len;
+}
+
+static size_t coap_build_post(uint8_t *buf, uint8_t type, uint16_t mid, const char *path, uint8_t format,
+                              const uint8_t *payload, size_t len)
+{
+    uint8_t *p = buf;
+    // Token 长度为 0：CON 的 ACK 按消息 ID 匹配
+    *p++ = (uint8_t)((COAP_VERSION << 6) | (type << 4));
+    *p++ = COAP_CODE_POST;
+    *p++ = (uint8_t)(mid >> 8);
+    *p++ = (uint8_t)mid;
+    p += coap_put_option(p, COAP_OPTION_URI_PATH, path, strlen(path));
+    // 内容格式按最短无符号整数编码，0 即空值
+    p += coap_put_option(p, COAP_OPTION_CONTENT_FORMAT - COAP_OPTION_URI_PATH, &format, format ? 1 : 0);
+    *p++ = COAP_PAYLOAD_MARKER;
+    memcpy(p, payload, len);
+    return (size_t)(p - buf) + len;
+}
+
+// 解析服务器地址并创建已 connect 的 UDP 套接字，失败返回 -1
+static int coap_open_socket(void)
+{
+    const struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_DGRAM,
+    };
+    char port[8];
+    snprintf(port, sizeof(port), "%d", CONFIG_COAP_SERVER_PORT);
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(CONFIG_COAP_SERVER_HOST, port, &hints, &res) != 0 || !res) {
+        ESP_LOGW(TAG, "Cannot resolve %s", CONFIG_COAP_SERVER_HOST);
+        return -1;
+    }
+    int sock = socket(res->ai_family, res->ai_socktype, 0);
+    // connect 后只收该服务器的报文，收发可直接用 send/recv
+    if (sock < 0 || connect(sock, res->ai_addr, res->ai_addrlen) != 0) {
+        ESP_LOGW(TAG, "Socket setup failed: errno %d", errno);
+        if (sock >= 0) {
+            close(sock);
+        }
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    return sock;
+}
+
+static bool coap_send(int sock, const uint8_t *buf, size_t len, size_t app_len)
+{
+    if (send(sock, buf, len, 0) != (ssize_t)len) {
+        return false;
+    }
+    portENTER_CRITICAL(&g_stats_lock);
+    g_stats.messages++;
+    g_stats.app_bytes += app_len;
+    g_stats.wire_bytes += len + COAP_UDP_IP_OVERHEAD;
+    portEXIT_CRITICAL(&g_stats_lock);
+    return true;
+}
+
+// 等待 ACK/RST 直到截止时间；其他报文（迟到的旧 ACK 等）忽略
+static int coap_wait_reply(int sock, uint16_t mid, int64_t deadline_us)
+{
+    uint8_t rx[COAP_MSG_MAX];
+    int64_t now;
+    while ((now = esp_timer_get_time()) < deadline_us) {
+        int64_t wait_us = deadline_us - now;
+        const struct timeval tv = {.tv_sec = wait_us / 1000000, .tv_usec = wait_us % 1000000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        int n = recv(sock, rx, sizeof(rx), 0);
+        if (n < 0) {
+            break;
+        }
+        STATS_ADD(rx_bytes, n + COAP_UDP_IP_OVERHEAD);
+        if (n < COAP_HEADER_SIZE || (rx[0] >> 6) != COAP_VERSION || ((rx[2] << 8) | rx[3]) != mid) {
+            continue;
+        }
+        uint8_t type = (rx[0] >> 4) & 0x03;
+        if (type == COAP_TYPE_ACK || type == COAP_TYPE_RST) {
+            return type;
+        }
+    }
+    return -1;
+}
+
+// CON：ACK_TIMEOUT x [1, 1.5) 起，每次重传超时加倍，max_retransmit 次后放弃；返回是否收到 ACK
+static bool coap_send_confirmable(int sock, const uint8_t *buf, size_t len, size_t app_len, uint16_t mid,
+                                  int max_retransmit)
+{
+    uint32_t timeout_ms = COAP_ACK_TIMEOUT_MS + esp_random() % (COAP_ACK_TIMEOUT_MS / 2);
+    for (int attempt = 0; attempt <= max_retransmit; attempt++) {
+        if (attempt) {
+            STATS_ADD(retransmits, 1);
+        }
+        if (coap_send(sock, buf, len, app_len)) {
+            int reply = coap_wait_reply(sock, mid, esp_timer_get_time() + (int64_t)timeout_ms * 1000);
+            if (reply == COAP_TYPE_ACK) {
+                STATS_ADD(acked, 1);
+                return true;
+            }
+            if (reply == COAP_TYPE_RST) {
+                ESP_LOGW(TAG, "Server reset message %u", mid);
+                break;
+            }
+        }
+        timeout_ms *= 2;
+    }
+    STATS_ADD(dropped, 1);
+    return false;
+}
+
+static void coap_task(void *pvParameters)
+{
+    while ((g_sock = coap_open_socket()) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(COAP_RESOLVE_RETRY_MS));
+    }
+    ESP_LOGI(TAG, "Sending to coap://%s:%d (" COAP_SEND_TYPE_NAME ")", CONFIG_COAP_SERVER_HOST,
+             CONFIG_COAP_SERVER_PORT);
+
+    coap_msg_t msg;
+    uint8_t buf[COAP_MSG_MAX];
+    g_mid = (uint16_t)esp_random();
+    while (1) {
+        xQueueReceive(g_queue, &msg, portMAX_DELAY);
+        bool sample = msg.kind == COAP_MSG_SAMPLE;
+        uint16_t mid = g_mid++;
+        size_t len = coap_build_post(buf, COAP_SEND_TYPE, mid, sample ? CONFIG_COAP_TELEMETRY_PATH : CONFIG_COAP_TIMEREF_PATH,
+                                     sample ? COAP_FORMAT_OCTET_STREAM : COAP_FORMAT_TEXT, msg.payload, msg.len);
+        if (COAP_SEND_TYPE == COAP_TYPE_CON) {
+            coap_send_confirmable(g_sock, buf, len, msg.len, mid, COAP_MAX_RETRANSMIT);
+        } else if (!coap_send(g_sock, buf, len, msg.len)) {
+            STATS_ADD(dropped, 1);
+        }
+    }
+}
+
+static void coap_enqueue(const coap_msg_t *msg)
+{
+    if (!g_queue || xQueueSend(g_queue, msg, 0) != pdTRUE) {
+        STATS_ADD(dropped, 1);
+    }
+}
+
+void coap_device_publish_sample(const sensor_sample_t *sample)
+{
+    coap_msg_t msg = {.kind = COAP_MSG_SAMPLE};
+    msg.len = (uint8_t)sensor_sample_encode(sample, msg.payload, sizeof(msg.payload));
+    coap_enqueue(&msg);
+}
+
+void coap_device_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb)
+{
+    coap_msg_t msg = {.kind = COAP_MSG_TIMEREF};
+    int len = snprintf((char *)msg.payload, sizeof(msg.payload), "%" PRIu32 ",%" PRId64 ",%" PRId32, boot_ms, utc_ms,
+                       drift_ppb);
+    msg.len = (uint8_t)MIN(len, (int)sizeof(msg.payload) - 1);
+    coap_enqueue(&msg);
+}
+
+#if CONFIG_ALARM
+bool coap_device_send_alarm(const char *text, size_t len)
+{
+    if (g_alarm_sock < 0) {
+        g_alarm_sock = coap_open_socket();
+        if (g_alarm_sock < 0) {
+            STATS_ADD(dropped, 1);
+            return false;
+        }
+        g_alarm_mid = (uint16_t)esp_random();
+    }
+    uint8_t buf[COAP_MSG_MAX];
+    len = MIN(len, COAP_PAYLOAD_MAX);
+    uint16_t mid = g_alarm_mid++;
+    size_t n = coap_build_post(buf, COAP_TYPE_CON, mid, CONFIG_COAP_ALARM_PATH, COAP_FORMAT_TEXT,
+                               (const uint8_t *)text, len);
+    return coap_send_confirmable(g_alarm_sock, buf, n, len, mid, COAP_ALARM_MAX_RETRANSMIT);
+}
+#endif
+
+void coap_device_get_stats(transport_stats_t *out)
+{
+    portENTER_CRITICAL(&g_stats_lock);
+    *out = g_stats;
+    portEXIT_CRITICAL(&g_stats_lock);
+}
+
+void coap_device_start(void)
+{
+#if CONFIG_STATIC_ALLOCATION
+    g_queue = xQueueCreateStatic(COAP_QUEUE_LEN, sizeof(coap_msg_t), g_queue_storage, &g_queue_struct);
+#else
+    g_queue = xQueueCreate(COAP_QUEUE_LEN, sizeof(coap_msg_t));
+#endif
+
+    // lwIP 在调用者任务中为每个报文分配 pbuf，本任务不纳入稳态零分配检查
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(coap_task, "coap_task", COAP_TASK_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                                         g_task_stack, &g_task_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(coap_task, "coap_task", COAP_TASK_STACK_SIZE, NULL, TASK_PRIO_AUX, &task, TASK_CORE_AUX);
+#endif
+    mem_profiler_register_task(task, COAP_TASK_STACK_SIZE);
+}
+
+#endif // CONFIG_TELEMETRY_COAP
@@ -0,0 +1,50 @@
+#ifndef __COAP_DEVICE_H__
+#define __COAP_DEVICE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sensor.h"
+#include "transport_stats.h"
+
+/**
+ * CoAP over UDP 遥测（RFC 7252 的最小子集）
+ *
+ * 每个样本一个 POST 请求，负载与 MQTT 相同（sensor_sample_encode 的 12 字节），
+ * Token 为空，选项只有 Uri-Path 与 Content-Format。无 TCP 会话、保活与重连握手。
+ * 可选 NON（发出即忘）或 CON（等待 ACK，按 RFC 的 ACK_TIMEOUT 指数退避重传）。
+ * 发布接口只入队，由独立任务发送，不阻塞发布流水线。
+ */
+
+#if CONFIG_TELEMETRY_COAP
+
+void coap_device_start(void);
+
+void coap_device_publish_sample(const sensor_sample_t *sample);
+
+// 负载与 MQTT 时间参考主题相同："boot_ms,utc_ms,drift_ppb"
+void coap_device_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb);
+
+void coap_device_get_stats(transport_stats_t *out);
+
+#if CONFIG_ALARM
+/**
+ * @brief 在调用者任务中同步发送一条告警（CON，文本负载），不经过遥测队列
+ *
+ * 使用独立套接字，遥测任务正在等待 ACK 或重传时也能立即发出。只重传一次，最坏约 9 s
+ * 返回，避免一条告警长时间挡住告警任务里后续的状态变化。
+ * @return 收到 ACK 返回 true；无法解析服务器或重传耗尽返回 false
+ */
+bool coap_device_send_alarm(const char *text, size_t len);
+#endif
+
+#else
+
+static inline void coap_device_start(void) {}
+static inline void coap_device_publish_sample(const sensor_sample_t *sample) {}
+static inline void coap_device_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb) {}
+static inline void coap_device_get_stats(transport_stats_t *out) {}
+
+#endif // CONFIG_TELEMETRY_COAP
+
+#endif // __COAP_DEVICE_H__
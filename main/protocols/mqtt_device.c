@@ -14,6 +14,10 @@
 #include <string.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_system.h"
 #include "nvs_flash.h"
 #include "esp_event.h"
@@ -21,12 +25,132 @@
 // #include "protocol_examples_common.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "mqtt_client.h"
+#if CONFIG_MQTT_TLS_SESSION_TICKETS
+#include "esp_transport_ssl.h"
+#endif
 #include "mqtt_device.h"
+#include "history_export.h"
+#include "device_control.h"
+#include "cpu_profiler.h"
+#include "mem_profiler.h"
+#include "task_config.h"
 
 
 static const char *TAG = "mqtt";
 
+#define MQTT_TCP_IP_OVERHEAD    40      // IPv4 20 + TCP 20
+#define MQTT_PUBACK_SIZE        4
+#define MQTT_SEND_QUEUE_LEN     8
+#define MQTT_SEND_PAYLOAD_MAX   64
+#define MQTT_SEND_STACK_SIZE    3072
+
+// QoS 1 的短消息：调用者只入队，由发送任务发布。QoS 1 发布会在调用者任务中把消息复制进
+// esp-mqtt 的 outbox，集中到一个不受零分配检查的任务里，传感器任务因此不在稳态分配内存
+typedef struct {
+    const char *topic;      // Kconfig 主题常量
+    uint8_t len;
+    char payload[MQTT_SEND_PAYLOAD_MAX];
+} mqtt_send_msg_t;
+
+static esp_mqtt_client_handle_t s_client = NULL;
+static volatile bool s_connected = false;
+static QueueHandle_t s_send_queue = NULL;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticQueue_t s_send_queue_struct;
+static uint8_t s_send_queue_storage[MQTT_SEND_QUEUE_LEN * sizeof(mqtt_send_msg_t)];
+static StackType_t s_send_task_stack[MQTT_SEND_STACK_SIZE];
+static StaticTask_t s_send_task_tcb;
+#endif
+
+static transport_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static mqtt_reconnect_stats_t s_reconnect;
+static int64_t s_attempt_us = 0;       // 本次连接尝试开始（TCP/TLS 握手之前）
+static int64_t s_disconnected_us = 0;  // 上次断开时刻，0 表示尚未连上过
+
+// 最近一次时间参考点；对时通常早于连上 broker，每次连接后重发
+static struct {
+    bool valid;
+    uint32_t boot_ms;
+    int64_t utc_ms;
+    int32_t drift_ppb;
+} s_timeref;
+
+#if CONFIG_MQTT_BROKER_CA_EMBEDDED
+extern const char broker_ca_pem_start[] asm("_binary_broker_ca_pem_start");
+extern const char broker_ca_pem_end[] asm("_binary_broker_ca_pem_end");
+#endif
+
+// 按 PUBLISH 报文格式估算长度：固定头 + 剩余长度 + 主题 + 报文 ID（QoS > 0）+ 负载
+static void mqtt_count_publish(const char *topic, size_t len, int qos, int msg_id)
+{
+    size_t remaining = 2 + strlen(topic) + (qos ? 2 : 0) + len;
+    size_t wire = 1 + (remaining < 128 ? 1 : remaining < 16384 ? 2 : 3) + remaining + MQTT_TCP_IP_OVERHEAD;
+    portENTER_CRITICAL(&s_stats_lock);
+    if (msg_id < 0) {
+        s_stats.dropped++;
+    } else {
+        s_stats.messages++;
+        s_stats.app_bytes += len;
+        s_stats.wire_bytes += wire;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void mqtt_count_dropped(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.dropped++;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// 不阻塞；队列满或发送任务未启动时丢弃并计数
+static void mqtt_send_enqueue(const char *topic, const char *payload, int len)
+{
+    mqtt_send_msg_t msg = {.topic = topic};
+    msg.len = (uint8_t)MIN(MAX(len, 0), MQTT_SEND_PAYLOAD_MAX);
+    memcpy(msg.payload, payload, msg.len);
+    if (!s_send_queue || xQueueSend(s_send_queue, &msg, 0) != pdTRUE) {
+        mqtt_count_dropped();
+    }
+}
+
+static void mqtt_send_task(void *pvParameters)
+{
+    mqtt_send_msg_t msg;
+    while (1) {
+        xQueueReceive(s_send_queue, &msg, portMAX_DELAY);
+        // 断线时 esp-mqtt 把 QoS 1 消息留在 outbox，重连后发送
+        int msg_id = esp_mqtt_client_publish(s_client, msg.topic, msg.payload, msg.len, 1, 1);
+        mqtt_count_publish(msg.topic, msg.len, 1, msg_id);
+    }
+}
+
+
+// 记录一次连接完成：握手耗时从 BEFORE_CONNECT 算起（含 TCP、TLS 与 CONNECT/CONNACK），
+// 中断时长从上次断开算起（含重连等待）
+static void mqtt_note_connected(bool session_present)
+{
+    int64_t now_us = esp_timer_get_time();
+    uint32_t connect_ms = s_attempt_us ? (uint32_t)((now_us - s_attempt_us) / 1000) : 0;
+    uint32_t outage_ms = s_disconnected_us ? (uint32_t)((now_us - s_disconnected_us) / 1000) : 0;
+    portENTER_CRITICAL(&s_stats_lock);
+    s_reconnect.connects++;
+    if (session_present) {
+        s_reconnect.sessions_resumed++;
+    }
+    s_reconnect.last_connect_ms = connect_ms;
+    if (connect_ms > s_reconnect.max_connect_ms) {
+        s_reconnect.max_connect_ms = connect_ms;
+    }
+    s_reconnect.last_outage_ms = outage_ms;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED in %" PRIu32 " ms, outage %" PRIu32 " ms, session %s", connect_ms, outage_ms,
+             session_present ? "resumed" : "new");
+}
 
 static void log_error_if_nonzero(const char *message, int error_code)
 {
@@ -35,6 +159,46 @@ static void log_error_if_nonzero(const char *message, int error_code)
     }
 }
 
+static int mqtt_format_timeref(char *buf, size_t size, uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb)
+{
+    int len = snprintf(buf, size, "%" PRIu32 ",%" PRId64 ",%" PRId32, boot_ms, utc_ms, drift_ppb);
+    return MIN(len, (int)size - 1);
+}
+
+void mqtt_device_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    s_timeref.boot_ms = boot_ms;
+    s_timeref.utc_ms = utc_ms;
+    s_timeref.drift_ppb = drift_ppb;
+    s_timeref.valid = true;
+    portEXIT_CRITICAL(&s_stats_lock);
+    // 调用者是 SNTP 回调，运行在 lwIP tcpip 线程中：在这里写套接字可能与协议栈死锁，
+    // 只交给发送任务；未连接时连上后由 MQTT 任务重发缓存
+    if (s_client && s_connected) {
+        char payload[MQTT_SEND_PAYLOAD_MAX];
+        int len = mqtt_format_timeref(payload, sizeof(payload), boot_ms, utc_ms, drift_ppb);
+        mqtt_send_enqueue(CONFIG_MQTT_TIME_TOPIC, payload, len);
+    }
+}
+
+// 连接后重发缓存的参考点（在 MQTT 任务中）；消息为保留消息，每次连接发一次即可
+static void mqtt_republish_timeref(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    bool valid = s_timeref.valid;
+    uint32_t boot_ms = s_timeref.boot_ms;
+    int64_t utc_ms = s_timeref.utc_ms;
+    int32_t drift_ppb = s_timeref.drift_ppb;
+    portEXIT_CRITICAL(&s_stats_lock);
+    if (valid) {
+        char payload[MQTT_SEND_PAYLOAD_MAX];
+        int len = mqtt_format_timeref(payload, sizeof(payload), boot_ms, utc_ms, drift_ppb);
+        int msg_id = esp_mqtt_client_publish(s_client, CONFIG_MQTT_TIME_TOPIC, payload, len, 1, 1);
+        mqtt_count_publish(CONFIG_MQTT_TIME_TOPIC, len, 1, msg_id);
+    }
+}
+
 /*
  * @brief Event handler registered to receive MQTT events
  *
@@ -50,39 +214,77 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     ESP_LOGD(TAG, "Event dispatched from event loop base=%s, event_id=%" PRIi32 "", base, event_id);
     esp_mqtt_event_handle_t event = event_data;
     esp_mqtt_client_handle_t client = event->client;
-    int msg_id;
     switch ((esp_mqtt_event_id_t)event_id) {
+    case MQTT_EVENT_BEFORE_CONNECT:
+        s_attempt_us = esp_timer_get_time();
+        break;
     case MQTT_EVENT_CONNECTED:
-        ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
-        msg_id = esp_mqtt_client_publish(client, "/topic/qos1", "data_3", 0, 1, 0);
-        ESP_LOGI(TAG, "sent publish successful, msg_id=%d", msg_id);
-
-        msg_id = esp_mqtt_client_subscribe(client, "/topic/qos0", 0);
-        ESP_LOGI(TAG, "sent subscribe successful, msg_id=%d", msg_id);
-
-        msg_id = esp_mqtt_client_subscribe(client, "/topic/qos1", 1);
-        ESP_LOGI(TAG, "sent subscribe successful, msg_id=%d", msg_id);
-
-        msg_id = esp_mqtt_client_unsubscribe(client, "/topic/qos1");
-        ESP_LOGI(TAG, "sent unsubscribe successful, msg_id=%d", msg_id);
+        s_connected = true;
+        mqtt_note_connected(event->session_present);
+        mqtt_republish_timeref();
+        // 持久会话仍在服务器上时订阅也还在，不必重新订阅
+        if (event->session_present) {
+            break;
+        }
+#if CONFIG_HISTORY_EXPORT
+        esp_mqtt_client_subscribe(client, CONFIG_HISTORY_EXPORT_REQUEST_TOPIC, 1);
+#endif
+#if CONFIG_DEVICE_CONTROL
+        esp_mqtt_client_subscribe(client, CONFIG_DEVICE_CONTROL_TOPIC, 1);
+#endif
+#if CONFIG_CPU_PROFILER
+        esp_mqtt_client_subscribe(client, CONFIG_CPU_PROFILER_REQUEST_TOPIC, 1);
+#endif
         break;
     case MQTT_EVENT_DISCONNECTED:
         ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
+        if (s_connected) {
+            s_disconnected_us = esp_timer_get_time();
+        }
+        s_connected = false;
         break;
 
     case MQTT_EVENT_SUBSCRIBED:
         ESP_LOGI(TAG, "MQTT_EVENT_SUBSCRIBED, msg_id=%d", event->msg_id);
-        msg_id = esp_mqtt_client_publish(client, "/topic/qos0", "data", 0, 0, 0);
-        ESP_LOGI(TAG, "sent publish successful, msg_id=%d", msg_id);
         break;
     case MQTT_EVENT_UNSUBSCRIBED:
         ESP_LOGI(TAG, "MQTT_EVENT_UNSUBSCRIBED, msg_id=%d", event->msg_id);
         break;
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.acked++;
+        s_stats.rx_bytes += MQTT_PUBACK_SIZE + MQTT_TCP_IP_OVERHEAD;
+        portEXIT_CRITICAL(&s_stats_lock);
         break;
     case MQTT_EVENT_DATA:
         ESP_LOGI(TAG, "MQTT_EVENT_DATA");
+#if CONFIG_HISTORY_EXPORT
+        if (event->topic_len == strlen(CONFIG_HISTORY_EXPORT_REQUEST_TOPIC) &&
+            memcmp(event->topic, CONFIG_HISTORY_EXPORT_REQUEST_TOPIC, event->topic_len) == 0) {
+            history_export_handle_command(event->data, event->data_len);
+            break;
+        }
+#endif
+#if CONFIG_DEVICE_CONTROL
+        if (event->topic_len == strlen(CONFIG_DEVICE_CONTROL_TOPIC) &&
+            memcmp(event->topic, CONFIG_DEVICE_CONTROL_TOPIC, event->topic_len) == 0) {
+            // 命令很短，分片到达的只可能是异常消息，直接丢弃
+            if (event->current_data_offset == 0 && event->data_len == event->total_data_len) {
+                device_control_handle_command(event->data, event->data_len);
+            } else {
+                ESP_LOGW(TAG, "Fragmented control message dropped (%d bytes)", event->total_data_len);
+            }
+            break;
+        }
+#endif
+#if CONFIG_CPU_PROFILER
+        if (event->topic_len == strlen(CONFIG_CPU_PROFILER_REQUEST_TOPIC) &&
+            memcmp(event->topic, CONFIG_CPU_PROFILER_REQUEST_TOPIC, event->topic_len) == 0) {
+            cpu_profiler_handle_command(event->data, event->data_len);
+            break;
+        }
+#endif
         printf("TOPIC=%.*s\r\n", event->topic_len, event->topic);
         printf("DATA=%.*s\r\n", event->data_len, event->data);
         break;
@@ -107,10 +309,113 @@ void mqtt_task()
     ESP_LOGI(TAG, "Starting MQTT task");
     esp_mqtt_client_config_t mqtt_cfg = {
         .broker.address.uri = CONFIG_BROKER_URL,
+#if CONFIG_MQTT_BROKER_CA_EMBEDDED
+        .broker.verification.certificate = broker_ca_pem_start,
+#endif
+        // 持久会话要求客户端 ID 不变；为空时 esp-mqtt 按 MAC 生成，同样稳定
+        .credentials.client_id = CONFIG_MQTT_CLIENT_ID[0] ? CONFIG_MQTT_CLIENT_ID : NULL,
+#if CONFIG_MQTT_PERSISTENT_SESSION
+        .session.disable_clean_session = true,
+#endif
+        .session.keepalive = CONFIG_MQTT_KEEPALIVE_S,
+        .network.reconnect_timeout_ms = CONFIG_MQTT_RECONNECT_TIMEOUT_MS,
+        // 断线期间 QoS 1 消息存在 outbox 中，限制其占用的内存
+        .outbox.limit = CONFIG_MQTT_OUTBOX_LIMIT_KB * 1024,
     };
+#if CONFIG_MQTT_TLS_SESSION_TICKETS
+    // esp-mqtt 不直接暴露会话票据选项，自建 SSL 传输层并开启；
+    // 传输层在每次握手后保存会话，重连时据此做简化握手
+    esp_transport_handle_t ssl = esp_transport_ssl_init();
+    esp_transport_ssl_set_cert_data(ssl, broker_ca_pem_start, (int)(broker_ca_pem_end - broker_ca_pem_start));
+    esp_transport_ssl_session_tickets_enable(ssl);
+    esp_transport_set_default_port(ssl, 8883);
+    mqtt_cfg.network.transport = ssl;
+#endif
     esp_mqtt_client_handle_t client = esp_mqtt_client_init(&mqtt_cfg);
+
+    // 发送 outbox 会分配内存，本任务不纳入稳态零分配检查
+    TaskHandle_t send_task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    s_send_queue = xQueueCreateStatic(MQTT_SEND_QUEUE_LEN, sizeof(mqtt_send_msg_t), s_send_queue_storage,
+                                      &s_send_queue_struct);
+    send_task = xTaskCreateStaticPinnedToCore(mqtt_send_task, "mqtt_send", MQTT_SEND_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                                              s_send_task_stack, &s_send_task_tcb, TASK_CORE_AUX);
+#else
+    s_send_queue = xQueueCreate(MQTT_SEND_QUEUE_LEN, sizeof(mqtt_send_msg_t));
+    xTaskCreatePinnedToCore(mqtt_send_task, "mqtt_send", MQTT_SEND_STACK_SIZE, NULL, TASK_PRIO_AUX, &send_task,
+                            TASK_CORE_AUX);
+#endif
+    mem_profiler_register_task(send_task, MQTT_SEND_STACK_SIZE);
+
     /* The last argument may be used to pass data to the event handler, in this example mqtt_event_handler */
     esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
     esp_mqtt_client_start(client);
+    s_client = client;
     ESP_LOGI(TAG, "MQTT task started.");
 }
+
+void mqtt_device_publish_sample(const sensor_sample_t *sample)
+{
+    if (!s_client || !s_connected) {
+        mqtt_count_dropped();
+        return;
+    }
+    uint8_t payload[SENSOR_SAMPLE_ENCODED_SIZE];
+    size_t len = sensor_sample_encode(sample, payload, sizeof(payload));
+    int msg_id = esp_mqtt_client_publish(s_client, CONFIG_MQTT_TELEMETRY_TOPIC, (const char *)payload, (int)len, 0, 0);
+    mqtt_count_publish(CONFIG_MQTT_TELEMETRY_TOPIC, len, 0, msg_id);
+    ESP_LOGD(TAG, "sample %s seq=%u published, msg_id=%d", sensor_id_name(sample->sensor_id), sample->seq, msg_id);
+}
+
+void mqtt_device_publish_health(sensor_id_t id, const char *state, const char *fault, uint32_t recoveries)
+{
+    if (!s_client || !s_connected) {
+        return;
+    }
+    char payload[MQTT_SEND_PAYLOAD_MAX];
+    int len = snprintf(payload, sizeof(payload), "%s,%s,%s,%" PRIu32, sensor_id_name(id), state, fault, recoveries);
+    mqtt_send_enqueue(CONFIG_MQTT_HEALTH_TOPIC, payload, MIN(len, (int)sizeof(payload) - 1));
+}
+
+#if CONFIG_ALARM
+bool mqtt_device_publish_alarm(const char *text, size_t len)
+{
+    if (!s_client) {
+        mqtt_count_dropped();
+        return false;
+    }
+    int msg_id;
+    if (s_connected) {
+        msg_id = esp_mqtt_client_publish(s_client, CONFIG_ALARM_TOPIC, text, (int)len, 1, 1);
+    } else {
+        // 断线期间存入 outbox，重连后由 MQTT 任务补发
+        msg_id = esp_mqtt_client_enqueue(s_client, CONFIG_ALARM_TOPIC, text, (int)len, 1, 1, true);
+    }
+    mqtt_count_publish(CONFIG_ALARM_TOPIC, len, 1, msg_id);
+    return msg_id >= 0;
+}
+#endif
+
+bool mqtt_device_publish_raw(const char *topic, const void *data, size_t len)
+{
+    if (!s_client || !s_connected) {
+        return false;
+    }
+    int msg_id = esp_mqtt_client_publish(s_client, topic, (const char *)data, (int)len, 0, 0);
+    mqtt_count_publish(topic, len, 0, msg_id);
+    return msg_id >= 0;
+}
+
+void mqtt_device_get_stats(transport_stats_t *out)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void mqtt_device_get_reconnect_stats(mqtt_reconnect_stats_t *out)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_reconnect;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
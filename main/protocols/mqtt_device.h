@@ -1,8 +1,45 @@
 #ifndef __MQTT_CLIENT_H__
 #define __MQTT_CLIENT_H__
 
+#include "sensor.h"
+#include "transport_stats.h"
 
 void mqtt_task();
 
+// 以紧凑二进制编码发布一个样本，未连接时直接丢弃
+void mqtt_device_publish_sample(const sensor_sample_t *sample);
+
+// 发布传感器健康状态变化（文本 "sensor,state,fault,recoveries"），保留消息便于新订阅者获取当前状态；
+// 只入队不阻塞，由 MQTT 发送任务以 QoS 1 发布，调用者任务不分配内存
+void mqtt_device_publish_health(sensor_id_t id, const char *state, const char *fault, uint32_t recoveries);
+
+// 发布时间参考点（文本 "boot_ms,utc_ms,drift_ppb"），保留消息；
+// 服务端据此把样本中的开机毫秒时间戳换算为 UTC，样本本身无需携带墙钟时间。
+// 只缓存并入队，不阻塞，可在 lwIP tcpip 线程（SNTP 回调）中调用；由 MQTT 发送任务发布，
+// 未连接时只缓存，连上 broker 后发送最近一次的参考点
+void mqtt_device_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb);
+
+#if CONFIG_ALARM
+// 直接在调用者任务中以 QoS 1 发布告警（保留消息），不经过遥测路径；断线时存入 outbox 待重连后发送
+bool mqtt_device_publish_alarm(const char *text, size_t len);
+#endif
+
+// 以 QoS 0 发布任意负载，未连接或发送失败时返回 false
+bool mqtt_device_publish_raw(const char *topic, const void *data, size_t len);
+
+// 发布开销统计，口径见 transport_stats.h
+void mqtt_device_get_stats(transport_stats_t *out);
+
+// 连接统计；握手字节数在 TLS 栈内部无法计数，需在服务端或中继上测量（tools/simulator/mqtt_relay.py）
+typedef struct {
+    uint32_t connects;          // 成功连接次数（含首次）
+    uint32_t sessions_resumed;  // CONNACK 带 session present 的次数
+    uint32_t last_connect_ms;   // 最近一次握手耗时：TCP + TLS + CONNECT/CONNACK
+    uint32_t max_connect_ms;
+    uint32_t last_outage_ms;    // 最近一次从断开到重新连上的时长
+} mqtt_reconnect_stats_t;
+
+void mqtt_device_get_reconnect_stats(mqtt_reconnect_stats_t *out);
+
 
 #endif // __MQTT_CLIENT_H__
@@ -0,0 +1,121 @@
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "telemetry.h"
+#include "alloc_guard.h"
+#include "mem_profiler.h"
+#include "task_config.h"
+#if CONFIG_LWIP_STATS
+#include "lwip/stats.h"
+#endif
+
+static const char *TAG = "telemetry";
+
+static size_t g_heap_before_start;
+static size_t g_heap_after_start;
+
+#if CONFIG_TELEMETRY_BENCH
+
+#define TELEMETRY_BENCH_STACK_SIZE  2560
+#define TELEMETRY_BENCH_PERIOD_MS   60000
+
+#if CONFIG_TELEMETRY_COAP && CONFIG_COAP_CONFIRMABLE
+#define TELEMETRY_NAME  "coap-con"
+#elif CONFIG_TELEMETRY_COAP
+#define TELEMETRY_NAME  "coap-non"
+#else
+#define TELEMETRY_NAME  "mqtt"
+#endif
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_bench_stack[TELEMETRY_BENCH_STACK_SIZE];
+static StaticTask_t g_bench_tcb;
+#endif
+
+static void telemetry_bench_task(void *pvParameters)
+{
+    transport_stats_t prev = {0};
+#if CONFIG_LWIP_STATS
+    uint32_t prev_tx = 0, prev_rx = 0;
+#endif
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(TELEMETRY_BENCH_PERIOD_MS));
+        transport_stats_t cur;
+        telemetry_get_stats(&cur);
+
+        // 有 lwIP 统计时用实际收发的帧数，包含 TCP 纯 ACK 与保活；否则按报文数估计
+        uint32_t tx_frames, rx_frames;
+#if CONFIG_LWIP_STATS
+        tx_frames = lwip_stats.link.xmit - prev_tx;
+        rx_frames = lwip_stats.link.recv - prev_rx;
+        prev_tx = lwip_stats.link.xmit;
+        prev_rx = lwip_stats.link.recv;
+#else
+        tx_frames = cur.messages - prev.messages;
+        rx_frames = cur.acked - prev.acked;
+#endif
+        uint32_t frames = tx_frames + rx_frames;
+        uint32_t ip_bytes = (cur.wire_bytes - prev.wire_bytes) + (cur.rx_bytes - prev.rx_bytes);
+        uint32_t air_bytes = ip_bytes + frames * TELEMETRY_FRAME_HDR_BYTES;
+        uint32_t airtime_us = telemetry_airtime_us(frames, ip_bytes);
+        size_t free_now = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+        ESP_LOGI(TAG, "%s/min: %lu msgs (%lu retx, %lu acked, %lu dropped), payload %lu B, IP %lu B, "
+                 "frames %lu tx %lu rx, ~%lu B / ~%lu us on air; heap at start %ld B, now %ld B vs before start",
+                 TELEMETRY_NAME,
+                 (unsigned long)(cur.messages - prev.messages), (unsigned long)(cur.retransmits - prev.retransmits),
+                 (unsigned long)(cur.acked - prev.acked), (unsigned long)(cur.dropped - prev.dropped),
+                 (unsigned long)(cur.app_bytes - prev.app_bytes), (unsigned long)ip_bytes,
+                 (unsigned long)tx_frames, (unsigned long)rx_frames, (unsigned long)air_bytes,
+                 (unsigned long)airtime_us, (long)(g_heap_before_start - g_heap_after_start),
+                 (long)(g_heap_before_start - free_now));
+        prev = cur;
+    }
+}
+
+static void telemetry_bench_start(void)
+{
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(telemetry_bench_task, "telemetry_bench", TELEMETRY_BENCH_STACK_SIZE, NULL,
+                                         TASK_PRIO_AUX, g_bench_stack, &g_bench_tcb, TASK_CORE_AUX);
+#else
+    xTaskCreatePinnedToCore(telemetry_bench_task, "telemetry_bench", TELEMETRY_BENCH_STACK_SIZE, NULL, TASK_PRIO_AUX,
+                            &task, TASK_CORE_AUX);
+#endif
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, TELEMETRY_BENCH_STACK_SIZE);
+}
+
+#endif // CONFIG_TELEMETRY_BENCH
+
+void telemetry_get_stats(transport_stats_t *out)
+{
+#if CONFIG_TELEMETRY_COAP
+    coap_device_get_stats(out);
+#else
+    mqtt_device_get_stats(out);
+#endif
+}
+
+void telemetry_start(void)
+{
+#if !CONFIG_TELEMETRY_MQTT
+    // 健康状态、历史导出、远程控制等只走 MQTT，样本不走 MQTT 时也要启动客户端；
+    // 放在堆测量之前，开销比较只计入样本传输本身
+    mqtt_task();
+#endif
+    g_heap_before_start = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#if CONFIG_TELEMETRY_COAP
+    coap_device_start();
+#elif CONFIG_TELEMETRY_MQTT
+    mqtt_task();
+#endif
+    g_heap_after_start = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    ESP_LOGI(TAG, "Transport start took %ld B of heap", (long)(g_heap_before_start - g_heap_after_start));
+#if CONFIG_TELEMETRY_BENCH
+    telemetry_bench_start();
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sensor.h"
+#include "mqtt_device.h"
+#include "coap_device.h"
+
+/**
+ * 遥测传输选择
+ *
+ * 样本与时间参考点按 CONFIG_TELEMETRY_* 走 MQTT 或 CoAP，负载编码相同；TELEMETRY_OFF 时
+ * 不发布样本，时间参考点仍走 MQTT。告警走同一传输但不排队；健康状态（保留消息）、历史导出、
+ * 远程控制与分析报告只走 MQTT，因此 MQTT 客户端总是启动。
+ */
+
+// 空口时间估算：每帧固定开销（DIFS + 平均退避 + 前导码 + SIFS + ACK）与 802.11 MAC/LLC/FCS/CCMP 头，
+// 载荷按 24 Mbps 计；用于传输之间的相对比较与能耗估算
+#define TELEMETRY_FRAME_FIXED_US    160
+#define TELEMETRY_FRAME_HDR_BYTES   52
+#define TELEMETRY_PHY_MBPS          24
+
+static inline uint32_t telemetry_airtime_us(uint32_t frames, uint32_t ip_bytes)
+{
+    uint32_t air_bytes = ip_bytes + frames * TELEMETRY_FRAME_HDR_BYTES;
+    return frames * TELEMETRY_FRAME_FIXED_US + air_bytes * 8 / TELEMETRY_PHY_MBPS;
+}
+
+/**
+ * @brief 所选传输自启动以来的累计开销统计
+ */
+void telemetry_get_stats(transport_stats_t *out);
+
+/**
+ * @brief 启动 MQTT 客户端与所选传输，需在 Wi-Fi 连接之后调用；记录所选传输启动前后的空闲堆用于开销比较
+ */
+void telemetry_start(void);
+
+static inline void telemetry_publish_sample(const sensor_sample_t *sample)
+{
+#if CONFIG_TELEMETRY_COAP
+    coap_device_publish_sample(sample);
+#elif CONFIG_TELEMETRY_MQTT
+    mqtt_device_publish_sample(sample);
+#endif
+}
+
+static inline void telemetry_publish_timeref(uint32_t boot_ms, int64_t utc_ms, int32_t drift_ppb)
+{
+#if CONFIG_TELEMETRY_COAP
+    coap_device_publish_timeref(boot_ms, utc_ms, drift_ppb);
+#else
+    mqtt_device_publish_timeref(boot_ms, utc_ms, drift_ppb);
+#endif
+}
+
+#if CONFIG_ALARM
+// 告警不经过遥测队列，在调用者任务中同步发出，返回是否已发出（CoAP 为收到 ACK）
+static inline bool telemetry_publish_alarm(const char *text, size_t len)
+{
+#if CONFIG_TELEMETRY_COAP
+    return coap_device_send_alarm(text, len);
+#else
+    return mqtt_device_publish_alarm(text, len);
+#endif
+}
+#endif
+
+#endif // __TELEMETRY_H__
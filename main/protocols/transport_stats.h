@@ -0,0 +1,22 @@
+#ifndef __TRANSPORT_STATS_H__
+#define __TRANSPORT_STATS_H__
+
+#include <stdint.h>
+
+/**
+ * 遥测传输的开销统计，MQTT 与 CoAP 口径相同，便于直接比较
+ *
+ * wire_bytes / rx_bytes 按应用层报文加 IP/TCP 或 IP/UDP 头估算，
+ * 不含 802.11 帧开销，也不含协议栈自发的 TCP 纯 ACK 与保活报文（见 lwIP 帧计数）。
+ */
+typedef struct {
+    uint32_t messages;       // 发出的报文数，含重传
+    uint32_t app_bytes;      // 应用负载字节
+    uint32_t wire_bytes;     // 发出的报文字节（含协议头与 IP 头）
+    uint32_t rx_bytes;       // 收到的确认报文字节（含 IP 头）
+    uint32_t acked;          // 收到确认的消息（MQTT QoS 1 / CoAP CON）
+    uint32_t retransmits;
+    uint32_t dropped;        // 未连接、队列满或重传耗尽而丢弃
+} transport_stats_t;
+
+#endif // __TRANSPORT_STATS_H__
@@ -0,0 +1,233 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sensor.h"
+#include "sensor_channel.h"
+#include "sensor_filter.h"
+#include "sensor_history.h"
+#include "history_store.h"
+#include "history_recent.h"
+#include "protocols/telemetry.h"
+#include "energy_meter.h"
+
+static const char *TAG = "sensor";
+
+// 各通道槽位的最新样本，按列存储（见 sensor_channel.h）；消费任务写入，UI/网络读取。
+// 原始样本与滤波后样本只有值和标志不同，其余字段共用
+static uint32_t g_latest_ts[SENSOR_CH_SLOTS];
+static int32_t  g_latest_value[SENSOR_CH_SLOTS];
+static int32_t  g_latest_raw_value[SENSOR_CH_SLOTS];
+static uint16_t g_latest_seq[SENSOR_CH_SLOTS];
+static uint8_t  g_latest_flags[SENSOR_CH_SLOTS];
+static uint8_t  g_latest_raw_flags[SENSOR_CH_SLOTS];
+static bool     g_latest_valid[SENSOR_CH_SLOTS];
+static portMUX_TYPE g_latest_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 各传感器帧计数，与最新样本共用同一把锁
+static sensor_frame_stats_t g_frame_stats[SENSOR_ID_MAX];
+
+static const char *const g_sensor_names[SENSOR_ID_LOCAL_COUNT] = {
+    [SENSOR_ID_DART]   = "dart",
+    [SENSOR_ID_WINSEN] = "winsen",
+};
+
+// 总线节点按轮询顺序命名，与 Modbus 地址无关
+static const char *const g_bus_node_names[] = {
+    "bus1", "bus2", "bus3", "bus4", "bus5", "bus6", "bus7",
+    "bus8", "bus9", "bus10", "bus11", "bus12", "bus13", "bus14",
+};
+
+_Static_assert(SENSOR_BUS_NODE_COUNT <= sizeof(g_bus_node_names) / sizeof(g_bus_node_names[0]),
+               "missing bus node names");
+
+const char *sensor_id_name(sensor_id_t id)
+{
+    if (id < SENSOR_ID_LOCAL_COUNT) {
+        return g_sensor_names[id];
+    }
+    if (id < SENSOR_ID_AUX_FIRST) {
+        return g_bus_node_names[id - SENSOR_ID_BUS_FIRST];
+    }
+#if CONFIG_SHT4X
+    if (id == SENSOR_ID_SHT4X) {
+        return "sht4x";
+    }
+#endif
+    return "unknown";
+}
+
+void sensor_sample_fill(sensor_sample_t *sample, sensor_id_t id, sensor_channel_t channel,
+                        int32_t value, uint16_t seq, uint8_t flags)
+{
+    sample->timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    sample->value = value;
+    sample->seq = seq;
+    sample->sensor_id = id;
+    sample->channel = channel;
+    sample->flags = flags;
+}
+
+void sensor_publish(const sensor_sample_t *sample)
+{
+    if (sample->sensor_id >= SENSOR_ID_MAX) {
+        ESP_LOGW(TAG, "Drop sample with invalid sensor id %u", sample->sensor_id);
+        return;
+    }
+    int slot = sensor_channel_slot(sample->sensor_id, sample->channel);
+    if (slot < 0) {
+        return;
+    }
+
+    sensor_sample_t filtered = *sample;
+    if (sensor_channel_info(sample->channel)->filtered) {
+        sensor_filter_process(sensor_filter_get(sample->sensor_id), sample, &filtered);
+    }
+
+    portENTER_CRITICAL(&g_latest_lock);
+    g_latest_ts[slot] = sample->timestamp_ms;
+    g_latest_seq[slot] = sample->seq;
+    g_latest_value[slot] = filtered.value;
+    g_latest_flags[slot] = filtered.flags;
+    g_latest_raw_value[slot] = sample->value;
+    g_latest_raw_flags[slot] = sample->flags;
+    g_latest_valid[slot] = true;
+    portEXIT_CRITICAL(&g_latest_lock);
+
+    sensor_history_append(&filtered);
+    history_store_append(&filtered);
+    history_recent_append(&filtered);
+    telemetry_publish_sample(&filtered);
+    energy_meter_note_sample();
+}
+
+static bool get_latest(sensor_id_t id, sensor_channel_t channel, bool raw, sensor_sample_t *out)
+{
+    int slot = sensor_channel_find_slot(id, channel);
+    if (slot < 0) {
+        return false;
+    }
+    portENTER_CRITICAL(&g_latest_lock);
+    bool valid = g_latest_valid[slot];
+    if (valid) {
+        out->timestamp_ms = g_latest_ts[slot];
+        out->value = raw ? g_latest_raw_value[slot] : g_latest_value[slot];
+        out->seq = g_latest_seq[slot];
+        out->flags = raw ? g_latest_raw_flags[slot] : g_latest_flags[slot];
+    }
+    portEXIT_CRITICAL(&g_latest_lock);
+    out->sensor_id = id;
+    out->channel = channel;
+    return valid;
+}
+
+bool sensor_get_latest(sensor_id_t id, sensor_channel_t channel, sensor_sample_t *out)
+{
+    return get_latest(id, channel, false, out);
+}
+
+bool sensor_get_latest_raw(sensor_id_t id, sensor_channel_t channel, sensor_sample_t *out)
+{
+    return get_latest(id, channel, true, out);
+}
+
+void sensor_aggregate_reset(sensor_aggregate_t *agg)
+{
+    agg->sum = 0;
+    agg->min = INT32_MAX;
+    agg->max = INT32_MIN;
+    agg->count = 0;
+    agg->flags = 0;
+}
+
+void sensor_aggregate_add(sensor_aggregate_t *agg, const sensor_sample_t *sample)
+{
+    agg->sum += sample->value;
+    if (sample->value < agg->min) {
+        agg->min = sample->value;
+    }
+    if (sample->value > agg->max) {
+        agg->max = sample->value;
+    }
+    agg->count++;
+    agg->flags |= sample->flags;
+    agg->last = *sample;
+}
+
+uint16_t sensor_aggregate_take(sensor_aggregate_t *agg, sensor_sample_t *out)
+{
+    uint16_t count = agg->count;
+    if (count == 0) {
+        return 0;
+    }
+
+    // 四舍五入的整数均值，负值向零方向对称处理
+    int64_t half = (agg->sum >= 0) ? count / 2 : -(int64_t)(count / 2);
+    *out = agg->last;
+    out->value = (int32_t)((agg->sum + half) / count);
+    out->flags = agg->flags;
+    if (count > 1) {
+        out->flags |= SAMPLE_FLAG_AGGREGATED;
+    }
+
+    if (out->sensor_id < SENSOR_ID_MAX) {
+        portENTER_CRITICAL(&g_latest_lock);
+        sensor_frame_stats_t *st = &g_frame_stats[out->sensor_id];
+        st->last_window_count = count;
+        st->last_window_min = agg->min;
+        st->last_window_max = agg->max;
+        portEXIT_CRITICAL(&g_latest_lock);
+    }
+
+    sensor_aggregate_reset(agg);
+    return count;
+}
+
+void sensor_count_frames(sensor_id_t id, uint32_t received, uint32_t delivered)
+{
+    if (id >= SENSOR_ID_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&g_latest_lock);
+    g_frame_stats[id].frames_received += received;
+    g_frame_stats[id].frames_delivered += delivered;
+    portEXIT_CRITICAL(&g_latest_lock);
+}
+
+bool sensor_get_frame_stats(sensor_id_t id, sensor_frame_stats_t *out)
+{
+    if (id >= SENSOR_ID_MAX) {
+        return false;
+    }
+    portENTER_CRITICAL(&g_latest_lock);
+    *out = g_frame_stats[id];
+    portEXIT_CRITICAL(&g_latest_lock);
+    return true;
+}
+
+static inline void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+size_t sensor_sample_encode(const sensor_sample_t *sample, uint8_t *buf, size_t buf_size)
+{
+    if (buf_size < SENSOR_SAMPLE_ENCODED_SIZE) {
+        return 0;
+    }
+    // | 0..3 时间戳ms | 4..7 定点值 | 8..9 序号 | 10 传感器<<4|通道 | 11 标志 |
+    put_le32(buf, sample->timestamp_ms);
+    put_le32(buf + 4, (uint32_t)sample->value);
+    put_le16(buf + 8, sample->seq);
+    buf[10] = (uint8_t)((sample->sensor_id << 4) | sample->channel);
+    buf[11] = sample->flags;
+    return SENSOR_SAMPLE_ENCODED_SIZE;
+}
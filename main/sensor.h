@@ -2,12 +2,194 @@
 #define __SENSOR_H__
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
 
+// RS-485 总线上的传感器节点数，见 sensor_bus.h
+#if CONFIG_SENSOR_BUS
+#define SENSOR_BUS_NODE_COUNT   CONFIG_SENSOR_BUS_NODE_COUNT
+#else
+#define SENSOR_BUS_NODE_COUNT   0
+#endif
+
+// 辅助传感器（显示总线上的 I2C 温湿度传感器）数量，见 sht4x.h
+#if CONFIG_SHT4X
+#define SENSOR_AUX_COUNT        1
+#else
+#define SENSOR_AUX_COUNT        0
+#endif
+
+// 传感器标识，样本中用4位存储；本地直连传感器在前，总线节点依次排在其后，辅助传感器最后。
+// 辅助传感器不测甲醛，HCHO 通道、告警与远程配置只涉及 SENSOR_ID_AUX_FIRST 之前的传感器
+typedef enum {
+    SENSOR_ID_DART   = 0,
+    SENSOR_ID_WINSEN = 1,
+    SENSOR_ID_BUS_FIRST,
+    SENSOR_ID_AUX_FIRST = SENSOR_ID_BUS_FIRST + SENSOR_BUS_NODE_COUNT,
+    SENSOR_ID_SHT4X = SENSOR_ID_AUX_FIRST,   // 仅 CONFIG_SHT4X 时有效
+    SENSOR_ID_MAX = SENSOR_ID_AUX_FIRST + SENSOR_AUX_COUNT
+} sensor_id_t;
+
+// 本地直连（每个 UART 一个）传感器的数量
+#define SENSOR_ID_LOCAL_COUNT   SENSOR_ID_BUS_FIRST
+
+_Static_assert(SENSOR_ID_MAX <= 16, "sensor_id must fit in 4 bits");
+
+// 测量通道，样本中用4位存储；名称、单位与缩放见 sensor_channel.h
+typedef enum {
+    SENSOR_CH_HCHO = 0,    // 甲醛，定点值单位为 1/SENSOR_HCHO_SCALE ppb
+    SENSOR_CH_CO2,         // 二氧化碳，1/SENSOR_CO2_SCALE ppm
+    SENSOR_CH_PM25,        // PM2.5，1/SENSOR_PM25_SCALE ug/m3
+    SENSOR_CH_TVOC,        // 总挥发性有机物，1/SENSOR_TVOC_SCALE ppb
+    SENSOR_CH_TEMP,        // 温度，1/SENSOR_TEMP_SCALE 摄氏度
+    SENSOR_CH_RH,          // 相对湿度，1/SENSOR_RH_SCALE %RH
+    SENSOR_CH_MAX
+} sensor_channel_t;
+
+_Static_assert(SENSOR_CH_MAX <= 16, "channel must fit in 4 bits");
+
+// 样本质量标志
+#define SAMPLE_FLAG_VALID       (1 << 0)   // 校验通过的有效样本
+#define SAMPLE_FLAG_AUTO        (1 << 1)   // 来自主动上传帧（否则为问答帧）
+#define SAMPLE_FLAG_FILTERED    (1 << 2)   // 值已经过滤波级处理
+#define SAMPLE_FLAG_OUTLIER     (1 << 3)   // 原始值被判定为离群并已替换
+#define SAMPLE_FLAG_DEGRADED    (1 << 4)   // 采样时传感器处于降级状态
+#define SAMPLE_FLAG_WARMING     (1 << 5)   // 采样时传感器仍在预热
+#define SAMPLE_FLAG_AGGREGATED  (1 << 6)   // 值为多帧的均值（见 sensor_aggregate_t）
+
+// 各通道定点缩放：value = 物理量 * SENSOR_<通道>_SCALE
+#define SENSOR_HCHO_SCALE       10
+#define SENSOR_CO2_SCALE        1
+#define SENSOR_PM25_SCALE       10
+#define SENSOR_TVOC_SCALE       1
+#define SENSOR_TEMP_SCALE       100
+#define SENSOR_RH_SCALE         100
+// ppb -> ug/m3 换算系数 1.23，以千分比整数表示
+#define SENSOR_HCHO_UGM3_PER_PPB_X1000  1230
+
+/**
+ * @brief 紧凑的定点样本记录，解析、队列、统计、存储、网络全链路共用
+ *
+ * 12字节、自然对齐，无需 packed。浓度在解析时一次性完成修正与单位换算，
+ * 之后的各环节只做整数运算。
+ */
 typedef struct {
-    float ch2o_ugm3;   // 甲醛浓度，单位：ug/m3
-    float ch2o_ppb;    // 甲醛浓度，单位：ppb
-    uint32_t timestamp; // 时间戳，单位：秒（可用esp_timer_get_time()/1000000）
-    uint32_t count;     // 计数
-} hcho_sensor_data_t;
+    uint32_t timestamp_ms;   // 帧末字节到达时刻，开机以来毫秒；UTC 见 time_sync.h
+    int32_t  value;          // 定点浓度，缩放由 channel 决定
+    uint16_t seq;            // 每个传感器独立递增的序号
+    uint8_t  sensor_id : 4;  // sensor_id_t
+    uint8_t  channel   : 4;  // sensor_channel_t
+    uint8_t  flags;          // SAMPLE_FLAG_*
+} sensor_sample_t;
+
+_Static_assert(sizeof(sensor_sample_t) == 12, "sensor_sample_t must stay 12 bytes");
+
+// 网络/存储使用的编码长度（小端序，与结构体内存布局无关）
+#define SENSOR_SAMPLE_ENCODED_SIZE  12
+
+// 修正系数的有效范围，超出范围的设置被忽略
+#define SENSOR_CORRECTION_MIN   0.1f
+#define SENSOR_CORRECTION_MAX   100.0f
+
+/**
+ * @brief 将浮点修正系数转换为 Q16 定点倒数，仅在配置时调用一次
+ */
+static inline uint32_t sensor_correction_to_q16(float factor)
+{
+    return (uint32_t)(65536.0f / factor + 0.5f);
+}
+
+/**
+ * @brief 对原始读数应用修正系数，返回 HCHO 定点值（纯整数运算）
+ */
+static inline int32_t sensor_hcho_apply_correction(uint32_t raw, uint32_t correction_q16)
+{
+    return (int32_t)(((uint64_t)raw * SENSOR_HCHO_SCALE * correction_q16 + 0x8000) >> 16);
+}
+
+/**
+ * @brief ug/m3 定点值（同样按 SENSOR_HCHO_SCALE 缩放）换算为 ppb 定点值
+ */
+static inline int32_t sensor_hcho_ugm3_to_ppb(int32_t ugm3_scaled)
+{
+    return (ugm3_scaled * 1000 + SENSOR_HCHO_UGM3_PER_PPB_X1000 / 2) / SENSOR_HCHO_UGM3_PER_PPB_X1000;
+}
+
+/**
+ * @brief HCHO 定点值换算为 ug/m3 整数（即 mg/m3 的千分之一），供显示使用
+ */
+static inline int32_t sensor_hcho_to_ugm3(int32_t value)
+{
+    return (value * (SENSOR_HCHO_UGM3_PER_PPB_X1000 / SENSOR_HCHO_SCALE) + 500) / 1000;
+}
+
+/**
+ * @brief 填充样本公共字段（时间戳、传感器、通道、序号）
+ */
+void sensor_sample_fill(sensor_sample_t *sample, sensor_id_t id, sensor_channel_t channel,
+                        int32_t value, uint16_t seq, uint8_t flags);
+
+/**
+ * @brief 发布一个已解析的原始样本：经滤波级处理后更新最新值、追加历史并转发到下游（网络等）
+ */
+void sensor_publish(const sensor_sample_t *sample);
+
+/**
+ * @brief 获取指定传感器某一通道的最新（滤波后）样本
+ * @return false 表示该传感器在此通道上尚无有效样本
+ */
+bool sensor_get_latest(sensor_id_t id, sensor_channel_t channel, sensor_sample_t *out);
+
+/**
+ * @brief 获取指定传感器某一通道的最新原始（未滤波）样本
+ */
+bool sensor_get_latest_raw(sensor_id_t id, sensor_channel_t channel, sensor_sample_t *out);
+
+/**
+ * @brief 将样本编码为固定长度的小端字节序列
+ * @return 写入字节数，缓冲区不足时返回0
+ */
+size_t sensor_sample_encode(const sensor_sample_t *sample, uint8_t *buf, size_t buf_size);
+
+const char *sensor_id_name(sensor_id_t id);
+
+/**
+ * @brief 多帧聚合器：在一个发布窗口内累计 sum/min/max，输出均值样本
+ */
+typedef struct {
+    int64_t  sum;
+    int32_t  min;
+    int32_t  max;
+    uint16_t count;
+    uint8_t  flags;          // 窗口内各帧标志的按位或
+    sensor_sample_t last;    // 窗口内最后一帧，提供时间戳、序号等字段
+} sensor_aggregate_t;
+
+void sensor_aggregate_reset(sensor_aggregate_t *agg);
+
+void sensor_aggregate_add(sensor_aggregate_t *agg, const sensor_sample_t *sample);
+
+/**
+ * @brief 取出窗口均值样本并记录窗口 min/max，随后清空聚合器
+ * @return 窗口内的帧数，0 表示没有可输出的样本
+ */
+uint16_t sensor_aggregate_take(sensor_aggregate_t *agg, sensor_sample_t *out);
+
+// 每个传感器的帧计数：接收（校验通过）与交付（进入发布队列）
+typedef struct {
+    uint32_t frames_received;
+    uint32_t frames_delivered;
+    uint16_t last_window_count;  // 最近一个聚合窗口的帧数
+    int32_t  last_window_min;    // 最近一个聚合窗口的最小值（定点）
+    int32_t  last_window_max;    // 最近一个聚合窗口的最大值（定点）
+} sensor_frame_stats_t;
+
+/**
+ * @brief 累加帧计数，生产任务在每次读取后调用
+ */
+void sensor_count_frames(sensor_id_t id, uint32_t received, uint32_t delivered);
+
+bool sensor_get_frame_stats(sensor_id_t id, sensor_frame_stats_t *out);
 
 #endif // __SENSOR_H__
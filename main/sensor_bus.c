@@ -0,0 +1,328 @@
+#include "sdkconfig.h"
+
+#if CONFIG_SENSOR_BUS
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "sensor.h"
+#include "sensor_bus.h"
+#include "sensor_filter.h"
+#include "sensor_health.h"
+#include "alarm.h"
+#include "energy_meter.h"
+#include "modbus_rtu.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+
+#define BUS_UART_PORT_NUM       CONFIG_SENSOR_BUS_UART_PORT
+#define BUS_UART_BUF_SIZE       256
+#define BUS_REG_COUNT           1       // 每个节点读一个输入寄存器：HCHO 浓度
+#define BUS_RESP_SIZE           MODBUS_RESP_READ_SIZE(BUS_REG_COUNT)
+#define BUS_UART_BYTE_US        (10 * 1000000 / CONFIG_SENSOR_BUS_BAUD_RATE)  // 8N1 每字节传输时间
+#define BUS_UART_RX_TOUT_SYMBOLS 2
+#define BUS_STATS_PERIOD_MS     60000
+#define BUS_POLLER_STACK_SIZE   3072
+#define BUS_CONSUMER_STACK_SIZE 2048
+#define BUS_QUEUE_LEN           (2 * SENSOR_BUS_NODE_COUNT)
+
+static const char *TAG = "sensor_bus";
+
+typedef struct {
+    uint8_t  request[MODBUS_REQ_READ_SIZE];   // 初始化时预先算好 CRC 的请求帧
+    uint8_t  addr;
+    uint16_t seq;
+} bus_node_t;
+
+static bus_node_t g_nodes[SENSOR_BUS_NODE_COUNT];
+static QueueHandle_t g_bus_queue = NULL;
+static uint32_t g_t35_us;
+// 总线最近一次变为空闲（应答末字节到达或超时）的时刻，下一个请求至少在 t3.5 之后发出
+static int64_t g_bus_idle_since_us;
+
+static sensor_bus_stats_t g_stats;
+static portMUX_TYPE g_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_STATIC_ALLOCATION
+static StaticQueue_t g_queue_struct;
+static uint8_t g_queue_storage[BUS_QUEUE_LEN * sizeof(sensor_sample_t)];
+static StackType_t g_poller_stack[BUS_POLLER_STACK_SIZE];
+static StaticTask_t g_poller_tcb;
+static StackType_t g_consumer_stack[BUS_CONSUMER_STACK_SIZE];
+static StaticTask_t g_consumer_tcb;
+#endif
+
+static void bus_uart_init(void)
+{
+    ESP_LOGI(TAG, "Initializing RS-485 bus on UART%d, %d baud, %d nodes", BUS_UART_PORT_NUM,
+             CONFIG_SENSOR_BUS_BAUD_RATE, SENSOR_BUS_NODE_COUNT);
+    const uart_config_t uart_config = {
+        .baud_rate = CONFIG_SENSOR_BUS_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_APB,
+    };
+    uart_driver_install(BUS_UART_PORT_NUM, BUS_UART_BUF_SIZE, BUS_UART_BUF_SIZE, 0, NULL, 0);
+    uart_param_config(BUS_UART_PORT_NUM, &uart_config);
+    // RTS 驱动收发器的 DE/RE，半双工模式下由硬件在发送期间自动拉高
+    uart_set_pin(BUS_UART_PORT_NUM, CONFIG_SENSOR_BUS_TX_PIN, CONFIG_SENSOR_BUS_RX_PIN,
+                 CONFIG_SENSOR_BUS_DE_PIN, UART_PIN_NO_CHANGE);
+    uart_set_mode(BUS_UART_PORT_NUM, UART_MODE_RS485_HALF_DUPLEX);
+    uart_set_rx_timeout(BUS_UART_PORT_NUM, BUS_UART_RX_TOUT_SYMBOLS);
+
+    g_t35_us = modbus_t35_us(CONFIG_SENSOR_BUS_BAUD_RATE);
+    for (int i = 0; i < SENSOR_BUS_NODE_COUNT; i++) {
+        g_nodes[i].addr = (uint8_t)(CONFIG_SENSOR_BUS_FIRST_ADDR + i);
+        modbus_build_read_input(g_nodes[i].addr, CONFIG_SENSOR_BUS_HCHO_REG, BUS_REG_COUNT, g_nodes[i].request);
+    }
+}
+
+// FAILED 节点只在退避到期或刚开始重新应答时轮询，死节点不再每个周期耗掉一个超时
+static bool bus_node_skipped(int i, uint32_t now_ms)
+{
+    const sensor_health_t *h = sensor_health_get(SENSOR_ID_BUS_FIRST + i);
+    return h->state == SENSOR_HEALTH_FAILED && h->consecutive_ok == 0 && !sensor_health_recovery_due(h, now_ms);
+}
+
+// 本周期内 after 之后下一个需要轮询的节点，没有则返回 -1
+static int bus_next_node(int after, uint32_t now_ms)
+{
+    for (int i = after + 1; i < SENSOR_BUS_NODE_COUNT; i++) {
+        if (!bus_node_skipped(i, now_ms)) {
+            return i;
+        }
+        portENTER_CRITICAL(&g_stats_lock);
+        g_stats.skipped++;
+        portEXIT_CRITICAL(&g_stats_lock);
+    }
+    return -1;
+}
+
+static void bus_send_request(int i)
+{
+    // t3.5 帧间隔：整 tick 部分让出 CPU，只有不足一个 tick 的余数忙等
+    const int64_t ready_us = g_bus_idle_since_us + g_t35_us;
+    int64_t wait_us = ready_us - esp_timer_get_time();
+    const int64_t tick_us = (int64_t)portTICK_PERIOD_MS * 1000;
+    // vTaskDelay(n) 在下 n 个 tick 边界返回，可能早于 n 个整 tick，循环到余数不足一个 tick
+    while (wait_us >= tick_us) {
+        vTaskDelay((TickType_t)(wait_us / tick_us));
+        wait_us = ready_us - esp_timer_get_time();
+    }
+    if (wait_us > 0) {
+        esp_rom_delay_us((uint32_t)wait_us);
+    }
+    uart_flush_input(BUS_UART_PORT_NUM);
+    uart_write_bytes(BUS_UART_PORT_NUM, g_nodes[i].request, MODBUS_REQ_READ_SIZE);
+    energy_meter_note_uart(MODBUS_REQ_READ_SIZE, CONFIG_SENSOR_BUS_BAUD_RATE);
+}
+
+/**
+ * @brief 接收一个应答；先读异常应答的长度，再按功能码决定是否读完整帧
+ * @return 收到的字节数，0 表示超时
+ */
+static int bus_receive(uint8_t *buf, int64_t *arrival_us)
+{
+    // 请求发送时间 + 从站处理时间 + 应答传输时间
+    const TickType_t timeout = pdMS_TO_TICKS(CONFIG_SENSOR_BUS_RESPONSE_TIMEOUT_MS +
+                                             (MODBUS_REQ_READ_SIZE + BUS_RESP_SIZE) * BUS_UART_BYTE_US / 1000 + 1);
+    const TickType_t tail_timeout = pdMS_TO_TICKS(BUS_RESP_SIZE * BUS_UART_BYTE_US / 1000 + 2);
+
+    int len = uart_read_bytes(BUS_UART_PORT_NUM, buf, MODBUS_EXCEPTION_SIZE, timeout);
+    if (len == MODBUS_EXCEPTION_SIZE && !(buf[1] & MODBUS_FC_EXCEPTION_BIT)) {
+        int rest = uart_read_bytes(BUS_UART_PORT_NUM, buf + len, BUS_RESP_SIZE - len, tail_timeout);
+        if (rest > 0) {
+            len += rest;
+        }
+    }
+    *arrival_us = esp_timer_get_time();
+    g_bus_idle_since_us = *arrival_us;
+    energy_meter_note_uart((len > 0) ? (size_t)len : 0, CONFIG_SENSOR_BUS_BAUD_RATE);
+    return (len > 0) ? len : 0;
+}
+
+static void bus_handle_response(int i, const uint8_t *resp, int len, int64_t arrival_us)
+{
+    sensor_id_t id = SENSOR_ID_BUS_FIRST + i;
+    sensor_health_t *health = sensor_health_get(id);
+    uint32_t now_ms = (uint32_t)(arrival_us / 1000);
+    bool probing = sensor_health_recovery_due(health, now_ms);
+
+    uint16_t reg = 0;
+    sensor_health_event_t evt;
+    if (len == 0) {
+        evt = SENSOR_EVT_TIMEOUT;
+    } else {
+        switch (modbus_parse_read_response(resp, len, g_nodes[i].addr, &reg, BUS_REG_COUNT)) {
+        case MODBUS_OK:
+            evt = SENSOR_EVT_FRAME_OK;
+            break;
+        case MODBUS_ERR_EXCEPTION:
+        case MODBUS_ERR_FUNC:
+            // 从站在线但不支持该寄存器：配置错误，与其他传感器的模式不符同类处理
+            evt = SENSOR_EVT_WRONG_MODE;
+            break;
+        default:
+            evt = SENSOR_EVT_CHECKSUM;
+            break;
+        }
+    }
+    sensor_health_update(health, evt, now_ms);
+    if (probing) {
+        sensor_health_recovery_done(health, now_ms);
+    }
+
+    portENTER_CRITICAL(&g_stats_lock);
+    g_stats.polls++;
+    if (evt == SENSOR_EVT_FRAME_OK) {
+        g_stats.polls_ok++;
+    } else if (evt == SENSOR_EVT_TIMEOUT) {
+        g_stats.timeouts++;
+    } else {
+        g_stats.errors++;
+    }
+    portEXIT_CRITICAL(&g_stats_lock);
+
+    if (evt != SENSOR_EVT_FRAME_OK) {
+        ESP_LOGD(TAG, "%s (addr %u): %s", sensor_id_name(id), g_nodes[i].addr,
+                 len ? "bad response" : "no response");
+        return;
+    }
+
+    int32_t value = ((int32_t)reg * SENSOR_HCHO_SCALE + CONFIG_SENSOR_BUS_REG_PER_PPB / 2) / CONFIG_SENSOR_BUS_REG_PER_PPB;
+    sensor_sample_t sample;
+    sensor_sample_fill(&sample, id, SENSOR_CH_HCHO, value, ++g_nodes[i].seq,
+                       SAMPLE_FLAG_VALID | sensor_health_sample_flags(health));
+    sample.timestamp_ms = now_ms;
+    alarm_evaluate(&sample);
+    // 不阻塞轮询：发布侧跟不上时丢弃并计数，总线节拍保持不变
+    if (xQueueSend(g_bus_queue, &sample, 0) == pdTRUE) {
+        sensor_count_frames(id, 1, 1);
+    } else {
+        sensor_count_frames(id, 1, 0);
+    }
+}
+
+static void bus_log_stats(uint32_t elapsed_ms)
+{
+    sensor_bus_stats_t st;
+    sensor_bus_get_stats(&st);
+    static uint32_t last_ok = 0;
+    uint32_t ok = st.polls_ok - last_ok;
+    last_ok = st.polls_ok;
+    ESP_LOGI(TAG, "%lu.%02lu sensors/s, polls %lu ok %lu timeout %lu error %lu skipped %lu, bus busy %lu us/cycle",
+             (unsigned long)(ok * 1000UL / elapsed_ms), (unsigned long)(ok * 100000UL / elapsed_ms % 100),
+             (unsigned long)st.polls, (unsigned long)st.polls_ok, (unsigned long)st.timeouts,
+             (unsigned long)st.errors, (unsigned long)st.skipped, (unsigned long)st.busy_us);
+}
+
+static void sensor_bus_poller_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "Sensor bus poller started, t3.5 = %lu us", (unsigned long)g_t35_us);
+    uint32_t start_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    for (int i = 0; i < SENSOR_BUS_NODE_COUNT; i++) {
+        sensor_health_init(sensor_health_get(SENSOR_ID_BUS_FIRST + i), SENSOR_ID_BUS_FIRST + i, start_ms);
+    }
+
+    uint8_t resp[BUS_RESP_SIZE];
+    uint32_t stats_since_ms = start_ms;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        int64_t cycle_start_us = esp_timer_get_time();
+        int cur = bus_next_node(-1, (uint32_t)(cycle_start_us / 1000));
+        if (cur >= 0) {
+            bus_send_request(cur);
+        }
+        while (cur >= 0) {
+            int64_t arrival_us;
+            int len = bus_receive(resp, &arrival_us);
+            // 先发出下一个请求，再处理本次应答：解析、健康监督与入队和下一次总线往返重叠
+            int next = bus_next_node(cur, (uint32_t)(arrival_us / 1000));
+            if (next >= 0) {
+                bus_send_request(next);
+            }
+            bus_handle_response(cur, resp, len, arrival_us);
+            cur = next;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        portENTER_CRITICAL(&g_stats_lock);
+        g_stats.busy_us = (uint32_t)(now_us - cycle_start_us);
+        portEXIT_CRITICAL(&g_stats_lock);
+
+        uint32_t now_ms = (uint32_t)(now_us / 1000);
+        if (now_ms - stats_since_ms >= BUS_STATS_PERIOD_MS) {
+            bus_log_stats(now_ms - stats_since_ms);
+            stats_since_ms = now_ms;
+        }
+
+        // 轮询超过一个周期时不补跑，从当前时刻重新对齐节拍
+        if (xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_SENSOR_BUS_CYCLE_MS)) == pdFALSE) {
+            last_wake = xTaskGetTickCount();
+        }
+    }
+}
+
+static void sensor_bus_consumer_task(void *pvParameters)
+{
+    sensor_sample_t data;
+    while (1) {
+        if (xQueueReceive(g_bus_queue, &data, portMAX_DELAY) == pdTRUE) {
+            sensor_publish(&data);
+        }
+    }
+}
+
+void sensor_bus_get_stats(sensor_bus_stats_t *out)
+{
+    portENTER_CRITICAL(&g_stats_lock);
+    *out = g_stats;
+    portEXIT_CRITICAL(&g_stats_lock);
+}
+
+void sensor_bus_start(void)
+{
+    bus_uart_init();
+
+    sensor_filter_config_t filter_cfg;
+    sensor_filter_default_config(&filter_cfg);
+    for (int i = 0; i < SENSOR_BUS_NODE_COUNT; i++) {
+        sensor_filter_init(sensor_filter_get(SENSOR_ID_BUS_FIRST + i), &filter_cfg);
+    }
+
+    if (!g_bus_queue) {
+#if CONFIG_STATIC_ALLOCATION
+        g_bus_queue = xQueueCreateStatic(BUS_QUEUE_LEN, sizeof(sensor_sample_t), g_queue_storage, &g_queue_struct);
+#else
+        g_bus_queue = xQueueCreate(BUS_QUEUE_LEN, sizeof(sensor_sample_t));
+#endif
+    }
+
+    TaskHandle_t poller = NULL, consumer = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    poller = xTaskCreateStaticPinnedToCore(sensor_bus_poller_task, "sensor_bus_poll_task", BUS_POLLER_STACK_SIZE,
+                                           NULL, TASK_PRIO_SENSOR_PRODUCER, g_poller_stack, &g_poller_tcb,
+                                           TASK_CORE_SENSOR);
+    consumer = xTaskCreateStaticPinnedToCore(sensor_bus_consumer_task, "sensor_bus_consumer_task", BUS_CONSUMER_STACK_SIZE,
+                                             NULL, TASK_PRIO_SENSOR_CONSUMER, g_consumer_stack, &g_consumer_tcb,
+                                             TASK_CORE_SENSOR);
+#else
+    xTaskCreatePinnedToCore(sensor_bus_poller_task, "sensor_bus_poll_task", BUS_POLLER_STACK_SIZE, NULL,
+                            TASK_PRIO_SENSOR_PRODUCER, &poller, TASK_CORE_SENSOR);
+    xTaskCreatePinnedToCore(sensor_bus_consumer_task, "sensor_bus_consumer_task", BUS_CONSUMER_STACK_SIZE, NULL,
+                            TASK_PRIO_SENSOR_CONSUMER, &consumer, TASK_CORE_SENSOR);
+#endif
+    alloc_guard_track_task(poller);
+    alloc_guard_track_task(consumer);
+    mem_profiler_register_task(poller, BUS_POLLER_STACK_SIZE);
+    mem_profiler_register_task(consumer, BUS_CONSUMER_STACK_SIZE);
+}
+
+#endif // CONFIG_SENSOR_BUS
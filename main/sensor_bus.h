@@ -0,0 +1,43 @@
+#ifndef __SENSOR_BUS_H__
+#define __SENSOR_BUS_H__
+
+#include <stdint.h>
+#include "sensor.h"
+
+/**
+ * RS-485 多点总线传感器（Modbus RTU 主站）
+ *
+ * 一个半双工 UART 挂 CONFIG_SENSOR_BUS_NODE_COUNT 个从站，地址从
+ * CONFIG_SENSOR_BUS_FIRST_ADDR 起连续分配，依次映射为 SENSOR_ID_BUS_FIRST 起的传感器标识。
+ * 轮询任务每个周期把所有节点背靠背轮询一遍，请求之间只保留 t3.5 静默；
+ * 收到一个应答后先发出下一个节点的请求，再解析、做健康监督并入队，
+ * 让处理与总线传输重叠。进入 FAILED 的节点按健康监督的指数退避探测，
+ * 不再每个周期耗掉一个应答超时。
+ */
+
+typedef struct {
+    uint32_t polls;          // 发出的请求数
+    uint32_t polls_ok;       // 收到有效应答的请求数
+    uint32_t timeouts;
+    uint32_t errors;         // CRC、地址或异常应答
+    uint32_t skipped;        // 因退避跳过的节点次数
+    uint32_t busy_us;        // 最近一个周期从首个请求到最后一个应答的总线占用时间
+} sensor_bus_stats_t;
+
+#if CONFIG_SENSOR_BUS
+
+/**
+ * @brief 初始化 RS-485 UART 并启动轮询与发布任务
+ */
+void sensor_bus_start(void);
+
+void sensor_bus_get_stats(sensor_bus_stats_t *out);
+
+#else
+
+static inline void sensor_bus_start(void) {}
+static inline void sensor_bus_get_stats(sensor_bus_stats_t *out) { *out = (sensor_bus_stats_t){0}; }
+
+#endif // CONFIG_SENSOR_BUS
+
+#endif // __SENSOR_BUS_H__
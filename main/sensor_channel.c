@@ -0,0 +1,131 @@
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "sensor_channel.h"
+
+static const char *TAG = "sensor_channel";
+
+#define SLOT_NONE       0
+#define SLOT_REJECTED   0xFF
+
+static const sensor_channel_info_t g_channels[SENSOR_CH_MAX] = {
+    [SENSOR_CH_HCHO] = {
+        .name = "hcho", .unit = "ppb", .scale = SENSOR_HCHO_SCALE,
+        .period_ms = CONFIG_SENSOR_CH_HCHO_PERIOD_MS,
+        .slot_base = SENSOR_CH_HCHO_SLOT_BASE, .sources = SENSOR_CH_HCHO_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_HCHO_PERIOD_MS),
+        .history_base = 0,
+        .filtered = true,
+    },
+    [SENSOR_CH_CO2] = {
+        .name = "co2", .unit = "ppm", .scale = SENSOR_CO2_SCALE,
+        .period_ms = CONFIG_SENSOR_CH_CO2_PERIOD_MS,
+        .slot_base = SENSOR_CH_CO2_SLOT_BASE, .sources = SENSOR_CH_CO2_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_CO2_PERIOD_MS),
+        .history_base = SENSOR_CH_HCHO_HISTORY,
+    },
+    [SENSOR_CH_PM25] = {
+        .name = "pm25", .unit = "ug/m3", .scale = SENSOR_PM25_SCALE,
+        .period_ms = CONFIG_SENSOR_CH_PM25_PERIOD_MS,
+        .slot_base = SENSOR_CH_PM25_SLOT_BASE, .sources = SENSOR_CH_PM25_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_PM25_PERIOD_MS),
+        .history_base = SENSOR_CH_HCHO_HISTORY + SENSOR_CH_CO2_HISTORY,
+    },
+    [SENSOR_CH_TVOC] = {
+        .name = "tvoc", .unit = "ppb", .scale = SENSOR_TVOC_SCALE,
+        .period_ms = CONFIG_SENSOR_CH_TVOC_PERIOD_MS,
+        .slot_base = SENSOR_CH_TVOC_SLOT_BASE, .sources = SENSOR_CH_TVOC_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_TVOC_PERIOD_MS),
+        .history_base = SENSOR_CH_HCHO_HISTORY + SENSOR_CH_CO2_HISTORY + SENSOR_CH_PM25_HISTORY,
+    },
+    [SENSOR_CH_TEMP] = {
+        .name = "temp", .unit = "C", .scale = SENSOR_TEMP_SCALE,
+        .period_ms = SENSOR_CH_CLIMATE_PERIOD_MS,
+        .slot_base = SENSOR_CH_TEMP_SLOT_BASE, .sources = SENSOR_CH_TEMP_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(SENSOR_CH_CLIMATE_PERIOD_MS),
+        .history_base = SENSOR_CH_HCHO_HISTORY + SENSOR_CH_CO2_HISTORY + SENSOR_CH_PM25_HISTORY +
+                        SENSOR_CH_TVOC_HISTORY,
+    },
+    [SENSOR_CH_RH] = {
+        .name = "rh", .unit = "%RH", .scale = SENSOR_RH_SCALE,
+        .period_ms = SENSOR_CH_CLIMATE_PERIOD_MS,
+        .slot_base = SENSOR_CH_RH_SLOT_BASE, .sources = SENSOR_CH_RH_SOURCES,
+        .history_points = SENSOR_CH_HISTORY_POINTS(SENSOR_CH_CLIMATE_PERIOD_MS),
+        .history_base = SENSOR_CH_HCHO_HISTORY + SENSOR_CH_CO2_HISTORY + SENSOR_CH_PM25_HISTORY +
+                        SENSOR_CH_TVOC_HISTORY + SENSOR_CH_TEMP_HISTORY,
+    },
+};
+
+// (传感器, 通道) -> 槽位 + 1；分配后不再改变，读取无需加锁
+static volatile uint8_t g_slot_of[SENSOR_CH_MAX][SENSOR_ID_MAX];
+static uint8_t g_slot_sensor[SENSOR_CH_SLOTS];
+static uint8_t g_slot_used[SENSOR_CH_MAX];
+static portMUX_TYPE g_slot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const sensor_channel_info_t *sensor_channel_info(sensor_channel_t channel)
+{
+    return (channel < SENSOR_CH_MAX) ? &g_channels[channel] : NULL;
+}
+
+int sensor_channel_find_slot(sensor_id_t id, sensor_channel_t channel)
+{
+    if (id >= SENSOR_ID_MAX || channel >= SENSOR_CH_MAX) {
+        return -1;
+    }
+    uint8_t v = g_slot_of[channel][id];
+    return (v == SLOT_NONE || v == SLOT_REJECTED) ? -1 : v - 1;
+}
+
+int sensor_channel_slot(sensor_id_t id, sensor_channel_t channel)
+{
+    if (id >= SENSOR_ID_MAX || channel >= SENSOR_CH_MAX) {
+        return -1;
+    }
+    uint8_t v = g_slot_of[channel][id];
+    if (v != SLOT_NONE) {
+        return (v == SLOT_REJECTED) ? -1 : v - 1;
+    }
+
+    const sensor_channel_info_t *info = &g_channels[channel];
+    bool assigned = false;
+    portENTER_CRITICAL(&g_slot_lock);
+    v = g_slot_of[channel][id];
+    if (v == SLOT_NONE) {
+        if (g_slot_used[channel] < info->sources) {
+            uint8_t slot = info->slot_base + g_slot_used[channel]++;
+            g_slot_sensor[slot] = id;
+            v = slot + 1;
+        } else {
+            v = SLOT_REJECTED;
+        }
+        g_slot_of[channel][id] = v;
+        assigned = true;
+    }
+    portEXIT_CRITICAL(&g_slot_lock);
+
+    if (assigned && v == SLOT_REJECTED) {
+        ESP_LOGW(TAG, "No %s slot for %s (%u configured), samples dropped", info->name, sensor_id_name(id),
+                 info->sources);
+    } else if (assigned) {
+        ESP_LOGI(TAG, "%s/%s -> slot %u", sensor_id_name(id), info->name, v - 1);
+    }
+    return (v == SLOT_REJECTED) ? -1 : v - 1;
+}
+
+bool sensor_channel_slot_source(int slot, sensor_id_t *id, sensor_channel_t *channel)
+{
+    if (slot < 0 || slot >= SENSOR_CH_SLOTS) {
+        return false;
+    }
+    for (int ch = SENSOR_CH_MAX - 1; ch >= 0; ch--) {
+        const sensor_channel_info_t *info = &g_channels[ch];
+        if (slot >= info->slot_base) {
+            if (slot - info->slot_base >= g_slot_used[ch]) {
+                return false;
+            }
+            *id = (sensor_id_t)g_slot_sensor[slot];
+            *channel = (sensor_channel_t)ch;
+            return true;
+        }
+    }
+    return false;
+}
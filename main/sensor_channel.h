@@ -0,0 +1,109 @@
+#ifndef __SENSOR_CHANNEL_H__
+#define __SENSOR_CHANNEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/param.h>
+#include "sensor.h"
+
+/**
+ * 测量通道模型
+ *
+ * 每个通道描述一种被测量：名称、定点值的单位与缩放、标称采样间隔。样本以 (sensor_id, channel)
+ * 标识来源；最新值、RAM 历史与长期存储的汇总状态都按"通道槽位"分配：每个通道在 Kconfig 中
+ * 预留若干来源槽位，传感器首次发布该通道的样本时占用一个。各模块把状态存为按槽位下标的列，
+ * 同一通道的槽位连续，处理一个通道只触及各列中属于它的区间。
+ *
+ * 没有来源的通道不占内存；RAM 历史每个槽位的点数按通道采样间隔裁剪（见
+ * SENSOR_CH_HISTORY_POINTS），慢速通道基本不为必然为空的时间桶付出内存。
+ */
+
+// RAM 历史覆盖的时间与最大点数，见 sensor_history.h
+#define SENSOR_HISTORY_POINTS       CONFIG_SENSOR_HISTORY_POINTS
+#define SENSOR_HISTORY_SPAN_MS      ((uint32_t)CONFIG_SENSOR_HISTORY_SPAN_S * 1000)
+#define SENSOR_HISTORY_MIN_POINTS   8
+
+// 标称采样间隔为 period_ms 的通道每个槽位的历史点数：时间桶不短于采样间隔，但至少保留
+// SENSOR_HISTORY_MIN_POINTS 个点，趋势图才画得出形状。采样间隔长于 SPAN / MIN_POINTS 的
+// 通道因此时间桶短于采样间隔，部分桶必然为空（SENSOR_HISTORY_GAP）
+#define SENSOR_CH_HISTORY_POINTS(period_ms) \
+    MAX(SENSOR_HISTORY_MIN_POINTS, MIN(SENSOR_HISTORY_POINTS, SENSOR_HISTORY_SPAN_MS / (period_ms)))
+
+// 各通道的来源槽位数；HCHO 由本地与总线传感器提供，温湿度只由 SHT4x 提供
+#define SENSOR_CH_HCHO_SOURCES      SENSOR_ID_AUX_FIRST
+#define SENSOR_CH_CO2_SOURCES       CONFIG_SENSOR_CH_CO2_SOURCES
+#define SENSOR_CH_PM25_SOURCES      CONFIG_SENSOR_CH_PM25_SOURCES
+#define SENSOR_CH_TVOC_SOURCES      CONFIG_SENSOR_CH_TVOC_SOURCES
+#if CONFIG_SHT4X
+#define SENSOR_CH_TEMP_SOURCES      1
+#define SENSOR_CH_CLIMATE_PERIOD_MS CONFIG_SHT4X_PERIOD_MS
+#else
+#define SENSOR_CH_TEMP_SOURCES      0
+#define SENSOR_CH_CLIMATE_PERIOD_MS 1000
+#endif
+#define SENSOR_CH_RH_SOURCES        SENSOR_CH_TEMP_SOURCES
+
+#define SENSOR_CH_HCHO_SLOT_BASE    0
+#define SENSOR_CH_CO2_SLOT_BASE     (SENSOR_CH_HCHO_SLOT_BASE + SENSOR_CH_HCHO_SOURCES)
+#define SENSOR_CH_PM25_SLOT_BASE    (SENSOR_CH_CO2_SLOT_BASE + SENSOR_CH_CO2_SOURCES)
+#define SENSOR_CH_TVOC_SLOT_BASE    (SENSOR_CH_PM25_SLOT_BASE + SENSOR_CH_PM25_SOURCES)
+#define SENSOR_CH_TEMP_SLOT_BASE    (SENSOR_CH_TVOC_SLOT_BASE + SENSOR_CH_TVOC_SOURCES)
+#define SENSOR_CH_RH_SLOT_BASE      (SENSOR_CH_TEMP_SLOT_BASE + SENSOR_CH_TEMP_SOURCES)
+// 所有通道的槽位总数，各模块按此分配列
+#define SENSOR_CH_SLOTS             (SENSOR_CH_RH_SLOT_BASE + SENSOR_CH_RH_SOURCES)
+
+#define SENSOR_CH_HCHO_HISTORY      (SENSOR_CH_HCHO_SOURCES * SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_HCHO_PERIOD_MS))
+#define SENSOR_CH_CO2_HISTORY       (SENSOR_CH_CO2_SOURCES * SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_CO2_PERIOD_MS))
+#define SENSOR_CH_PM25_HISTORY      (SENSOR_CH_PM25_SOURCES * SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_PM25_PERIOD_MS))
+#define SENSOR_CH_TVOC_HISTORY      (SENSOR_CH_TVOC_SOURCES * SENSOR_CH_HISTORY_POINTS(CONFIG_SENSOR_CH_TVOC_PERIOD_MS))
+#define SENSOR_CH_TEMP_HISTORY      (SENSOR_CH_TEMP_SOURCES * SENSOR_CH_HISTORY_POINTS(SENSOR_CH_CLIMATE_PERIOD_MS))
+#define SENSOR_CH_RH_HISTORY        (SENSOR_CH_RH_SOURCES * SENSOR_CH_HISTORY_POINTS(SENSOR_CH_CLIMATE_PERIOD_MS))
+// RAM 历史点列的总长度
+#define SENSOR_CH_HISTORY_TOTAL                                                                \
+    (SENSOR_CH_HCHO_HISTORY + SENSOR_CH_CO2_HISTORY + SENSOR_CH_PM25_HISTORY + SENSOR_CH_TVOC_HISTORY + \
+     SENSOR_CH_TEMP_HISTORY + SENSOR_CH_RH_HISTORY)
+
+_Static_assert(SENSOR_CH_SLOTS < UINT8_MAX, "channel slots must fit in uint8_t");
+
+typedef struct {
+    const char *name;           // 通道名，用于日志与遥测
+    const char *unit;           // 物理量单位
+    int32_t  scale;             // 定点值 = 物理量 * scale
+    uint32_t period_ms;         // 标称采样间隔
+    uint8_t  slot_base;         // 第一个槽位
+    uint8_t  sources;           // 槽位数，0 表示未启用
+    uint16_t history_points;    // 每个槽位的 RAM 历史点数
+    uint32_t history_base;      // 第一个槽位在历史点列中的起点
+    bool     filtered;          // 是否经过滤波级（滤波器按传感器分配，每个传感器至多一个通道）
+} sensor_channel_info_t;
+
+/**
+ * @return 通道描述，channel 无效时返回 NULL
+ */
+const sensor_channel_info_t *sensor_channel_info(sensor_channel_t channel);
+
+static inline const char *sensor_channel_name(sensor_channel_t channel)
+{
+    const sensor_channel_info_t *info = sensor_channel_info(channel);
+    return info ? info->name : "unknown";
+}
+
+/**
+ * @brief 取得 (传感器, 通道) 的槽位，首次调用时分配，可在任意任务中调用
+ * @return 槽位下标，通道未启用或槽位已满时返回 -1（只记录一次日志）
+ */
+int sensor_channel_slot(sensor_id_t id, sensor_channel_t channel);
+
+/**
+ * @brief 只查询不分配
+ * @return 槽位下标，该传感器尚未发布过此通道时返回 -1
+ */
+int sensor_channel_find_slot(sensor_id_t id, sensor_channel_t channel);
+
+/**
+ * @brief 槽位的所属传感器与通道
+ * @return false 表示槽位尚未分配
+ */
+bool sensor_channel_slot_source(int slot, sensor_id_t *id, sensor_channel_t *channel);
+
+#endif // __SENSOR_CHANNEL_H__
@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sensor_filter.h"
+
+static const char *TAG = "sensor_filter";
+
+static sensor_filter_t g_filters[SENSOR_ID_MAX];
+// 保护各滤波器的暂存配置
+static portMUX_TYPE g_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void sensor_filter_default_config(sensor_filter_config_t *cfg)
+{
+    cfg->window = CONFIG_SENSOR_FILTER_WINDOW;
+    cfg->hampel_k_x10 = CONFIG_SENSOR_FILTER_HAMPEL_K_X10;
+    cfg->ema_alpha_q8 = CONFIG_SENSOR_FILTER_EMA_ALPHA_Q8;
+    cfg->min_deviation = CONFIG_SENSOR_FILTER_MIN_DEVIATION_PPB * SENSOR_HCHO_SCALE;
+}
+
+sensor_filter_t *sensor_filter_get(sensor_id_t id)
+{
+    return (id < SENSOR_ID_MAX) ? &g_filters[id] : NULL;
+}
+
+static void normalize_config(sensor_filter_config_t *cfg)
+{
+    if (cfg->window > SENSOR_FILTER_MAX_WINDOW) {
+        cfg->window = SENSOR_FILTER_MAX_WINDOW;
+    }
+    if (cfg->window > 0 && cfg->window < 3) {
+        cfg->window = 3;
+    }
+}
+
+void sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *cfg)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->cfg = *cfg;
+    normalize_config(&filter->cfg);
+}
+
+void sensor_filter_set_config(sensor_filter_t *filter, const sensor_filter_config_t *cfg)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    filter->pending = *cfg;
+    normalize_config(&filter->pending);
+    filter->has_pending = true;
+    portEXIT_CRITICAL(&g_pending_lock);
+}
+
+void sensor_filter_get_config(sensor_filter_t *filter, sensor_filter_config_t *out)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    *out = filter->has_pending ? filter->pending : filter->cfg;
+    portEXIT_CRITICAL(&g_pending_lock);
+}
+
+static void apply_pending(sensor_filter_t *filter)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    uint8_t old_window = filter->cfg.window;
+    filter->cfg = filter->pending;
+    filter->has_pending = false;
+    portEXIT_CRITICAL(&g_pending_lock);
+    // 环形下标按窗口长度取模，长度变化后旧窗口内容无法沿用
+    if (filter->cfg.window != old_window) {
+        filter->count = 0;
+        filter->head = 0;
+    }
+    if (filter->cfg.ema_alpha_q8 == 0) {
+        filter->ema_valid = false;
+    }
+}
+
+// 在有序数组中查找第一个 >= value 的位置
+static int lower_bound(const int32_t *arr, int n, int32_t value)
+{
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (arr[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void window_push(sensor_filter_t *f, int32_t value)
+{
+    int n = f->count;
+    if (n == f->cfg.window) {
+        // 窗口已满：从有序副本中移除最旧的值
+        int32_t oldest = f->ring[f->head];
+        int pos = lower_bound(f->sorted, n, oldest);
+        memmove(&f->sorted[pos], &f->sorted[pos + 1], (n - pos - 1) * sizeof(int32_t));
+        n--;
+    } else {
+        f->count++;
+    }
+    f->ring[f->head] = value;
+    f->head = (f->head + 1) % f->cfg.window;
+
+    int pos = lower_bound(f->sorted, n, value);
+    memmove(&f->sorted[pos + 1], &f->sorted[pos], (n - pos) * sizeof(int32_t));
+    f->sorted[pos] = value;
+}
+
+static int32_t window_median(const sensor_filter_t *f)
+{
+    int n = f->count;
+    return (n & 1) ? f->sorted[n / 2] : (f->sorted[n / 2 - 1] + f->sorted[n / 2]) / 2;
+}
+
+// 中位绝对偏差：有序数组到中值的距离在中值两侧分别单调，双指针归并取第 n/2 小，O(n)
+static int32_t window_mad(const sensor_filter_t *f, int32_t median)
+{
+    int n = f->count;
+    int right = lower_bound(f->sorted, n, median);
+    int left = right - 1;
+    int32_t dev = 0;
+    for (int k = 0; k <= n / 2; k++) {
+        int32_t dl = (left >= 0) ? median - f->sorted[left] : INT32_MAX;
+        int32_t dr = (right < n) ? f->sorted[right] - median : INT32_MAX;
+        if (dl <= dr) {
+            dev = dl;
+            left--;
+        } else {
+            dev = dr;
+            right++;
+        }
+    }
+    return dev;
+}
+
+bool sensor_filter_process(sensor_filter_t *filter, const sensor_sample_t *raw, sensor_sample_t *out)
+{
+    if (filter->has_pending) {
+        apply_pending(filter);
+    }
+    const sensor_filter_config_t *cfg = &filter->cfg;
+    int32_t value = raw->value;
+    bool outlier = false;
+
+    *out = *raw;
+    filter->processed++;
+
+    if (cfg->window > 0) {
+        window_push(filter, raw->value);
+        if (filter->count >= 3) {
+            int32_t median = window_median(filter);
+            int32_t mad = window_mad(filter, median);
+            // k * 1.4826 * MAD，1.4826 使 MAD 在高斯噪声下等价于标准差
+            int32_t threshold = (int32_t)((int64_t)mad * cfg->hampel_k_x10 * 14826 / 100000);
+            if (threshold < cfg->min_deviation) {
+                threshold = cfg->min_deviation;
+            }
+            if (abs(raw->value - median) > threshold) {
+                outlier = true;
+                filter->outliers++;
+                value = median;
+            }
+        }
+    }
+
+    if (cfg->ema_alpha_q8 > 0) {
+        if (!filter->ema_valid) {
+            filter->ema = value;
+            filter->ema_valid = true;
+        } else {
+            filter->ema += (int32_t)(((int64_t)(value - filter->ema) * cfg->ema_alpha_q8) / 256);
+        }
+        value = filter->ema;
+    }
+
+    out->value = value;
+    if (cfg->window > 0 || cfg->ema_alpha_q8 > 0) {
+        out->flags |= SAMPLE_FLAG_FILTERED;
+    }
+    if (outlier) {
+        out->flags |= SAMPLE_FLAG_OUTLIER;
+        ESP_LOGD(TAG, "%s seq %u: outlier %ld replaced by %ld", sensor_id_name(raw->sensor_id), raw->seq,
+                 (long)raw->value, (long)value);
+    }
+    return outlier;
+}
+
+#if CONFIG_SENSOR_FILTER_SELFTEST
+
+#define SELFTEST_SAMPLES        600
+#define SELFTEST_SPIKE_PERIOD   23      // 每23个样本注入一个单点尖峰
+#define SELFTEST_STEP_AT        300     // 在此处发生真实的阶跃变化
+#define SELFTEST_BENCH_SAMPLES  10000
+
+// 确定性伪随机噪声，保证回放结果可复现
+static int32_t selftest_noise(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (int32_t)((*state >> 16) % 21) - 10;   // ±1.0 ppb
+}
+
+static int32_t selftest_truth(int i)
+{
+    return (i < SELFTEST_STEP_AT) ? 30 * SENSOR_HCHO_SCALE : 60 * SENSOR_HCHO_SCALE;
+}
+
+static void selftest_replay(const sensor_filter_config_t *cfg)
+{
+    sensor_filter_t filter;
+    sensor_filter_init(&filter, cfg);
+    uint32_t rng = 1;
+    int spikes = 0, suppressed = 0, false_positives = 0, step_delay = -1;
+    int32_t max_err_raw = 0, max_err_filtered = 0;
+
+    for (int i = 0; i < SELFTEST_SAMPLES; i++) {
+        sensor_sample_t raw = {0}, out;
+        int32_t truth = selftest_truth(i);
+        bool spike = (i % SELFTEST_SPIKE_PERIOD) == SELFTEST_SPIKE_PERIOD - 1;
+        raw.value = truth + selftest_noise(&rng) + (spike ? 80 * SENSOR_HCHO_SCALE : 0);
+        raw.seq = (uint16_t)i;
+        bool outlier = sensor_filter_process(&filter, &raw, &out);
+
+        int32_t err_raw = abs(raw.value - truth);
+        int32_t err_filtered = abs(out.value - truth);
+        max_err_raw = MAX(max_err_raw, err_raw);
+        if (spike) {
+            spikes++;
+            if (err_filtered <= 5 * SENSOR_HCHO_SCALE) {
+                suppressed++;
+            }
+        } else if (outlier && (i < SELFTEST_STEP_AT || i >= SELFTEST_STEP_AT + cfg->window)) {
+            // 阶跃后 window 个样本内的拒绝属于预期的确认延迟，不计为误判
+            false_positives++;
+        }
+        if (i >= SELFTEST_STEP_AT && step_delay < 0 && err_filtered <= 5 * SENSOR_HCHO_SCALE) {
+            step_delay = i - SELFTEST_STEP_AT;
+        }
+        if (!spike) {
+            max_err_filtered = MAX(max_err_filtered, (i >= SELFTEST_STEP_AT && i < SELFTEST_STEP_AT + cfg->window) ? 0 : err_filtered);
+        }
+    }
+    ESP_LOGI(TAG, "replay w=%u k=%u.%u ema=%u: spikes %d suppressed %d, false positives %d, "
+             "step accepted after %d samples, max error raw %ld / filtered %ld (0.1 ppb)",
+             cfg->window, cfg->hampel_k_x10 / 10, cfg->hampel_k_x10 % 10, cfg->ema_alpha_q8,
+             spikes, suppressed, false_positives, step_delay, (long)max_err_raw, (long)max_err_filtered);
+}
+
+static void selftest_benchmark(const sensor_filter_config_t *cfg)
+{
+    sensor_filter_t filter;
+    sensor_filter_init(&filter, cfg);
+    uint32_t rng = 7;
+    sensor_sample_t raw = {0}, out;
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SELFTEST_BENCH_SAMPLES; i++) {
+        raw.value = 300 + selftest_noise(&rng) * 5;
+        sensor_filter_process(&filter, &raw, &out);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    ESP_LOGI(TAG, "benchmark w=%u ema=%u: %lld ns/sample over %d samples", cfg->window, cfg->ema_alpha_q8,
+             (long long)(elapsed_us * 1000 / SELFTEST_BENCH_SAMPLES), SELFTEST_BENCH_SAMPLES);
+}
+
+void sensor_filter_selftest(void)
+{
+    static const uint8_t windows[] = {5, 9, SENSOR_FILTER_MAX_WINDOW};
+    sensor_filter_config_t cfg;
+    sensor_filter_default_config(&cfg);
+    selftest_replay(&cfg);
+
+    for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+        cfg.window = windows[i];
+        selftest_benchmark(&cfg);
+    }
+}
+
+#endif // CONFIG_SENSOR_FILTER_SELFTEST
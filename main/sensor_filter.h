@@ -0,0 +1,74 @@
+#ifndef __SENSOR_FILTER_H__
+#define __SENSOR_FILTER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor.h"
+
+/**
+ * 样本滤波级：位于解析和发布之间，按传感器独立配置
+ *
+ * 1. 固定窗口滑动中值（有序数组插入/删除，每样本 O(window)）
+ * 2. Hampel 离群检测：|x - median| > k * 1.4826 * MAD 时用中值替换
+ * 3. 可选 EMA 平滑
+ *
+ * 全部为整数运算，窗口上限 SENSOR_FILTER_MAX_WINDOW，单样本开销有界。
+ * 检测是因果的（窗口只含历史和当前样本），真实的阶跃变化会在约 window/2 个样本后被接受。
+ */
+
+#define SENSOR_FILTER_MAX_WINDOW   15
+
+typedef struct {
+    uint8_t window;          // 中值窗口长度（3..15，建议奇数），0 表示关闭中值与离群检测
+    uint8_t hampel_k_x10;    // Hampel 阈值系数 k，放大10倍
+    uint8_t ema_alpha_q8;    // EMA 系数 alpha*256，0 表示关闭
+    int32_t min_deviation;   // 离群判定的最小偏差（定点值），防止平稳时 MAD=0 导致误判
+} sensor_filter_config_t;
+
+typedef struct {
+    sensor_filter_config_t cfg;
+    int32_t  ring[SENSOR_FILTER_MAX_WINDOW];    // 按到达顺序保存的窗口
+    int32_t  sorted[SENSOR_FILTER_MAX_WINDOW];  // 窗口的有序副本
+    uint8_t  count;
+    uint8_t  head;
+    bool     ema_valid;
+    int32_t  ema;
+    uint32_t processed;
+    uint32_t outliers;
+    bool     has_pending;
+    sensor_filter_config_t pending;   // 远程下发、尚未生效的配置
+} sensor_filter_t;
+
+void sensor_filter_default_config(sensor_filter_config_t *cfg);
+
+sensor_filter_t *sensor_filter_get(sensor_id_t id);
+
+void sensor_filter_init(sensor_filter_t *filter, const sensor_filter_config_t *cfg);
+
+/**
+ * @brief 暂存新配置，可在任意任务中调用；消费任务在下一个样本前整体替换，窗口长度变化时清空窗口
+ */
+void sensor_filter_set_config(sensor_filter_t *filter, const sensor_filter_config_t *cfg);
+
+/**
+ * @brief 读取配置，有尚未生效的暂存配置时返回暂存配置
+ */
+void sensor_filter_get_config(sensor_filter_t *filter, sensor_filter_config_t *out);
+
+/**
+ * @brief 处理一个原始样本
+ *
+ * @param raw 原始样本（保持不变）
+ * @param out 滤波后的样本，除 value/flags 外与 raw 相同
+ * @return true 表示 raw 被判定为离群值
+ */
+bool sensor_filter_process(sensor_filter_t *filter, const sensor_sample_t *raw, sensor_sample_t *out);
+
+#if CONFIG_SENSOR_FILTER_SELFTEST
+/**
+ * @brief 回放带尖峰的合成数据并测量每样本耗时，结果输出到日志
+ */
+void sensor_filter_selftest(void);
+#endif
+
+#endif // __SENSOR_FILTER_H__
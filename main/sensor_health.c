@@ -0,0 +1,162 @@
+#include <string.h>
+#include "esp_log.h"
+#include "sensor_health.h"
+#include "protocols/mqtt_device.h"
+
+static const char *TAG = "sensor_health";
+
+#define HEALTH_RECOVER_OK_COUNT     2   // FAILED 后需要连续成功的次数
+#define HEALTH_DEGRADED_FAILS       2   // 最近8次中失败达到该次数即降级
+
+static sensor_health_t g_health[SENSOR_ID_MAX];
+
+static const char *const g_state_names[] = {
+    [SENSOR_HEALTH_WARMING]  = "warming",
+    [SENSOR_HEALTH_HEALTHY]  = "healthy",
+    [SENSOR_HEALTH_DEGRADED] = "degraded",
+    [SENSOR_HEALTH_FAILED]   = "failed",
+};
+
+static const char *const g_fault_names[] = {
+    [SENSOR_FAULT_NONE]           = "none",
+    [SENSOR_FAULT_NO_DATA]        = "no_data",
+    [SENSOR_FAULT_CHECKSUM_STORM] = "checksum_storm",
+    [SENSOR_FAULT_WRONG_MODE]     = "wrong_mode",
+};
+
+const char *sensor_health_state_name(sensor_health_state_t state)
+{
+    return ((unsigned)state < sizeof(g_state_names) / sizeof(g_state_names[0])) ? g_state_names[state] : "unknown";
+}
+
+const char *sensor_fault_name(sensor_fault_t fault)
+{
+    return ((unsigned)fault < sizeof(g_fault_names) / sizeof(g_fault_names[0])) ? g_fault_names[fault] : "unknown";
+}
+
+sensor_health_t *sensor_health_get(sensor_id_t id)
+{
+    return (id < SENSOR_ID_MAX) ? &g_health[id] : NULL;
+}
+
+void sensor_health_init(sensor_health_t *health, sensor_id_t id, uint32_t now_ms)
+{
+    memset(health, 0, sizeof(*health));
+    health->id = id;
+    health->state = SENSOR_HEALTH_WARMING;
+    health->state_since_ms = now_ms;
+    health->started_ms = now_ms;
+    health->backoff_ms = CONFIG_SENSOR_HEALTH_BACKOFF_MIN_MS;
+}
+
+static void set_state(sensor_health_t *h, sensor_health_state_t state, uint32_t now_ms)
+{
+    if (h->state == state) {
+        return;
+    }
+    ESP_LOGW(TAG, "%s: %s -> %s (fault: %s, after %lu ms)", sensor_id_name(h->id),
+             sensor_health_state_name(h->state), sensor_health_state_name(state),
+             sensor_fault_name(h->fault), (unsigned long)(now_ms - h->state_since_ms));
+    h->state = state;
+    h->state_since_ms = now_ms;
+    if (state == SENSOR_HEALTH_FAILED) {
+        // 首次恢复立即执行，之后按退避间隔
+        h->backoff_ms = CONFIG_SENSOR_HEALTH_BACKOFF_MIN_MS;
+        h->next_recovery_ms = now_ms;
+    }
+    mqtt_device_publish_health(h->id, sensor_health_state_name(state), sensor_fault_name(h->fault), h->recoveries);
+}
+
+static sensor_fault_t event_to_fault(sensor_health_event_t evt)
+{
+    switch (evt) {
+    case SENSOR_EVT_TIMEOUT:
+        return SENSOR_FAULT_NO_DATA;
+    case SENSOR_EVT_CHECKSUM:
+        return SENSOR_FAULT_CHECKSUM_STORM;
+    case SENSOR_EVT_WRONG_MODE:
+        return SENSOR_FAULT_WRONG_MODE;
+    default:
+        return SENSOR_FAULT_NONE;
+    }
+}
+
+sensor_health_state_t sensor_health_update(sensor_health_t *h, sensor_health_event_t evt, uint32_t now_ms)
+{
+    bool ok = (evt == SENSOR_EVT_FRAME_OK);
+
+    h->events[evt]++;
+    h->history = (uint8_t)((h->history << 1) | (ok ? 0 : 1));
+    if (ok) {
+        h->consecutive_fail = 0;
+        if (h->consecutive_ok < UINT8_MAX) {
+            h->consecutive_ok++;
+        }
+    } else {
+        h->consecutive_ok = 0;
+        h->fault = event_to_fault(evt);
+        if (h->consecutive_fail < UINT8_MAX) {
+            h->consecutive_fail++;
+        }
+    }
+
+    int recent_fails = __builtin_popcount(h->history);
+    bool warmed_up = (now_ms - h->started_ms) >= CONFIG_SENSOR_HEALTH_WARMUP_S * 1000UL;
+
+    switch (h->state) {
+    case SENSOR_HEALTH_WARMING:
+    case SENSOR_HEALTH_HEALTHY:
+    case SENSOR_HEALTH_DEGRADED:
+        if (h->consecutive_fail >= CONFIG_SENSOR_HEALTH_FAIL_COUNT) {
+            set_state(h, SENSOR_HEALTH_FAILED, now_ms);
+        } else if (h->state == SENSOR_HEALTH_WARMING) {
+            if (warmed_up && ok) {
+                set_state(h, SENSOR_HEALTH_HEALTHY, now_ms);
+            }
+        } else if (recent_fails >= HEALTH_DEGRADED_FAILS) {
+            set_state(h, SENSOR_HEALTH_DEGRADED, now_ms);
+        } else if (recent_fails == 0) {
+            h->fault = SENSOR_FAULT_NONE;
+            set_state(h, SENSOR_HEALTH_HEALTHY, now_ms);
+        }
+        break;
+    case SENSOR_HEALTH_FAILED:
+        if (h->consecutive_ok >= HEALTH_RECOVER_OK_COUNT) {
+            h->fault = SENSOR_FAULT_NONE;
+            h->history = 0;
+            set_state(h, warmed_up ? SENSOR_HEALTH_HEALTHY : SENSOR_HEALTH_WARMING, now_ms);
+        }
+        break;
+    }
+    return h->state;
+}
+
+bool sensor_health_recovery_due(const sensor_health_t *h, uint32_t now_ms)
+{
+    return h->state == SENSOR_HEALTH_FAILED && (int32_t)(now_ms - h->next_recovery_ms) >= 0;
+}
+
+void sensor_health_recovery_done(sensor_health_t *h, uint32_t now_ms)
+{
+    h->recoveries++;
+    h->next_recovery_ms = now_ms + h->backoff_ms;
+    ESP_LOGI(TAG, "%s: recovery #%lu for %s, next attempt in %lu ms", sensor_id_name(h->id),
+             (unsigned long)h->recoveries, sensor_fault_name(h->fault), (unsigned long)h->backoff_ms);
+    h->backoff_ms *= 2;
+    if (h->backoff_ms > CONFIG_SENSOR_HEALTH_BACKOFF_MAX_MS) {
+        h->backoff_ms = CONFIG_SENSOR_HEALTH_BACKOFF_MAX_MS;
+    }
+}
+
+uint8_t sensor_health_sample_flags(const sensor_health_t *h)
+{
+    switch (h->state) {
+    case SENSOR_HEALTH_WARMING:
+        return SAMPLE_FLAG_WARMING;
+    case SENSOR_HEALTH_DEGRADED:
+    case SENSOR_HEALTH_FAILED:
+        return SAMPLE_FLAG_DEGRADED;
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef __SENSOR_HEALTH_H__
+#define __SENSOR_HEALTH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor.h"
+
+/**
+ * 传感器健康监督
+ *
+ * 每次读取尝试（一个预期帧周期）产生一个事件，状态机据此在
+ * WARMING / HEALTHY / DEGRADED / FAILED 之间迁移：
+ *   - 连续 CONFIG_SENSOR_HEALTH_FAIL_COUNT 次失败 -> FAILED
+ *   - 最近8次中有2次及以上失败 -> DEGRADED，8次全部成功 -> HEALTHY
+ *   - FAILED 后连续2次成功 -> HEALTHY
+ * FAILED 状态下按指数退避（1s, 2s, 4s ... 上限）执行恢复，而不是固定间隔反复重新初始化。
+ */
+
+// 一次读取尝试的结果
+typedef enum {
+    SENSOR_EVT_FRAME_OK = 0,   // 收到有效帧
+    SENSOR_EVT_TIMEOUT,        // 没有收到任何数据（传感器掉电、线缆断开）
+    SENSOR_EVT_CHECKSUM,       // 收到数据但校验失败或无法成帧（干扰、波特率错误）
+    SENSOR_EVT_WRONG_MODE,     // 校验通过但帧类型与当前模式不符
+    SENSOR_EVT_MAX
+} sensor_health_event_t;
+
+typedef enum {
+    SENSOR_HEALTH_WARMING = 0,
+    SENSOR_HEALTH_HEALTHY,
+    SENSOR_HEALTH_DEGRADED,
+    SENSOR_HEALTH_FAILED,
+} sensor_health_state_t;
+
+typedef enum {
+    SENSOR_FAULT_NONE = 0,
+    SENSOR_FAULT_NO_DATA,         // 无响应：传感器失效或线缆断开
+    SENSOR_FAULT_CHECKSUM_STORM,  // 连续校验错误
+    SENSOR_FAULT_WRONG_MODE,      // 工作模式不一致
+} sensor_fault_t;
+
+typedef struct {
+    sensor_id_t id;
+    sensor_health_state_t state;
+    sensor_fault_t fault;           // 最近一次失败的类型
+    uint8_t  history;               // 最近8次读取结果位图，1 表示失败
+    uint8_t  consecutive_ok;
+    uint8_t  consecutive_fail;
+    uint32_t state_since_ms;        // 进入当前状态的时间
+    uint32_t started_ms;            // 监督开始时间，用于预热计时
+    uint32_t backoff_ms;            // 下一次恢复前的等待时间
+    uint32_t next_recovery_ms;
+    uint32_t recoveries;            // 已执行的恢复次数
+    uint32_t events[SENSOR_EVT_MAX];
+} sensor_health_t;
+
+sensor_health_t *sensor_health_get(sensor_id_t id);
+
+void sensor_health_init(sensor_health_t *health, sensor_id_t id, uint32_t now_ms);
+
+/**
+ * @brief 输入一次读取结果，返回更新后的状态；状态变化会记录日志并通过网络发布
+ */
+sensor_health_state_t sensor_health_update(sensor_health_t *health, sensor_health_event_t evt, uint32_t now_ms);
+
+/**
+ * @brief FAILED 状态下是否到了执行恢复动作的时间
+ */
+bool sensor_health_recovery_due(const sensor_health_t *health, uint32_t now_ms);
+
+/**
+ * @brief 记录一次恢复尝试，并将退避时间翻倍
+ */
+void sensor_health_recovery_done(sensor_health_t *health, uint32_t now_ms);
+
+/**
+ * @brief 根据当前状态返回应附加到样本上的质量标志
+ */
+uint8_t sensor_health_sample_flags(const sensor_health_t *health);
+
+const char *sensor_health_state_name(sensor_health_state_t state);
+const char *sensor_fault_name(sensor_fault_t fault);
+
+#endif // __SENSOR_HEALTH_H__
@@ -0,0 +1,103 @@
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "sensor_history.h"
+
+// 当前时间桶的累加状态，每次追加都一起访问，按槽位存为结构体
+typedef struct {
+    uint32_t total;             // 累计提交的点数，点下标为 total % points
+    int64_t  bucket_sum;        // 当前时间桶内样本值之和
+    uint16_t bucket_count;
+    uint32_t bucket_start_ms;
+} sensor_history_t;
+
+// 所有通道的点放在一列中，每个槽位占其通道 history_points 个连续的点
+static int32_t g_points[SENSOR_CH_HISTORY_TOTAL];
+static sensor_history_t g_history[SENSOR_CH_SLOTS];
+static portMUX_TYPE g_history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+uint32_t sensor_history_points(sensor_channel_t channel)
+{
+    const sensor_channel_info_t *info = sensor_channel_info(channel);
+    return info ? info->history_points : 0;
+}
+
+uint32_t sensor_history_bucket_ms(sensor_channel_t channel)
+{
+    uint32_t points = sensor_history_points(channel);
+    return points ? SENSOR_HISTORY_SPAN_MS / points : 0;
+}
+
+// 槽位的点区间
+static int32_t *slot_points(const sensor_channel_info_t *info, int slot)
+{
+    return &g_points[info->history_base + (uint32_t)(slot - info->slot_base) * info->history_points];
+}
+
+static inline void history_push(sensor_history_t *h, int32_t *points, uint32_t n, int32_t value)
+{
+    points[h->total % n] = value;
+    h->total++;
+}
+
+void sensor_history_append(const sensor_sample_t *sample)
+{
+    int slot = sensor_channel_find_slot(sample->sensor_id, sample->channel);
+    if (slot < 0) {
+        return;
+    }
+    const sensor_channel_info_t *info = sensor_channel_info(sample->channel);
+    sensor_history_t *h = &g_history[slot];
+    int32_t *points = slot_points(info, slot);
+    uint32_t n = info->history_points;
+    uint32_t bucket_ms = sensor_history_bucket_ms(sample->channel);
+
+    portENTER_CRITICAL(&g_history_lock);
+    if (h->bucket_count == 0 && h->total == 0) {
+        h->bucket_start_ms = sample->timestamp_ms;
+    }
+    // 帧到达时刻回推的时间戳可能早于当前桶起点，无符号相减会回绕成一整圈空点；
+    // 这类样本至多晚到一帧，并入当前桶
+    int32_t since_start = (int32_t)(sample->timestamp_ms - h->bucket_start_ms);
+    uint32_t elapsed = (since_start > 0) ? (uint32_t)since_start / bucket_ms : 0;
+    if (elapsed > 0) {
+        // 提交当前桶，中间没有样本的桶补空点，最多补满一圈
+        history_push(h, points, n, h->bucket_count ? (int32_t)(h->bucket_sum / h->bucket_count) : SENSOR_HISTORY_GAP);
+        uint32_t gaps = MIN(elapsed - 1, n);
+        for (uint32_t i = 0; i < gaps; i++) {
+            history_push(h, points, n, SENSOR_HISTORY_GAP);
+        }
+        h->bucket_start_ms += elapsed * bucket_ms;
+        h->bucket_sum = 0;
+        h->bucket_count = 0;
+    }
+    h->bucket_sum += sample->value;
+    h->bucket_count++;
+    portEXIT_CRITICAL(&g_history_lock);
+}
+
+uint32_t sensor_history_read_since(sensor_id_t id, sensor_channel_t channel, uint32_t since_total, int32_t *out,
+                                   uint32_t max, uint32_t *total)
+{
+    int slot = sensor_channel_find_slot(id, channel);
+    if (slot < 0) {
+        *total = since_total;
+        return 0;
+    }
+    const sensor_channel_info_t *info = sensor_channel_info(channel);
+    sensor_history_t *h = &g_history[slot];
+    const int32_t *points = slot_points(info, slot);
+    uint32_t len = info->history_points;
+
+    portENTER_CRITICAL(&g_history_lock);
+    uint32_t now_total = h->total;
+    uint32_t n = now_total - since_total;
+    n = MIN(n, len);
+    n = MIN(n, max);
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] = points[(now_total - n + i) % len];
+    }
+    portEXIT_CRITICAL(&g_history_lock);
+
+    *total = now_total;
+    return n;
+}
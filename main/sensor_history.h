@@ -0,0 +1,46 @@
+#ifndef __SENSOR_HISTORY_H__
+#define __SENSOR_HISTORY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor.h"
+#include "sensor_channel.h"
+
+/**
+ * 内存中的定长历史环
+ *
+ * 每个通道槽位（见 sensor_channel.h）保留 sensor_history_points(channel) 个点，覆盖最近
+ * CONFIG_SENSOR_HISTORY_SPAN_S 秒；点数不超过 CONFIG_SENSOR_HISTORY_POINTS，慢速通道按采样间隔减少。
+ * 样本先在当前时间桶内累加，跨桶时提交桶均值；没有样本的桶记为 SENSOR_HISTORY_GAP。
+ * 追加与读取都是 O(1)/点，读者用单调递增的总点数跟踪自己读到哪里，只取增量。
+ */
+
+#define SENSOR_HISTORY_GAP      INT32_MIN   // 该时间桶内没有样本
+
+/**
+ * @brief 通道每个槽位的历史点数
+ */
+uint32_t sensor_history_points(sensor_channel_t channel);
+
+/**
+ * @brief 通道每个点覆盖的时间（毫秒）
+ */
+uint32_t sensor_history_bucket_ms(sensor_channel_t channel);
+
+/**
+ * @brief 追加一个样本（定点值），由发布流水线调用
+ */
+void sensor_history_append(const sensor_sample_t *sample);
+
+/**
+ * @brief 读取 since_total 之后新增的点，按时间从旧到新写入 out
+ *
+ * 落后超过环长度时只返回最新的 max 个点。
+ * @param since_total 上次读取后得到的 total，首次读取传 0
+ * @param total       输出当前的总点数，供下次读取使用
+ * @return 写入 out 的点数
+ */
+uint32_t sensor_history_read_since(sensor_id_t id, sensor_channel_t channel, uint32_t since_total, int32_t *out,
+                                   uint32_t max, uint32_t *total);
+
+#endif // __SENSOR_HISTORY_H__
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "sensor_scheduler.h"
+
+static const char *TAG = "sensor_sched";
+
+static sensor_scheduler_t g_schedulers[SENSOR_ID_MAX];
+// 保护各调度器的暂存配置
+static portMUX_TYPE g_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void sensor_scheduler_default_config(sensor_scheduler_config_t *cfg)
+{
+    cfg->min_interval_ms = CONFIG_SENSOR_SCHED_MIN_INTERVAL_MS;
+    cfg->max_interval_ms = CONFIG_SENSOR_SCHED_MAX_INTERVAL_MS;
+    cfg->slope_threshold = CONFIG_SENSOR_SCHED_SLOPE_PPB_PER_MIN * SENSOR_HCHO_SCALE;
+    cfg->alert_level = sensor_hcho_ugm3_to_ppb(CONFIG_SENSOR_HCHO_ALERT_UGM3 * SENSOR_HCHO_SCALE);
+    cfg->calm_samples = CONFIG_SENSOR_SCHED_CALM_SAMPLES;
+}
+
+sensor_scheduler_t *sensor_scheduler_get(sensor_id_t id)
+{
+    return (id < SENSOR_ID_MAX) ? &g_schedulers[id] : NULL;
+}
+
+static void normalize_config(sensor_scheduler_config_t *cfg)
+{
+    if (cfg->max_interval_ms < cfg->min_interval_ms) {
+        cfg->max_interval_ms = cfg->min_interval_ms;
+    }
+    if (cfg->calm_samples == 0) {
+        cfg->calm_samples = 1;
+    }
+}
+
+void sensor_scheduler_init(sensor_scheduler_t *sched, const sensor_scheduler_config_t *cfg)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->cfg = *cfg;
+    normalize_config(&sched->cfg);
+    // 启动时按最快速率采样，等数据稳定后再放慢
+    sched->interval_ms = sched->cfg.min_interval_ms;
+}
+
+void sensor_scheduler_set_config(sensor_scheduler_t *sched, const sensor_scheduler_config_t *cfg)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    sched->pending = *cfg;
+    normalize_config(&sched->pending);
+    sched->has_pending = true;
+    portEXIT_CRITICAL(&g_pending_lock);
+}
+
+void sensor_scheduler_get_config(sensor_scheduler_t *sched, sensor_scheduler_config_t *out)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    *out = sched->has_pending ? sched->pending : sched->cfg;
+    portEXIT_CRITICAL(&g_pending_lock);
+}
+
+// 在样本边界整体替换配置，当前间隔收进新的范围
+static void apply_pending(sensor_scheduler_t *sched)
+{
+    portENTER_CRITICAL(&g_pending_lock);
+    sched->cfg = sched->pending;
+    sched->has_pending = false;
+    portEXIT_CRITICAL(&g_pending_lock);
+    if (sched->interval_ms < sched->cfg.min_interval_ms) {
+        sched->interval_ms = sched->cfg.min_interval_ms;
+    } else if (sched->interval_ms > sched->cfg.max_interval_ms) {
+        sched->interval_ms = sched->cfg.max_interval_ms;
+    }
+    sched->calm_count = 0;
+}
+
+bool sensor_scheduler_feed(sensor_scheduler_t *sched, const sensor_sample_t *sample)
+{
+    if (sched->has_pending) {
+        apply_pending(sched);
+    }
+    const sensor_scheduler_config_t *cfg = &sched->cfg;
+    uint32_t now = sample->timestamp_ms;
+    uint32_t prev_interval = sched->interval_ms;
+    bool active = false;
+
+    if (sched->has_last) {
+        uint32_t dt = now - sched->last_sample_ms;
+        if (dt == 0) {
+            dt = 1;
+        }
+        // 变化率：定点值/分钟
+        int64_t slope = (int64_t)abs(sample->value - sched->last_value) * 60000 / dt;
+        bool crossed = (sched->last_value < cfg->alert_level) != (sample->value < cfg->alert_level);
+        active = (slope >= cfg->slope_threshold) || crossed;
+    }
+
+    if (active) {
+        if (sched->interval_ms != cfg->min_interval_ms) {
+            sched->bursts++;
+            ESP_LOGI(TAG, "%s: burst, interval %lu -> %lu ms", sensor_id_name(sample->sensor_id),
+                     (unsigned long)sched->interval_ms, (unsigned long)cfg->min_interval_ms);
+        }
+        sched->interval_ms = cfg->min_interval_ms;
+        sched->calm_count = 0;
+    } else if (++sched->calm_count >= cfg->calm_samples) {
+        sched->calm_count = 0;
+        uint32_t next = sched->interval_ms * 2;
+        sched->interval_ms = (next > cfg->max_interval_ms) ? cfg->max_interval_ms : next;
+    }
+
+    sched->last_value = sample->value;
+    sched->last_sample_ms = now;
+    sched->has_last = true;
+
+    // 按更新前的间隔判断是否到期，留1/4最小间隔的余量以容忍上传节拍抖动
+    bool publish = !sched->has_published || active ||
+                   (now - sched->last_publish_ms) + cfg->min_interval_ms / 4 >= prev_interval;
+    if (publish) {
+        sched->last_publish_ms = now;
+        sched->has_published = true;
+    }
+    return publish;
+}
+
+void sensor_scheduler_note_delivered(sensor_scheduler_t *sched, uint32_t timestamp_ms)
+{
+    if (sched->has_delivered) {
+        uint32_t dt = timestamp_ms - sched->last_delivered_ms;
+        sched->avg_interval_ms = (sched->avg_interval_ms == 0) ? dt : (sched->avg_interval_ms * 7 + dt) / 8;
+    }
+    sched->last_delivered_ms = timestamp_ms;
+    sched->has_delivered = true;
+}
+
+uint32_t sensor_scheduler_interval_ms(const sensor_scheduler_t *sched)
+{
+    return sched->interval_ms;
+}
+
+uint32_t sensor_scheduler_rate_mhz(const sensor_scheduler_t *sched)
+{
+    return (sched->avg_interval_ms > 0) ? 1000000UL / sched->avg_interval_ms : 0;
+}
@@ -0,0 +1,87 @@
+#ifndef __SENSOR_SCHEDULER_H__
+#define __SENSOR_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor.h"
+
+/**
+ * 自适应采样调度器
+ *
+ * 读数平稳时逐步拉长采样间隔（翻倍直到 max_interval_ms），
+ * 一旦变化率超过阈值或穿越告警浓度，立即回到 min_interval_ms（传感器最大速率）。
+ * 问答模式下间隔直接决定查询周期；主动上传模式下传感器节奏固定，
+ * 默认（SENSOR_AUTO_AGGREGATE）由调度器划定聚合窗口，到期时发布窗口均值，从而降低
+ * 下游的处理与上传量；关闭聚合时主动上传的每一帧都发布，调度器只决定问答周期。
+ * 发布速率按实际交付的样本统计（sensor_scheduler_note_delivered），而不是调度器的判定。
+ */
+
+typedef struct {
+    uint32_t min_interval_ms;   // 突发时的采样间隔（传感器最大速率）
+    uint32_t max_interval_ms;   // 平稳时的最长采样间隔
+    int32_t  slope_threshold;   // 变化率阈值，定点值/分钟
+    int32_t  alert_level;       // 告警浓度，定点值，穿越即突发
+    uint8_t  calm_samples;      // 连续多少个平稳样本后间隔翻倍
+} sensor_scheduler_config_t;
+
+typedef struct {
+    sensor_scheduler_config_t cfg;
+    uint32_t interval_ms;       // 当前采样间隔
+    int32_t  last_value;        // 上一个输入样本的值
+    uint32_t last_sample_ms;    // 上一个输入样本的时间
+    uint32_t last_publish_ms;   // 上一次判定到期的样本时间
+    uint32_t last_delivered_ms; // 上一个实际交付的样本时间
+    uint32_t avg_interval_ms;   // 交付间隔的指数滑动平均，用于计算实际发布速率
+    uint32_t bursts;            // 进入突发的次数
+    uint8_t  calm_count;
+    bool     has_last;
+    bool     has_published;
+    bool     has_delivered;
+    bool     has_pending;
+    sensor_scheduler_config_t pending;   // 远程下发、尚未生效的配置
+} sensor_scheduler_t;
+
+/**
+ * @brief 用 Kconfig 默认值填充配置
+ */
+void sensor_scheduler_default_config(sensor_scheduler_config_t *cfg);
+
+/**
+ * @brief 获取指定传感器的调度器实例
+ */
+sensor_scheduler_t *sensor_scheduler_get(sensor_id_t id);
+
+void sensor_scheduler_init(sensor_scheduler_t *sched, const sensor_scheduler_config_t *cfg);
+
+/**
+ * @brief 暂存新配置，可在任意任务中调用；生产任务在下一次 feed 开始时整体替换
+ */
+void sensor_scheduler_set_config(sensor_scheduler_t *sched, const sensor_scheduler_config_t *cfg);
+
+/**
+ * @brief 读取配置，有尚未生效的暂存配置时返回暂存配置
+ */
+void sensor_scheduler_get_config(sensor_scheduler_t *sched, sensor_scheduler_config_t *out);
+
+/**
+ * @brief 输入一个新样本并更新采样节奏
+ * @return true 表示该样本应当发布（到期或检测到变化）
+ */
+bool sensor_scheduler_feed(sensor_scheduler_t *sched, const sensor_sample_t *sample);
+
+/**
+ * @brief 记录一个实际交付到发布队列的样本（逐帧或窗口均值），用于统计发布速率
+ */
+void sensor_scheduler_note_delivered(sensor_scheduler_t *sched, uint32_t timestamp_ms);
+
+/**
+ * @brief 当前建议的采样间隔（毫秒）
+ */
+uint32_t sensor_scheduler_interval_ms(const sensor_scheduler_t *sched);
+
+/**
+ * @brief 实际交付的样本速率，单位毫赫兹（1000 = 1 Hz）
+ */
+uint32_t sensor_scheduler_rate_mhz(const sensor_scheduler_t *sched);
+
+#endif // __SENSOR_SCHEDULER_H__
@@ -0,0 +1,158 @@
+#include "sdkconfig.h"
+
+#if CONFIG_SHT4X
+
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sht4x.h"
+#include "sensor.h"
+#include "i2c_arbiter.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+
+#define SHT4X_SCL_SPEED_HZ      (400 * 1000)
+#define SHT4X_CMD_MEASURE_HIGH  0xFD    // 高重复性测量，最长 8.3ms
+#define SHT4X_MEASURE_MS        9
+#define SHT4X_I2C_TIMEOUT_MS    10
+#define SHT4X_STACK_SIZE        3072    // 与其他生产任务相同，发布流水线在本任务中运行
+#define SHT4X_STATS_PERIOD_MS   60000
+
+static const char *TAG = "sht4x";
+
+typedef struct {
+    int32_t temperature_centi_c;    // 0.01 摄氏度
+    int32_t humidity_centi_pct;     // 0.01 %RH，已限制在 0..100%
+} sht4x_reading_t;
+
+_Static_assert(SENSOR_TEMP_SCALE == 100 && SENSOR_RH_SCALE == 100, "SHT4x readings are in 0.01 units");
+
+static i2c_master_dev_handle_t g_dev = NULL;
+static uint16_t g_seq = 0;
+
+#if CONFIG_STATIC_ALLOCATION
+static StackType_t g_task_stack[SHT4X_STACK_SIZE];
+static StaticTask_t g_task_tcb;
+#endif
+
+// CRC-8，多项式 0x31，初值 0xFF
+static uint8_t sht4x_crc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0xFF;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static esp_err_t sht4x_measure(sht4x_reading_t *out)
+{
+    const uint8_t cmd = SHT4X_CMD_MEASURE_HIGH;
+    i2c_arbiter_sensor_begin();
+    esp_err_t err = i2c_master_transmit(g_dev, &cmd, 1, SHT4X_I2C_TIMEOUT_MS);
+    i2c_arbiter_sensor_end();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 测量期间不占用总线；多等一个 tick，避免 tick 取整后等待不足
+    vTaskDelay(pdMS_TO_TICKS(SHT4X_MEASURE_MS) + 1);
+
+    uint8_t rx[6];
+    i2c_arbiter_sensor_begin();
+    err = i2c_master_receive(g_dev, rx, sizeof(rx), SHT4X_I2C_TIMEOUT_MS);
+    i2c_arbiter_sensor_end();
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (sht4x_crc8(rx, 2) != rx[2] || sht4x_crc8(rx + 3, 2) != rx[5]) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    uint32_t raw_t = ((uint32_t)rx[0] << 8) | rx[1];
+    uint32_t raw_rh = ((uint32_t)rx[3] << 8) | rx[4];
+    // 数据手册：T = -45 + 175 * raw / 65535，RH = -6 + 125 * raw / 65535
+    out->temperature_centi_c = (int32_t)((17500ULL * raw_t + 32767) / 65535) - 4500;
+    int32_t rh = (int32_t)((12500ULL * raw_rh + 32767) / 65535) - 600;
+    out->humidity_centi_pct = (rh < 0) ? 0 : (rh > 10000) ? 10000 : rh;
+    return ESP_OK;
+}
+
+static void sht4x_log_bus_stats(void)
+{
+    i2c_arbiter_stats_t st;
+    i2c_arbiter_get_stats(&st, true);
+    ESP_LOGI(TAG, "I2C sensor wait max %lu us avg %lu us over %lu txns, display hold max %lu us, %lu handoffs",
+             (unsigned long)st.sensor_wait_max_us, (unsigned long)st.sensor_wait_avg_us,
+             (unsigned long)st.sensor_txns, (unsigned long)st.display_hold_max_us, (unsigned long)st.handoffs);
+}
+
+static void sht4x_task(void *pvParameters)
+{
+    ESP_LOGI(TAG, "SHT4x task started");
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t stats_since_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    while (1) {
+        sht4x_reading_t reading;
+        esp_err_t err = sht4x_measure(&reading);
+        if (err == ESP_OK) {
+            // 两个通道共用一次读取的时间戳与序号
+            sensor_sample_t sample;
+            sensor_sample_fill(&sample, SENSOR_ID_SHT4X, SENSOR_CH_TEMP, reading.temperature_centi_c, g_seq,
+                               SAMPLE_FLAG_VALID);
+            sensor_publish(&sample);
+            sample.channel = SENSOR_CH_RH;
+            sample.value = reading.humidity_centi_pct;
+            sensor_publish(&sample);
+            g_seq++;
+            sensor_count_frames(SENSOR_ID_SHT4X, 1, 1);
+            ESP_LOGD(TAG, "T %ld.%02ld C, RH %ld.%02ld %%", (long)(reading.temperature_centi_c / 100),
+                     (long)(abs(reading.temperature_centi_c) % 100), (long)(reading.humidity_centi_pct / 100),
+                     (long)(reading.humidity_centi_pct % 100));
+        } else {
+            ESP_LOGW(TAG, "Measurement failed: %s", esp_err_to_name(err));
+        }
+
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        if (now_ms - stats_since_ms >= SHT4X_STATS_PERIOD_MS) {
+            sht4x_log_bus_stats();
+            stats_since_ms = now_ms;
+        }
+        if (xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_SHT4X_PERIOD_MS)) == pdFALSE) {
+            last_wake = xTaskGetTickCount();
+        }
+    }
+}
+
+void sht4x_start(i2c_master_bus_handle_t bus)
+{
+    const i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = CONFIG_SHT4X_I2C_ADDR,
+        .scl_speed_hz = SHT4X_SCL_SPEED_HZ,
+    };
+    esp_err_t err = i2c_master_bus_add_device(bus, &dev_config, &g_dev);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Add SHT4x device failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    TaskHandle_t task = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    task = xTaskCreateStaticPinnedToCore(sht4x_task, "sht4x_task", SHT4X_STACK_SIZE, NULL,
+                                         TASK_PRIO_SENSOR_CONSUMER, g_task_stack, &g_task_tcb, TASK_CORE_SENSOR);
+#else
+    xTaskCreatePinnedToCore(sht4x_task, "sht4x_task", SHT4X_STACK_SIZE, NULL, TASK_PRIO_SENSOR_CONSUMER, &task,
+                            TASK_CORE_SENSOR);
+#endif
+    alloc_guard_track_task(task);
+    mem_profiler_register_task(task, SHT4X_STACK_SIZE);
+}
+
+#endif // CONFIG_SHT4X
@@ -0,0 +1,30 @@
+#ifndef __SHT4X_H__
+#define __SHT4X_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/i2c_master.h"
+
+/**
+ * SHT4x 温湿度传感器（温湿度补偿用）
+ *
+ * 与 OLED 共用 I2C 总线，每次访问都经过 i2c_arbiter：发送测量命令与读取结果
+ * 是两个独立的短事务，测量期间（约 9ms）总线空闲，刷屏可以继续。
+ * 读数以传感器 SENSOR_ID_SHT4X 发布到 SENSOR_CH_TEMP 与 SENSOR_CH_RH 通道，与其他样本
+ * 一样进入最新值、历史与遥测；取值用 sensor_get_latest。
+ */
+
+#if CONFIG_SHT4X
+
+/**
+ * @brief 在共享总线上添加 SHT4x 并启动周期读取任务
+ */
+void sht4x_start(i2c_master_bus_handle_t bus);
+
+#else
+
+static inline void sht4x_start(i2c_master_bus_handle_t bus) {}
+
+#endif // CONFIG_SHT4X
+
+#endif // __SHT4X_H__
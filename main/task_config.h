@@ -0,0 +1,54 @@
+#ifndef __TASK_CONFIG_H__
+#define __TASK_CONFIG_H__
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * 任务优先级与核心分配表
+ *
+ *   任务               优先级  核心
+ *   Wi-Fi（ESP-IDF）     23    CONFIG_ESP_WIFI_TASK_CORE_ID，默认 CPU0
+ *   lwIP tcpip（ESP-IDF）18    CONFIG_LWIP_TCPIP_TASK_AFFINITY，默认不绑定
+ *   告警                  6    不绑定（只在告警状态变化时运行，发送网络消息）
+ *   MQTT client           5    esp-mqtt 的 MQTT_TASK_CORE_SELECTION，默认 CPU0
+ *   MQTT 发送             1    TASK_CORE_AUX（健康状态等 QoS 1 消息写入 outbox）
+ *   传感器生产者          5    TASK_CORE_SENSOR，默认 CPU1（UART 读取与解析，对时序敏感）
+ *   传感器消费者          4    TASK_CORE_SENSOR（滤波、存储、发布）
+ *   SHT4x 温湿度          4    TASK_CORE_SENSOR（I2C，经 i2c_arbiter 与刷屏分块交替）
+ *   LVGL                  2    TASK_CORE_UI，默认 CPU1（渲染与 I2C 刷屏）
+ *   历史落盘              1    TASK_CORE_AUX（flash 擦写会暂停缓存，放在最低优先级）
+ *   历史导出              1    TASK_CORE_AUX（按请求运行，逐扇区持有存储锁）
+ *   CoAP 遥测/开销统计    1    TASK_CORE_AUX（UDP 发送与 CON 重传等待）
+ *   内存/CPU 分析、抖动负载 1    TASK_CORE_AUX，默认不绑定
+ *
+ * 网络协议栈集中在 CPU0，传感器 I/O 与 UI 放在 CPU1，Wi-Fi 重连时的协议栈突发
+ * 不会抢占 UART 采样；传感器任务优先级高于 LVGL，刷屏不会推迟采样。
+ * 单核芯片上所有任务不绑定核心，只保留优先级关系。
+ */
+
+// 应用自建任务数的上限：上表各行（传感器生产者/消费者各计一个，Dart、Winsen、RS-485 总线各一对）
+// 全部启用时共 18 个，加 app_main 为 19，留 2 个余量。内存分析与分配检查的登记表按此分配，
+// 新增任务时同步调整
+#define TASK_COUNT_MAX              21
+
+#define TASK_PRIO_ALARM             6
+#define TASK_PRIO_SENSOR_PRODUCER   5
+#define TASK_PRIO_SENSOR_CONSUMER   4
+#define TASK_PRIO_UI                2
+#define TASK_PRIO_AUX               1
+
+#if CONFIG_FREERTOS_UNICORE
+#define TASK_CORE_SENSOR    tskNO_AFFINITY
+#define TASK_CORE_UI        tskNO_AFFINITY
+#define TASK_CORE_AUX       tskNO_AFFINITY
+#else
+#define TASK_CORE_SENSOR    ((CONFIG_TASK_CORE_SENSOR < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_SENSOR)
+#define TASK_CORE_UI        ((CONFIG_TASK_CORE_UI < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_UI)
+#define TASK_CORE_AUX       ((CONFIG_TASK_CORE_AUX < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_AUX)
+#endif
+
+// 告警任务可在任一空闲核上立即运行
+#define TASK_CORE_ALARM     tskNO_AFFINITY
+
+#endif // __TASK_CONFIG_H__
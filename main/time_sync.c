@@ -0,0 +1,81 @@
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif_sntp.h"
+#include "time_sync.h"
+#include "protocols/telemetry.h"
+
+static const char *TAG = "time_sync";
+
+// 两次同步至少相隔这么久才用于估计漂移，避免网络延迟抖动主导估计值
+#define TIME_SYNC_DRIFT_MIN_INTERVAL_US   (10LL * 60 * 1000000)
+
+static int64_t g_ref_boot_us;       // 最近一次同步的开机时刻
+static int64_t g_ref_utc_us;        // 最近一次同步的 UTC 时刻
+static int64_t g_anchor_boot_us;    // 漂移估计的起点
+static int64_t g_anchor_utc_us;
+static int32_t g_drift_ppb;
+static bool g_has_ref = false;
+static bool g_has_drift = false;
+static portMUX_TYPE g_time_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void time_sync_cb(struct timeval *tv)
+{
+    int64_t boot_us = esp_timer_get_time();
+    int64_t utc_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    int64_t offset_err_us = 0;
+
+    portENTER_CRITICAL(&g_time_lock);
+    if (g_has_ref) {
+        // 按旧参考点（含已估计的漂移）预测当前 UTC，与同步结果比较
+        int64_t since_ref = boot_us - g_ref_boot_us;
+        offset_err_us = utc_us - (g_ref_utc_us + since_ref + since_ref * g_drift_ppb / 1000000000);
+
+        int64_t elapsed = boot_us - g_anchor_boot_us;
+        if (elapsed >= TIME_SYNC_DRIFT_MIN_INTERVAL_US) {
+            int64_t err = (utc_us - g_anchor_utc_us) - elapsed;
+            int32_t ppb = (int32_t)(err * 1000000000 / elapsed);
+            // 新估计与旧值各占一半，平滑单次同步的网络延迟误差
+            g_drift_ppb = g_has_drift ? (g_drift_ppb + ppb) / 2 : ppb;
+            g_has_drift = true;
+            g_anchor_boot_us = boot_us;
+            g_anchor_utc_us = utc_us;
+        }
+    } else {
+        g_anchor_boot_us = boot_us;
+        g_anchor_utc_us = utc_us;
+    }
+    g_ref_boot_us = boot_us;
+    g_ref_utc_us = utc_us;
+    g_has_ref = true;
+    int32_t drift = g_drift_ppb;
+    portEXIT_CRITICAL(&g_time_lock);
+
+    ESP_LOGI(TAG, "SNTP sync: utc %lld.%03lld, prediction error %lld us, drift %ld ppb",
+             (long long)(utc_us / 1000000), (long long)(utc_us / 1000 % 1000), (long long)offset_err_us, (long)drift);
+    // 本回调在 lwIP tcpip 线程中运行，两种传输的 timeref 接口都只缓存或入队，不写套接字
+    telemetry_publish_timeref((uint32_t)(boot_us / 1000), utc_us / 1000, drift);
+}
+
+void time_sync_init(void)
+{
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(CONFIG_SNTP_SERVER);
+    config.sync_cb = time_sync_cb;
+    config.wait_for_sync = false;
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "SNTP init failed: %s", esp_err_to_name(err));
+    }
+}
+
+bool time_sync_get_ref(time_sync_ref_t *ref)
+{
+    portENTER_CRITICAL(&g_time_lock);
+    ref->valid = g_has_ref;
+    ref->boot_ms = (uint32_t)(g_ref_boot_us / 1000);
+    ref->utc_ms = g_ref_utc_us / 1000;
+    ref->drift_ppb = g_drift_ppb;
+    portEXIT_CRITICAL(&g_time_lock);
+    return ref->valid;
+}
@@ -0,0 +1,42 @@
+#ifndef __TIME_SYNC_H__
+#define __TIME_SYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * SNTP 墙钟同步
+ *
+ * 样本时间戳始终是开机以来的毫秒数（单调、无跳变），UTC 通过参考点换算：
+ * 每次 SNTP 同步记录一对（开机时刻, UTC 时刻），并用相隔足够远的两次同步估计本地晶振的漂移。
+ * 批量上传时取一次参考点快照，之后每个样本只做整数换算，不再读取时钟。
+ */
+
+typedef struct {
+    uint32_t boot_ms;     // 参考点的开机毫秒数
+    int64_t  utc_ms;      // 参考点对应的 UTC 毫秒数（Unix 纪元）
+    int32_t  drift_ppb;   // 本地时钟相对 UTC 的漂移，正值表示本地偏慢
+    bool     valid;       // 尚未同步时为 false
+} time_sync_ref_t;
+
+/**
+ * @brief 启动 SNTP，需在网络连接后调用
+ */
+void time_sync_init(void);
+
+/**
+ * @brief 获取当前参考点快照
+ * @return false 表示尚未完成首次同步
+ */
+bool time_sync_get_ref(time_sync_ref_t *ref);
+
+/**
+ * @brief 用参考点把开机毫秒数换算为 UTC 毫秒数（纯整数运算，参考点前后 24 天内有效）
+ */
+static inline int64_t time_sync_to_utc_ms(const time_sync_ref_t *ref, uint32_t boot_ms)
+{
+    int32_t dt = (int32_t)(boot_ms - ref->boot_ms);
+    return ref->utc_ms + dt + (int64_t)dt * ref->drift_ppb / 1000000000;
+}
+
+#endif // __TIME_SYNC_H__
@@ -6,6 +6,7 @@
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "energy_meter.h"
 
 
 #include "lwip/err.h"
@@ -66,8 +67,13 @@ static void event_handler(void* arg, esp_event_base_t event_base,
                                 int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        energy_meter_set_state(ENERGY_DOMAIN_RADIO, ENERGY_METER_RADIO_RX);
         esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_STOP) {
+        energy_meter_set_state(ENERGY_DOMAIN_RADIO, ENERGY_METER_RADIO_OFF);
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        // 未关联时没有 modem sleep，接收机保持开启
+        energy_meter_set_state(ENERGY_DOMAIN_RADIO, ENERGY_METER_RADIO_RX);
         if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
             esp_wifi_connect();
             s_retry_num++;
@@ -80,6 +86,7 @@ static void event_handler(void* arg, esp_event_base_t event_base,
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "got ip:" IPSTR, IP2STR(&event->ip_info.ip));
         s_retry_num = 0;
+        energy_meter_set_state(ENERGY_DOMAIN_RADIO, ENERGY_METER_RADIO_CONNECTED);
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
     }
 }
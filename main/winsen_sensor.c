@@ -3,11 +3,21 @@
 #include "freertos/queue.h"
 #include "freertos/event_groups.h"
 #include "sensor.h"
+#include "sensor_scheduler.h"
+#include "sensor_filter.h"
+#include "sensor_health.h"
+#include "mem_profiler.h"
+#include "alloc_guard.h"
+#include "task_config.h"
+#include "jitter_bench.h"
+#include "alarm.h"
+#include "energy_meter.h"
 #include "winsen_sensor.h"
 #include "driver/uart.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include <time.h>
+#include <sys/param.h>
 #include "lvgl_screen_ui.h"
 #include "sys/lock.h"
 
@@ -17,21 +27,36 @@
 #define WINSEN_UART_RX_PIN       23
 #define WINSEN_UART_BUF_SIZE     128
 #define WINSEN_FRAME_SIZE        9       // WINSEN协议帧长度
+#define WINSEN_AUTO_FRAME_PERIOD_MS 1000  // 主动上传模式下传感器的上传周期
+#define WINSEN_UART_BYTE_US       (10 * 1000000 / WINSEN_UART_BAUD_RATE)  // 8N1 每字节传输时间
+#define WINSEN_UART_RX_TOUT_SYMBOLS 2     // 帧结束后空闲多少个字节时间即把数据交给驱动
+#define WINSEN_PRODUCER_STACK_SIZE 3072
+#define WINSEN_CONSUMER_STACK_SIZE 2048
+#define WINSEN_QUEUE_LEN          10
 
 static const char *TAG = "winsen_sensor";
 
 
 // 气体浓度修正系数，默认4，可通过 setter 修改
 static float winsen_ch2o_correction_factor = 1.0f;
+// 修正系数的 Q16 定点倒数，解析时只做整数乘法
+static uint32_t winsen_ch2o_correction_q16 = 65536; // 65536 / 1
 
 
 static QueueHandle_t winsen_sensor_queue = NULL;
 
+#if CONFIG_STATIC_ALLOCATION
+// 静态分配模式下任务栈、TCB 与队列存储都在 .bss 中，启动后不再使用堆
+static StaticQueue_t g_queue_struct;
+static uint8_t g_queue_storage[WINSEN_QUEUE_LEN * sizeof(sensor_sample_t)];
+static StackType_t g_producer_stack[WINSEN_PRODUCER_STACK_SIZE];
+static StaticTask_t g_producer_tcb;
+static StackType_t g_consumer_stack[WINSEN_CONSUMER_STACK_SIZE];
+static StaticTask_t g_consumer_tcb;
+#endif
 
-float g_winsen_hcho_mg = 0.0f;
-float g_winsen_hcho_ppb = 0.0f;
-uint32_t winsen_ch2o_timestamp = 0;
-static uint32_t winsen_dart_read_count = 0;
+
+static uint16_t winsen_dart_read_count = 0;
 
 // Dart协议相关命令
 static const uint8_t winsen_cmd_switch_to_qna[9] = {0xFF, 0x01, 0x78, 0x41, 0x00, 0x00, 0x00, 0x00, 0x46};
@@ -44,20 +69,43 @@ typedef enum {
 } winsen_sensor_mode_t;
 
 static winsen_sensor_mode_t g_winsen_sensor_mode = WINSEN_SENSOR_MODE_QNA;
+// 远程下发的目标模式；模式命令需要独占 UART，由生产任务在两次读取之间切换
+static volatile winsen_sensor_mode_t g_requested_mode = WINSEN_SENSOR_MODE_QNA;
 
 // 用于存储UART接收数据的静态缓冲区
 static uint8_t g_rx_buf[64] = {0};  // 增大缓冲区以容纳更多数据
+// 一次读取最多能解析出的完整帧数
+#define WINSEN_MAX_FRAMES_PER_READ  (sizeof(g_rx_buf) / WINSEN_FRAME_SIZE)
 static int g_rx_buf_pos = 0;  // 当前缓冲区位置，用于追加新数据
+// 缓冲区最后一个字节的到达时刻（esp_timer 微秒），用于给帧打时间戳
+static int64_t g_rx_arrival_us = 0;
 
 
 
-void  winsen_set_ch2o_correction_factor(float factor) {
-    if (factor > 0.1f && factor < 100.0f) {
+bool winsen_set_ch2o_correction_factor(float factor) {
+    if (factor >= SENSOR_CORRECTION_MIN && factor <= SENSOR_CORRECTION_MAX) {
         winsen_ch2o_correction_factor = factor;
+        winsen_ch2o_correction_q16 = sensor_correction_to_q16(factor);
         ESP_LOGI(TAG, "CH2O correction factor set to %.3f", factor);
-    } else {
-        ESP_LOGW(TAG, "Invalid correction factor: %.3f, ignored", factor);
+        return true;
     }
+    ESP_LOGW(TAG, "Invalid correction factor: %.3f, ignored", factor);
+    return false;
+}
+
+float winsen_get_ch2o_correction_factor(void)
+{
+    return winsen_ch2o_correction_factor;
+}
+
+void winsen_sensor_set_auto_mode(bool auto_upload)
+{
+    g_requested_mode = auto_upload ? WINSEN_SENSOR_MODE_AUTO : WINSEN_SENSOR_MODE_QNA;
+}
+
+bool winsen_sensor_get_auto_mode(void)
+{
+    return g_requested_mode == WINSEN_SENSOR_MODE_AUTO;
 }
 
 // 初始化UARET
@@ -75,6 +123,8 @@ void winsen_sensor_uart_init(void)
     uart_driver_install(WINSEN_UART_PORT_NUM, WINSEN_UART_BUF_SIZE * 2, 0, 0, NULL, 0);
     uart_param_config(WINSEN_UART_PORT_NUM, &uart_config);
     uart_set_pin(WINSEN_UART_PORT_NUM, WINSEN_UART_TX_PIN, WINSEN_UART_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    // 缩短接收超时，帧的末字节到达后约两个字节时间读取即可返回，时间戳误差随之固定且很小
+    uart_set_rx_timeout(WINSEN_UART_PORT_NUM, WINSEN_UART_RX_TOUT_SYMBOLS);
     ESP_LOGI(TAG, "Winsen sensor UART initialized");
 
 }
@@ -123,6 +173,7 @@ static int winsen_uart_send(const uint8_t *data, int len, const char *desc)
     
     // 发送数据
     int send_bytes = uart_write_bytes(WINSEN_UART_PORT_NUM, (const char*)data, len);
+    energy_meter_note_uart(len, WINSEN_UART_BAUD_RATE);
     
     // 检查发送结果
     if (send_bytes != len) {
@@ -241,15 +292,18 @@ static void winsen_sensor_init_mode(void)
 
 
 // 设置数据无效
-static void set_data_invalid(hcho_sensor_data_t *data)
+static void set_data_invalid(sensor_sample_t *data)
 {
-    data->ch2o_ugm3 = 0.0f;
-    data->ch2o_ppb = 0.0f;
-    data->timestamp = 0;
-    data->count = 0;
+    memset(data, 0, sizeof(*data));
 }
 
 
+// 记录刚读到的数据末字节的到达时刻：读取返回时刻减去驱动的接收超时延迟
+static inline void mark_rx_arrival(void)
+{
+    g_rx_arrival_us = esp_timer_get_time() - WINSEN_UART_RX_TOUT_SYMBOLS * WINSEN_UART_BYTE_US;
+}
+
 // 从UART读取原始数据
 static int winsen_sensor_read_raw(void)
 {
@@ -272,7 +326,16 @@ static int winsen_sensor_read_raw(void)
         vTaskDelay(pdMS_TO_TICKS(20));
         
         // 接收响应
-        int resp_len = winsen_uart_receive(g_rx_buf, sizeof(g_rx_buf), 1000, "read gas concentration response");
+        // 只等一帧的长度，响应到达即返回，而不是等满整个缓冲区直到超时
+        int resp_len = winsen_uart_receive(g_rx_buf, WINSEN_FRAME_SIZE, 1000, "read gas concentration response");
+        if (resp_len > 0) {
+            mark_rx_arrival();
+            // 取走可能跟在后面的多余字节，不再等待
+            int extra = uart_read_bytes(WINSEN_UART_PORT_NUM, g_rx_buf + resp_len, sizeof(g_rx_buf) - resp_len, 0);
+            if (extra > 0) {
+                resp_len += extra;
+            }
+        }
 
         if (resp_len <= 0) {
             ESP_LOGW(TAG, "QNA mode: No response received after sending command");
@@ -298,6 +361,15 @@ static int winsen_sensor_read_raw(void)
             // 清空移动后的未使用部分
             memset(g_rx_buf + g_rx_buf_pos, 0, sizeof(g_rx_buf) - g_rx_buf_pos);
         }
+
+        // 驱动缓冲区为空时阻塞等待下一帧的首字节，读取节奏跟随传感器，帧一到就被读走
+        size_t buffered = 0;
+        uart_get_buffered_data_len(WINSEN_UART_PORT_NUM, &buffered);
+        if (buffered == 0 &&
+            uart_read_bytes(WINSEN_UART_PORT_NUM, g_rx_buf + g_rx_buf_pos, 1, pdMS_TO_TICKS(2 * WINSEN_AUTO_FRAME_PERIOD_MS)) == 1) {
+            g_rx_buf_pos++;
+            mark_rx_arrival();
+        }
     }
     
     // 记录当前缓冲区位置，用于计算新接收的数据长度
@@ -328,12 +400,14 @@ static int winsen_sensor_read_raw(void)
     // 4. 连续多次读取都没有新数据
     while (g_rx_buf_pos < sizeof(g_rx_buf) && timeout-- > 0) {
         // 使用winsen_uart_receive函数读取数据
+        // 每次最多读一帧，凑满即返回，到达时刻的误差不超过接收超时
         int len = winsen_uart_receive(g_rx_buf + g_rx_buf_pos, 
-                                   sizeof(g_rx_buf) - g_rx_buf_pos, 
+                                   MIN((int)sizeof(g_rx_buf) - g_rx_buf_pos, WINSEN_FRAME_SIZE), 
                                    100, "auto polling");
-                                   
+
         if (len > 0) {
             g_rx_buf_pos += len;
+            mark_rx_arrival();
             continuous_empty_reads = 0;  // 重置空读取计数
             
             // 如果之前没有找到帧头，检查新数据中是否有帧头
@@ -390,7 +464,7 @@ static int winsen_sensor_read_raw(void)
 }
 
 // 处理接收到的数据帧
-static bool winsen_sensor_process_frame(const uint8_t *frame, hcho_sensor_data_t *data)
+static sensor_health_event_t winsen_sensor_process_frame(const uint8_t *frame, sensor_sample_t *data)
 {
     uint8_t checksum = winsen_checksum(frame, WINSEN_FRAME_SIZE);
     if (checksum != frame[WINSEN_FRAME_SIZE-1]) {
@@ -398,78 +472,48 @@ static bool winsen_sensor_process_frame(const uint8_t *frame, hcho_sensor_data_t
         bytes_to_hex_str(frame, WINSEN_FRAME_SIZE, hex_str, sizeof(hex_str));
         ESP_LOGW(TAG, "Checksum error: %02X != %02X, frame: %s", frame[WINSEN_FRAME_SIZE-1], checksum, hex_str);
         set_data_invalid(data);
-        return false;
+        return SENSOR_EVT_CHECKSUM;
     }
     // 简化日志，减少栈使用
     ESP_LOGD(TAG, "Frame: %02X %02X %02X %02X...", frame[0], frame[1], frame[2], frame[3]);
-    
-    // 处理不同的帧类型
-    if (g_winsen_sensor_mode == WINSEN_SENSOR_MODE_QNA) {
-        // 问答模式：期望收到的是读取气体浓度的响应帧 (0x86)
-        if (frame[1] == 0x86) {
-            // 读取气体浓度帧 (response to 读取气体浓度)
-            uint16_t ch2o_ugm3 = frame[2] * 256 + frame[3];  // ug/m3
-            uint16_t ch2o_ppb  = frame[6] * 256 + frame[7];  // ppb
-            // 修正
-            data->ch2o_ugm3 = (float)ch2o_ugm3 / winsen_ch2o_correction_factor;
-            data->ch2o_ppb  = (float)ch2o_ppb / winsen_ch2o_correction_factor;
-            data->timestamp = (uint32_t)(esp_timer_get_time() / 1000000ULL);
-            winsen_dart_read_count++;
-            data->count = winsen_dart_read_count;
-            ESP_LOGI(TAG, "CH2O (Q&A): raw=%u ug/m3, %u ppb, corrected=%.2f ug/m3, %.2f ppb, factor=%.2f", 
-                ch2o_ugm3, ch2o_ppb, data->ch2o_ugm3, data->ch2o_ppb, winsen_ch2o_correction_factor);
-            return true;
-        } else {
-            ESP_LOGW(TAG, "Q&A: Unexpected frame: 0x%02X", frame[1]);
-        }
+
+    int32_t ppb_value;   // 修正后的定点 ppb
+    uint8_t flags = SAMPLE_FLAG_VALID;
+
+    if (frame[1] == 0x86) {
+        // 读取气体浓度帧 (response to 读取气体浓度)，切换模式时 AUTO 下也可能收到
+        uint16_t ch2o_ppb = frame[6] * 256 + frame[7];  // ppb
+        ppb_value = sensor_hcho_apply_correction(ch2o_ppb, winsen_ch2o_correction_q16);
+        ESP_LOGI(TAG, "CH2O (0x86): raw=%u ppb, corrected=%ld.%01ld ppb",
+                 ch2o_ppb, (long)(ppb_value / SENSOR_HCHO_SCALE), (long)(ppb_value % SENSOR_HCHO_SCALE));
+    } else if (frame[1] == 0x17 && g_winsen_sensor_mode == WINSEN_SENSOR_MODE_AUTO) {
+        // 主动上传的数据帧处理
+        // 根据协议，气体浓度在位置4和5
+        uint16_t gas_value = frame[4] * 256 + frame[5];  // 气体浓度
+        uint16_t full_scale = frame[6] * 256 + frame[7]; // 满量程
+        // 单位在位置2，0x04表示ppb，否则为ug/m3
+        int32_t corrected = sensor_hcho_apply_correction(gas_value, winsen_ch2o_correction_q16);
+        ppb_value = (frame[2] == 0x04) ? corrected : sensor_hcho_ugm3_to_ppb(corrected);
+        flags |= SAMPLE_FLAG_AUTO;
+        ESP_LOGI(TAG, "CH2O (AUTO): raw=%u, corrected=%ld.%01ld ppb, full_scale=%u",
+                 gas_value, (long)(ppb_value / SENSOR_HCHO_SCALE), (long)(ppb_value % SENSOR_HCHO_SCALE), full_scale);
     } else {
-        // 自动上传模式：期望收到的是主动上传的数据帧 (0x17)
-        if (frame[1] == 0x17) {
-            // 主动上传的数据帧处理
-            // 根据协议，气体浓度在位置4和5
-            uint16_t gas_value = frame[4] * 256 + frame[5];  // 气体浓度
-            uint16_t full_scale = frame[6] * 256 + frame[7]; // 满量程
-            // 单位在位置2，0x04表示ppb
-            bool is_ppb = (frame[2] == 0x04);
-            // 计算实际值并修正
-            if (is_ppb) {
-                data->ch2o_ppb = (float)gas_value / winsen_ch2o_correction_factor;
-                data->ch2o_ugm3 = data->ch2o_ppb * 1.23f;
-            } else {
-                data->ch2o_ugm3 = (float)gas_value / winsen_ch2o_correction_factor;
-                data->ch2o_ppb = data->ch2o_ugm3 / 1.23f;
-            }
-            data->timestamp = (uint32_t)(esp_timer_get_time() / 1000000ULL);
-            winsen_dart_read_count++;
-            data->count = winsen_dart_read_count;
-            ESP_LOGI(TAG, "CH2O (AUTO): raw=%u, corrected=%.2f ug/m3, %.2f ppb, factor=%.2f, full_scale=%u", 
-                gas_value, data->ch2o_ugm3, data->ch2o_ppb, winsen_ch2o_correction_factor, full_scale);
-            return true;
-        } else if (frame[1] == 0x86) {
-            // 也可能收到0x86帧，尤其是在切换模式时
-            uint16_t ch2o_ugm3 = frame[2] * 256 + frame[3];
-            uint16_t ch2o_ppb  = frame[6] * 256 + frame[7];
-            data->ch2o_ugm3 = (float)ch2o_ugm3 / winsen_ch2o_correction_factor;
-            data->ch2o_ppb  = (float)ch2o_ppb / winsen_ch2o_correction_factor;
-            data->timestamp = (uint32_t)(esp_timer_get_time() / 1000000ULL);
-            winsen_dart_read_count++;
-            data->count = winsen_dart_read_count;
-            ESP_LOGI(TAG, "CH2O (0x86/AUTO): raw=%u ug/m3, %u ppb, corrected=%.2f ug/m3, %.2f ppb, factor=%.2f", 
-                ch2o_ugm3, ch2o_ppb, data->ch2o_ugm3, data->ch2o_ppb, winsen_ch2o_correction_factor);
-            return true;
-        }
+        // 校验通过但类型不符，通常是传感器处于另一种工作模式
+        ESP_LOGW(TAG, "Unhandled frame type: 0x%02X", frame[1]);
+        set_data_invalid(data);
+        return SENSOR_EVT_WRONG_MODE;
     }
-    
-    ESP_LOGW(TAG, "Unhandled frame type: 0x%02X", frame[1]);
-    set_data_invalid(data);
-    return false;
+
+    winsen_dart_read_count++;
+    sensor_sample_fill(data, SENSOR_ID_WINSEN, SENSOR_CH_HCHO, ppb_value, winsen_dart_read_count, flags);
+    return SENSOR_EVT_FRAME_OK;
 }
 
-// 读取并处理传感器数据
-static bool winsen_sensor_read(hcho_sensor_data_t *data)
+// 读取并处理传感器数据，返回本次读取对应的健康事件
+// 本次读取到的每个有效帧都作为独立样本写入 frames，数量写入 frame_count
+static sensor_health_event_t winsen_sensor_read(sensor_sample_t *frames, int max_frames, int *frame_count)
 {
-    // 首先清空数据
-    set_data_invalid(data);
+    *frame_count = 0;
     
     // 从传感器读取原始数据
     // 在Q&A模式下，dart_sensor_read_raw会发送读取命令，然后等待响应
@@ -481,15 +525,17 @@ static bool winsen_sensor_read(hcho_sensor_data_t *data)
         } else {
             ESP_LOGW(TAG, "AUTO mode: Buffer too short (%d bytes)", total);
         }
-        return false;
+        return SENSOR_EVT_TIMEOUT;
     }
     
     // 查找并处理所有有效数据帧
     uint8_t frame[9];
     bool found_frame = false;
+    sensor_health_event_t frame_error = SENSOR_EVT_CHECKSUM;  // 没有有效帧时上报的错误类型
+    bool bad_frame_seen = false;
     int last_valid_frame_end = -1;  // 最后一个有效帧的结束位置
     int frames_processed = 0;       // 处理的帧数量
-    hcho_sensor_data_t temp_data;   // 临时数据，用于存储每一帧的数据
+    sensor_sample_t temp_data;   // 临时数据，用于存储每一帧的数据
     char hex_str[64];               // 用于日志打印
     
     // 循环查找所有帧头0xFF并处理所有有效帧
@@ -499,13 +545,16 @@ static bool winsen_sensor_read(hcho_sensor_data_t *data)
             if (i + 9 <= total) {
                 // 有足够数据构成完整帧
                 memcpy(frame, g_rx_buf + i, 9);
-                if (winsen_sensor_process_frame(frame, &temp_data)) {
+                sensor_health_event_t evt = winsen_sensor_process_frame(frame, &temp_data);
+                if (evt == SENSOR_EVT_FRAME_OK) {
                     // 记录有效帧的结束位置
                     last_valid_frame_end = i + 9;
                     frames_processed++;
                     
-                    // 将最新的有效帧数据复制到输出数据中
-                    memcpy(data, &temp_data, sizeof(hcho_sensor_data_t));
+                    // 每个有效帧都保留为独立样本，而不是用后一帧覆盖前一帧
+                    if (*frame_count < max_frames) {
+                        frames[(*frame_count)++] = temp_data;
+                    }
                     found_frame = true;
                     
                     // 在问答模式下，只需要处理第一个有效帧
@@ -513,23 +562,28 @@ static bool winsen_sensor_read(hcho_sensor_data_t *data)
                         break;
                     }
                     // 注意：在AUTO模式下，会继续搜索，以处理所有可能的帧
+                    // 跳过本帧剩余字节，避免把帧内的0xFF误当作帧头
+                    i += WINSEN_FRAME_SIZE - 1;
                 } else {
                     // 校验和错误或不支持的帧类型，打印调试信息
+                    // 模式不符优先上报，它需要的恢复动作与校验错误不同
+                    if (evt == SENSOR_EVT_WRONG_MODE || !bad_frame_seen) {
+                        frame_error = evt;
+                    }
+                    bad_frame_seen = true;
                     bytes_to_hex_str(g_rx_buf + i, 9, hex_str, sizeof(hex_str));
                     ESP_LOGD(TAG, "Invalid frame at pos %d: %s", i, hex_str);
                 }
             } else {
                 // 发现帧头但数据不足以构成完整帧，保留这些数据以便下次读取
                 ESP_LOGI(TAG, "Incomplete frame at end of buffer, keeping %d bytes for next read", total - i);
-                
-                // 如果这是buffer中唯一的帧头，那么将它移到buffer开始位置
-                if (i > 0) {
-                    memmove(g_rx_buf, g_rx_buf + i, total - i);
-                    g_rx_buf_pos = total - i;
-                    memset(g_rx_buf + g_rx_buf_pos, 0, sizeof(g_rx_buf) - g_rx_buf_pos);
+                // 只收到半帧说明本周期内帧还没到齐，按超时而不是校验错误统计
+                if (!found_frame && !bad_frame_seen) {
+                    frame_error = SENSOR_EVT_TIMEOUT;
                 }
                 
                 // 不再继续查找，保留不完整的帧
+                // 半帧的搬移统一由下面的缓冲区整理完成，这里提前搬移会让其按旧偏移再次搬移而被清零
                 break;
             }
         }
@@ -632,8 +686,29 @@ static bool winsen_sensor_read(hcho_sensor_data_t *data)
         }
     }
     
-    // 没有有效帧则返回false
-    return found_frame;
+    // 最后一个有效帧的时间戳取其末字节的到达时刻：缓冲区末字节到达时刻减去其后字节的传输时间；
+    // 主动上传模式下积压的更早帧按上传周期回推
+    if (*frame_count > 0) {
+        int64_t end_us = g_rx_arrival_us - (int64_t)(total - last_valid_frame_end) * WINSEN_UART_BYTE_US;
+        uint32_t last_ms = (uint32_t)(end_us / 1000);
+        for (int k = 0; k < *frame_count; k++) {
+            frames[k].timestamp_ms = last_ms - (uint32_t)(*frame_count - 1 - k) * WINSEN_AUTO_FRAME_PERIOD_MS;
+        }
+    }
+
+    // 没有有效帧则上报错误类型：有数据但无法成帧也按校验错误处理
+    return found_frame ? SENSOR_EVT_FRAME_OK : frame_error;
+}
+
+// 按故障类型执行恢复动作
+static void winsen_sensor_recover(sensor_fault_t fault)
+{
+    ESP_LOGW(TAG, "Recovering Winsen sensor from fault: %s", sensor_fault_name(fault));
+    // 丢弃可能已损坏的半帧数据
+    g_rx_buf_pos = 0;
+    memset(g_rx_buf, 0, sizeof(g_rx_buf));
+    // 重新下发工作模式命令（会先清空UART接收缓冲区）
+    winsen_sensor_init_mode();
 }
 
 static void winsen_sensor_producer_task(void *pvParameters) {
@@ -650,43 +725,92 @@ static void winsen_sensor_producer_task(void *pvParameters) {
     }
     vTaskDelay(pdMS_TO_TICKS(2000));
 
-    hcho_sensor_data_t data;
-    TickType_t last_read_time = xTaskGetTickCount();
+    sensor_sample_t frames[WINSEN_MAX_FRAMES_PER_READ];
+    int frame_count = 0;
+    sensor_aggregate_t agg;
+    sensor_aggregate_reset(&agg);
+    sensor_scheduler_t *sched = sensor_scheduler_get(SENSOR_ID_WINSEN);
+    sensor_scheduler_config_t sched_cfg;
+    sensor_scheduler_default_config(&sched_cfg);
+    sensor_scheduler_init(sched, &sched_cfg);
+    sensor_health_t *health = sensor_health_get(SENSOR_ID_WINSEN);
+    sensor_health_init(health, SENSOR_ID_WINSEN, (uint32_t)(esp_timer_get_time() / 1000));
     
+    // 按绝对节拍调度，读取耗时的波动不会累积到采样周期里
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t delay_ms = 0;
     while (1) {
-        // 读取传感器数据
-        bool data_valid = winsen_sensor_read(&data);
+        if (g_requested_mode != g_winsen_sensor_mode) {
+            g_winsen_sensor_mode = g_requested_mode;
+            g_rx_buf_pos = 0;
+            winsen_sensor_init_mode();
+            last_wake = xTaskGetTickCount();
+        }
+        jitter_bench_mark(SENSOR_ID_WINSEN, delay_ms ? delay_ms : WINSEN_AUTO_FRAME_PERIOD_MS);
+
+        // 读取传感器数据，并将结果交给健康监督
+        sensor_health_event_t evt = winsen_sensor_read(frames, WINSEN_MAX_FRAMES_PER_READ, &frame_count);
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        sensor_health_state_t state = sensor_health_update(health, evt, now_ms);
         
-        // 如果数据有效，则发送到队列
-        if (data_valid) {
-            xQueueSend(winsen_sensor_queue, &data, portMAX_DELAY);
-
-            // 更新最后成功读取时间
-            last_read_time = xTaskGetTickCount();
-        } else {           
-            // 如果长时间没有有效数据，可能需要重新初始化模式
-            if ((xTaskGetTickCount() - last_read_time) > pdMS_TO_TICKS(10000)) {  // 10秒无数据
-                ESP_LOGW(TAG, "No valid data for 10 seconds, re-initializing sensor mode");
-                winsen_sensor_init_mode();
-                last_read_time = xTaskGetTickCount();
+        // 本次读到的每一帧都交给调度器；默认在调度器的每个采样窗口内合并为一个
+        // mean/min/max 样本，关闭聚合时主动上传模式逐帧发布
+        for (int k = 0; k < frame_count; k++) {
+            sensor_sample_t *data = &frames[k];
+            data->flags |= sensor_health_sample_flags(health);
+            // 告警在调度与聚合之前逐帧判定，不受发布窗口影响
+            alarm_evaluate(data);
+            bool due = sensor_scheduler_feed(sched, data);
+#if CONFIG_SENSOR_AUTO_AGGREGATE
+            sensor_aggregate_add(&agg, data);
+            if (due) {
+                sensor_sample_t mean;
+                uint16_t frames_in = sensor_aggregate_take(&agg, &mean);
+                xQueueSend(winsen_sensor_queue, &mean, portMAX_DELAY);
+                sensor_count_frames(SENSOR_ID_WINSEN, 0, frames_in);
+                sensor_scheduler_note_delivered(sched, mean.timestamp_ms);
+            }
+#else
+            if (due || g_winsen_sensor_mode == WINSEN_SENSOR_MODE_AUTO) {
+                xQueueSend(winsen_sensor_queue, data, portMAX_DELAY);
+                sensor_count_frames(SENSOR_ID_WINSEN, 0, 1);
+                sensor_scheduler_note_delivered(sched, data->timestamp_ms);
             }
+#endif
+            ESP_LOGD(TAG, "Frame seq %u, interval %lu ms, rate %lu mHz", data->seq,
+                     (unsigned long)sensor_scheduler_interval_ms(sched), (unsigned long)sensor_scheduler_rate_mhz(sched));
+        }
+        sensor_count_frames(SENSOR_ID_WINSEN, frame_count, 0);
+        energy_meter_note_uart(frame_count * WINSEN_FRAME_SIZE, WINSEN_UART_BAUD_RATE);
+
+        // 故障时按指数退避执行恢复，而不是固定周期反复重新初始化
+        if (sensor_health_recovery_due(health, now_ms)) {
+            winsen_sensor_recover(health->fault);
+            sensor_health_recovery_done(health, (uint32_t)(esp_timer_get_time() / 1000));
         }
         
-        // 等待时间根据模式调整
-        TickType_t delay_time = (g_winsen_sensor_mode == WINSEN_SENSOR_MODE_QNA) ? 
-                                pdMS_TO_TICKS(5000) : pdMS_TO_TICKS(1000);
-        vTaskDelay(delay_time);
+        // 出现异常时按最快速率探测，两个帧周期内即可确认故障或恢复
+        // 问答模式按调度器间隔查询；主动上传模式跟随传感器每秒一帧的节奏读取
+        if (state == SENSOR_HEALTH_DEGRADED || state == SENSOR_HEALTH_FAILED) {
+            delay_ms = sched->cfg.min_interval_ms;
+        } else {
+            // 主动上传模式下读取本身阻塞等待下一帧，节奏由传感器决定，不再额外延时
+            delay_ms = (g_winsen_sensor_mode == WINSEN_SENSOR_MODE_QNA) ? sensor_scheduler_interval_ms(sched) : 0;
+        }
+        // 读取或恢复超过一个周期时不补跑，从当前时刻重新对齐节拍
+        if (delay_ms == 0 || xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(delay_ms)) == pdFALSE) {
+            last_wake = xTaskGetTickCount();
+        }
     }
 }
 
 static void winsen_sensor_consumer_task(void *pvParameters) {
-    hcho_sensor_data_t data;
+    sensor_sample_t data;
     while (1) {
         if (xQueueReceive(winsen_sensor_queue, &data, portMAX_DELAY) == pdTRUE) {
-            g_winsen_hcho_mg = data.ch2o_ugm3 * 0.001f;
-            g_winsen_hcho_ppb = data.ch2o_ppb;
-            winsen_ch2o_timestamp = data.timestamp;
-            ESP_LOGD(TAG, "Queue received: %.3f mg/m3, %.1f ppb, timestamp: %lu s", g_winsen_hcho_mg, g_winsen_hcho_ppb, (unsigned long)winsen_ch2o_timestamp);
+            sensor_publish(&data);
+            ESP_LOGD(TAG, "Queue received: %ld ug/m3, seq: %u, timestamp: %lu ms",
+                     (long)sensor_hcho_to_ugm3(data.value), data.seq, (unsigned long)data.timestamp_ms);
         }   
         vTaskDelay(pdMS_TO_TICKS(10)); // 避免任务饥饿
     }
@@ -697,12 +821,36 @@ void winsen_sensor_start(void)
 {
     winsen_sensor_uart_init();
 
+    sensor_filter_config_t filter_cfg;
+    sensor_filter_default_config(&filter_cfg);
+    sensor_filter_init(sensor_filter_get(SENSOR_ID_WINSEN), &filter_cfg);
+
     if (!winsen_sensor_queue) {
-        winsen_sensor_queue = xQueueCreate(10, sizeof(hcho_sensor_data_t));
+#if CONFIG_STATIC_ALLOCATION
+        winsen_sensor_queue = xQueueCreateStatic(WINSEN_QUEUE_LEN, sizeof(sensor_sample_t), g_queue_storage, &g_queue_struct);
+#else
+        winsen_sensor_queue = xQueueCreate(WINSEN_QUEUE_LEN, sizeof(sensor_sample_t));
+#endif
     }
     vTaskDelay(pdMS_TO_TICKS(2000));
 
     // 增加任务栈大小，避免栈溢出
-    xTaskCreate(winsen_sensor_producer_task, "winsen_sensor_produce_task", 3072, NULL, 5, NULL);
-    xTaskCreate(winsen_sensor_consumer_task, "winsen_sensor_consumer_task", 2048, NULL, 4, NULL);
+    TaskHandle_t producer = NULL, consumer = NULL;
+#if CONFIG_STATIC_ALLOCATION
+    producer = xTaskCreateStaticPinnedToCore(winsen_sensor_producer_task, "winsen_sensor_produce_task", WINSEN_PRODUCER_STACK_SIZE,
+                                             NULL, TASK_PRIO_SENSOR_PRODUCER, g_producer_stack, &g_producer_tcb,
+                                             TASK_CORE_SENSOR);
+    consumer = xTaskCreateStaticPinnedToCore(winsen_sensor_consumer_task, "winsen_sensor_consumer_task", WINSEN_CONSUMER_STACK_SIZE,
+                                             NULL, TASK_PRIO_SENSOR_CONSUMER, g_consumer_stack, &g_consumer_tcb,
+                                             TASK_CORE_SENSOR);
+#else
+    xTaskCreatePinnedToCore(winsen_sensor_producer_task, "winsen_sensor_produce_task", WINSEN_PRODUCER_STACK_SIZE, NULL,
+                            TASK_PRIO_SENSOR_PRODUCER, &producer, TASK_CORE_SENSOR);
+    xTaskCreatePinnedToCore(winsen_sensor_consumer_task, "winsen_sensor_consumer_task", WINSEN_CONSUMER_STACK_SIZE, NULL,
+                            TASK_PRIO_SENSOR_CONSUMER, &consumer, TASK_CORE_SENSOR);
+#endif
+    alloc_guard_track_task(producer);
+    alloc_guard_track_task(consumer);
+    mem_profiler_register_task(producer, WINSEN_PRODUCER_STACK_SIZE);
+    mem_profiler_register_task(consumer, WINSEN_CONSUMER_STACK_SIZE);
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #define __WINSEN_SENSOR_H__
 
 #include <stdint.h>
-
-extern float g_dart_hcho_mg;
-extern uint32_t g_dart_hcho_timestamp;
+#include <stdbool.h>
 
 void winsen_sensor_init(void);
 void winsen_sensor_start(void); 
+// 修正系数须在 [SENSOR_CORRECTION_MIN, SENSOR_CORRECTION_MAX] 内，否则忽略并返回 false
+bool winsen_set_ch2o_correction_factor(float factor);
+float winsen_get_ch2o_correction_factor(void);
+// 请求切换工作模式（true 为主动上传，false 为问答），生产任务在下一轮读取前下发模式命令
+void winsen_sensor_set_auto_mode(bool auto_upload);
+bool winsen_sensor_get_auto_mode(void);
 
 #endif // __WINSEN_SENSOR_H__
\ No newline at end of file
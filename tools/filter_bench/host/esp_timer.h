@@ -0,0 +1,10 @@
+#ifndef __HOST_ESP_TIMER_H__
+#define __HOST_ESP_TIMER_H__
+
+#include <stdint.h>
+
+// 主机构建用的 esp_timer.h，由 filter_bench.c 以单调时钟实现
+
+int64_t esp_timer_get_time(void);
+
+#endif // __HOST_ESP_TIMER_H__
@@ -0,0 +1,12 @@
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+// 主机构建用的最小 FreeRTOS.h：单线程运行，临界区为空操作
+
+typedef int portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+
+#endif // __HOST_FREERTOS_H__
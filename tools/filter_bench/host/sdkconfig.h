@@ -0,0 +1,17 @@
+#ifndef __HOST_SDKCONFIG_H__
+#define __HOST_SDKCONFIG_H__
+
+// 主机构建用的配置，取值同 Kconfig 默认值；可用 make CFLAGS+=-DHOST_FILTER_WINDOW=9 之类覆盖
+
+#ifndef HOST_FILTER_WINDOW
+#define HOST_FILTER_WINDOW  5
+#endif
+
+#define CONFIG_SENSOR_BUS                       0
+#define CONFIG_SENSOR_FILTER_WINDOW             HOST_FILTER_WINDOW
+#define CONFIG_SENSOR_FILTER_HAMPEL_K_X10       30
+#define CONFIG_SENSOR_FILTER_MIN_DEVIATION_PPB  3
+#define CONFIG_SENSOR_FILTER_EMA_ALPHA_Q8       0
+#define CONFIG_SENSOR_FILTER_SELFTEST           1
+
+#endif // __HOST_SDKCONFIG_H__
@@ -0,0 +1,409 @@
+/**
+ * 内存历史扫描基准：列式存储（main/history_columns.c）对比两种结构体数组（AoS）布局
+ *
+ * 用法: columns_bench [-n 样本数列表] [-r 重复次数] [-w 查询区间占比%]
+ * 例如: columns_bench -n 4096,65536,1048576 -r 20 -w 50
+ *
+ *   legacy   旧的 hcho_sensor_data_t：两个 float 浓度 + 时间戳 + 计数，16 字节/样本
+ *   sample   sensor_sample_t：定点值 + 时间戳 + 序号/标志，12 字节/样本
+ *   raw      history_columns_t 的值列，不使用块摘要，逐个读取（只比较布局）
+ *   columns  history_columns_aggregate / history_columns_percentile，整块落在区间内时使用块摘要
+ *
+ * 四种布局保存相同的 1 Hz 合成序列，对最近 w% 的时间区间求均值、最大值与 P95。
+ * AoS 同样先按时间二分定位区间；legacy/sample/raw 三者的差别只在于读取每个值时带入缓存的字节数。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "history_columns.h"
+
+#define BENCH_T0_MS     1000u
+#define BENCH_PERIOD_MS 1000u
+#define BENCH_PCT       95
+
+// 旧数据结构，与最初的 sensor.h 相同
+typedef struct {
+    float    ch2o_ugm3;
+    float    ch2o_ppb;
+    uint32_t timestamp;
+    uint32_t count;
+} legacy_record_t;
+
+// 与 sensor_sample_t 相同的布局
+typedef struct {
+    uint32_t timestamp_ms;
+    int32_t  value;
+    uint16_t seq;
+    uint8_t  ids;
+    uint8_t  flags;
+} sample_record_t;
+
+typedef struct {
+    double mean_us;
+    double max_us;
+    double pct_us;
+    double mean;
+    double max;
+    double pct;
+} bench_result_t;
+
+static volatile double g_sink;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 确定性的合成浓度：缓慢漂移 + 噪声，定点 0.1 ppb
+static int32_t synth_value(uint32_t i, uint32_t *rng)
+{
+    *rng = *rng * 1664525u + 1013904223u;
+    return 300 + (int32_t)((i / 600) % 200) + (int32_t)((*rng >> 16) % 41) - 20;
+}
+
+/* ---------- legacy AoS ---------- */
+
+static size_t legacy_lower_bound(const legacy_record_t *r, size_t n, uint32_t t_s)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (r[mid].timestamp < t_s) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void bench_legacy(const legacy_record_t *r, size_t n, uint32_t from_ms, int reps, bench_result_t *res)
+{
+    size_t lo = legacy_lower_bound(r, n, from_ms / 1000);
+    double t = now_us();
+    for (int k = 0; k < reps; k++) {
+        double sum = 0;
+        for (size_t i = lo; i < n; i++) {
+            sum += r[i].ch2o_ppb;
+        }
+        res->mean = sum / (double)(n - lo);
+        g_sink = res->mean;
+    }
+    res->mean_us = (now_us() - t) / reps;
+
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        float max = r[lo].ch2o_ppb;
+        for (size_t i = lo; i < n; i++) {
+            max = (r[i].ch2o_ppb > max) ? r[i].ch2o_ppb : max;
+        }
+        res->max = max;
+        g_sink = max;
+    }
+    res->max_us = (now_us() - t) / reps;
+
+    // 与列式相同的算法：在值域上二分计数，浮点值按 0.1 ppb 量化后比较
+    size_t count = n - lo;
+    size_t rank = (BENCH_PCT * count + 99) / 100;
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        float fmin = r[lo].ch2o_ppb, fmax = fmin;
+        for (size_t i = lo; i < n; i++) {
+            fmin = (r[i].ch2o_ppb < fmin) ? r[i].ch2o_ppb : fmin;
+            fmax = (r[i].ch2o_ppb > fmax) ? r[i].ch2o_ppb : fmax;
+        }
+        long a = (long)(fmin * 10 - 0.5f), b = (long)(fmax * 10 + 0.5f);
+        while (a < b) {
+            long mid = a + (b - a) / 2;
+            float x = (mid + 0.5f) / 10;
+            size_t le = 0;
+            for (size_t i = lo; i < n; i++) {
+                le += (r[i].ch2o_ppb <= x);
+            }
+            if (le >= rank) {
+                b = mid;
+            } else {
+                a = mid + 1;
+            }
+        }
+        res->pct = a / 10.0;
+        g_sink = res->pct;
+    }
+    res->pct_us = (now_us() - t) / reps;
+}
+
+/* ---------- sensor_sample_t AoS ---------- */
+
+static size_t sample_lower_bound(const sample_record_t *r, size_t n, uint32_t t_ms)
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (r[mid].timestamp_ms < t_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void bench_sample(const sample_record_t *r, size_t n, uint32_t from_ms, int reps, bench_result_t *res)
+{
+    size_t lo = sample_lower_bound(r, n, from_ms);
+    double t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int64_t sum = 0;
+        for (size_t i = lo; i < n; i++) {
+            sum += r[i].value;
+        }
+        res->mean = (double)sum / (double)(n - lo) / 10;
+        g_sink = res->mean;
+    }
+    res->mean_us = (now_us() - t) / reps;
+
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int32_t max = INT32_MIN;
+        for (size_t i = lo; i < n; i++) {
+            max = (r[i].value > max) ? r[i].value : max;
+        }
+        res->max = max / 10.0;
+        g_sink = res->max;
+    }
+    res->max_us = (now_us() - t) / reps;
+
+    size_t count = n - lo;
+    size_t rank = (BENCH_PCT * count + 99) / 100;
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int32_t vmin = INT32_MAX, vmax = INT32_MIN;
+        for (size_t i = lo; i < n; i++) {
+            vmin = (r[i].value < vmin) ? r[i].value : vmin;
+            vmax = (r[i].value > vmax) ? r[i].value : vmax;
+        }
+        int64_t a = vmin, b = vmax;
+        while (a < b) {
+            int64_t mid = a + (b - a) / 2;
+            size_t le = 0;
+            for (size_t i = lo; i < n; i++) {
+                le += (r[i].value <= mid);
+            }
+            if (le >= rank) {
+                b = mid;
+            } else {
+                a = mid + 1;
+            }
+        }
+        res->pct = a / 10.0;
+        g_sink = res->pct;
+    }
+    res->pct_us = (now_us() - t) / reps;
+}
+
+/* ---------- columns ---------- */
+
+static void bench_columns(const history_columns_t *h, uint32_t from_ms, int reps, bench_result_t *res)
+{
+    history_col_agg_t agg;
+    double t = now_us();
+    for (int k = 0; k < reps; k++) {
+        history_columns_aggregate(h, from_ms, UINT32_MAX, &agg);
+        res->mean = (double)agg.sum / agg.count / 10;
+        g_sink = res->mean;
+    }
+    res->mean_us = (now_us() - t) / reps;
+
+    // 最大值与均值共用一次聚合；单独计时以便与 AoS 对照
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        history_columns_aggregate(h, from_ms, UINT32_MAX, &agg);
+        res->max = agg.max / 10.0;
+        g_sink = res->max;
+    }
+    res->max_us = (now_us() - t) / reps;
+
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int32_t p;
+        history_columns_percentile(h, from_ms, UINT32_MAX, BENCH_PCT, &p);
+        res->pct = p / 10.0;
+        g_sink = res->pct;
+    }
+    res->pct_us = (now_us() - t) / reps;
+}
+
+// 不用块摘要、直接顺序读取值列，只体现存储布局本身的差别
+static void bench_columns_raw(const history_columns_t *h, uint32_t from_ms, int reps, bench_result_t *res)
+{
+    // 第一个与区间相交的块及其起始下标；样本按时间追加，之后的块全部落在区间内
+    uint16_t first = 0, first_lo = 0;
+    for (uint16_t b = 0; b < h->nblocks; b++) {
+        const history_col_summary_t *s = &h->summary[b];
+        if (s->count && s->t_last_ms >= from_ms) {
+            first = b;
+            while (first_lo < s->count && h->blocks[b].t_ms[first_lo] < from_ms) {
+                first_lo++;
+            }
+            break;
+        }
+    }
+    size_t count = 0;
+    for (uint16_t b = first; b < h->nblocks; b++) {
+        count += h->summary[b].count - (b == first ? first_lo : 0);
+    }
+
+    double t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int64_t sum = 0;
+        for (uint16_t b = first; b < h->nblocks; b++) {
+            const int32_t *v = h->blocks[b].value;
+            for (uint16_t j = (b == first) ? first_lo : 0; j < h->summary[b].count; j++) {
+                sum += v[j];
+            }
+        }
+        res->mean = (double)sum / (double)count / 10;
+        g_sink = res->mean;
+    }
+    res->mean_us = (now_us() - t) / reps;
+
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int32_t max = INT32_MIN;
+        for (uint16_t b = first; b < h->nblocks; b++) {
+            const int32_t *v = h->blocks[b].value;
+            for (uint16_t j = (b == first) ? first_lo : 0; j < h->summary[b].count; j++) {
+                max = (v[j] > max) ? v[j] : max;
+            }
+        }
+        res->max = max / 10.0;
+        g_sink = res->max;
+    }
+    res->max_us = (now_us() - t) / reps;
+
+    size_t rank = (BENCH_PCT * count + 99) / 100;
+    t = now_us();
+    for (int k = 0; k < reps; k++) {
+        int32_t vmin = INT32_MAX, vmax = INT32_MIN;
+        for (uint16_t b = first; b < h->nblocks; b++) {
+            const int32_t *v = h->blocks[b].value;
+            for (uint16_t j = (b == first) ? first_lo : 0; j < h->summary[b].count; j++) {
+                vmin = (v[j] < vmin) ? v[j] : vmin;
+                vmax = (v[j] > vmax) ? v[j] : vmax;
+            }
+        }
+        int64_t a = vmin, z = vmax;
+        while (a < z) {
+            int64_t mid = a + (z - a) / 2;
+            size_t le = 0;
+            for (uint16_t b = first; b < h->nblocks; b++) {
+                const int32_t *v = h->blocks[b].value;
+                for (uint16_t j = (b == first) ? first_lo : 0; j < h->summary[b].count; j++) {
+                    le += (v[j] <= mid);
+                }
+            }
+            if (le >= rank) {
+                z = mid;
+            } else {
+                a = mid + 1;
+            }
+        }
+        res->pct = a / 10.0;
+        g_sink = res->pct;
+    }
+    res->pct_us = (now_us() - t) / reps;
+}
+
+static void print_row(size_t n, const char *name, size_t bytes, const bench_result_t *res, const bench_result_t *base)
+{
+    printf("%9zu %-8s %9zu %10.1f %10.1f %10.1f %6.2fx %8.2f %8.1f %8.1f\n", n, name, bytes / 1024, res->mean_us,
+           res->max_us, res->pct_us, base->mean_us / res->mean_us, res->mean, res->max, res->pct);
+}
+
+static void run(size_t n, int reps, int window_pct)
+{
+    legacy_record_t *legacy = malloc(n * sizeof(*legacy));
+    sample_record_t *sample = malloc(n * sizeof(*sample));
+    uint16_t nblocks = (uint16_t)((n + HISTORY_COL_BLOCK_LEN - 1) / HISTORY_COL_BLOCK_LEN);
+    history_col_block_t *blocks = malloc(nblocks * sizeof(*blocks));
+    history_col_summary_t *summary = malloc(nblocks * sizeof(*summary));
+    history_columns_t cols;
+    history_columns_init(&cols, blocks, summary, nblocks);
+
+    uint32_t rng = 1;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t t_ms = BENCH_T0_MS + (uint32_t)i * BENCH_PERIOD_MS;
+        int32_t v = synth_value((uint32_t)i, &rng);
+        legacy[i] = (legacy_record_t){.ch2o_ugm3 = v * 0.123f, .ch2o_ppb = v / 10.0f, .timestamp = t_ms / 1000,
+                                      .count = (uint32_t)i};
+        sample[i] = (sample_record_t){.timestamp_ms = t_ms, .value = v, .seq = (uint16_t)i, .flags = 1};
+        history_columns_append(&cols, t_ms, v);
+    }
+    uint32_t from_ms = BENCH_T0_MS + (uint32_t)(n - n * (size_t)window_pct / 100) * BENCH_PERIOD_MS;
+
+    bench_result_t rl = {0}, rs = {0}, rr = {0}, rc = {0};
+    bench_legacy(legacy, n, from_ms, reps, &rl);
+    bench_sample(sample, n, from_ms, reps, &rs);
+    bench_columns_raw(&cols, from_ms, reps, &rr);
+    bench_columns(&cols, from_ms, reps, &rc);
+    const bench_result_t *check[] = {&rr, &rc};
+    for (int i = 0; i < 2; i++) {
+        const bench_result_t *r = check[i];
+        if (rs.max != r->max || rs.pct != r->pct || rs.mean - r->mean > 1e-6 || r->mean - rs.mean > 1e-6) {
+            fprintf(stderr, "mismatch: sample %.3f/%.1f/%.1f columns %.3f/%.1f/%.1f\n", rs.mean, rs.max, rs.pct,
+                    r->mean, r->max, r->pct);
+            exit(1);
+        }
+    }
+
+    print_row(n, "legacy", n * sizeof(*legacy), &rl, &rl);
+    print_row(n, "sample", n * sizeof(*sample), &rs, &rl);
+    print_row(n, "raw", nblocks * sizeof(*blocks), &rr, &rl);
+    print_row(n, "columns", nblocks * (sizeof(*blocks) + sizeof(*summary)), &rc, &rl);
+    free(legacy);
+    free(sample);
+    free(blocks);
+    free(summary);
+}
+
+int main(int argc, char **argv)
+{
+    const char *sizes = "4096,65536,1048576";
+    int reps = 20;
+    int window_pct = 50;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:w:")) != -1) {
+        switch (opt) {
+        case 'n': sizes = optarg; break;
+        case 'r': reps = atoi(optarg); break;
+        case 'w': window_pct = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n samples,...] [-r reps] [-w window_pct]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1 || window_pct < 1 || window_pct > 100) {
+        fprintf(stderr, "invalid -r or -w\n");
+        return 1;
+    }
+
+    printf("  samples layout     size_KB    mean_us     max_us     p%d_us  speedup     mean      max      p%d\n",
+           BENCH_PCT, BENCH_PCT);
+    char *list = strdup(sizes);
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        long n = atol(tok);
+        // 时间戳为 32 位毫秒，1 Hz 下约 4.29M 个样本后回绕
+        if (n < 2 || (n + HISTORY_COL_BLOCK_LEN - 1) / HISTORY_COL_BLOCK_LEN > UINT16_MAX ||
+            (uint64_t)n * BENCH_PERIOD_MS + BENCH_T0_MS > UINT32_MAX) {
+            fprintf(stderr, "skip invalid sample count %s\n", tok);
+            continue;
+        }
+        run((size_t)n, reps, window_pct);
+    }
+    free(list);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * 区间查询基准：在分区镜像文件上比较时间索引定位与从最旧扇区全量扫描
+ *
+ * 用法: history_bench [-s 扇区数列表] [-q 每组查询次数] [-w 查询窗口秒数] [-f 镜像文件]
+ * 例如: history_bench -s 32,256,1024,4096 -q 200 -w 3600
+ *
+ * 每组按 1 Hz、两个传感器交替写入合成记录，直到环被覆盖约四分之一，
+ * 然后模拟重启（重建索引），在保留区间内随机取窗口查询。
+ * flash 读取次数与平台无关，设备上的耗时可按每次读取约 20~50 us 估算。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "history_ring.h"
+
+#define BENCH_T0_S          1700000000u
+#define BENCH_SLACK_S       10
+#define BENCH_SENSORS       2
+
+typedef struct {
+    double   us;
+    uint64_t flash_reads;
+    uint64_t records;
+} bench_result_t;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static uint32_t fill(history_ring_t *r, uint32_t records)
+{
+    for (uint32_t i = 0; i < records; i++) {
+        const history_record_t rec = {
+            .t_s = BENCH_T0_S + i / BENCH_SENSORS,
+            .mean = 1000 + (int32_t)(i % 97),
+            .min = 100,
+            .max = 109,
+            .count = 1,
+            .sensor_id = i % BENCH_SENSORS,
+        };
+        if (history_ring_append(r, &rec) != ESP_OK) {
+            fprintf(stderr, "append failed at %u\n", i);
+            exit(1);
+        }
+    }
+    return BENCH_T0_S + (records - 1) / BENCH_SENSORS;
+}
+
+// 旧实现：从最旧扇区顺序扫描整个环，逐条比较时间
+static void query_scan(const history_ring_t *r, uint32_t from_s, uint32_t to_s, bench_result_t *res)
+{
+    history_ring_iter_t it;
+    history_ring_iter_begin(r, &it, 0, UINT32_MAX, 0);
+    const history_record_t *rec;
+    while ((rec = history_ring_iter_next(r, &it)) != NULL) {
+        if (rec->sensor_id == 0 && rec->t_s >= from_s && rec->t_s < to_s) {
+            res->records++;
+        }
+    }
+    res->flash_reads += it.flash_reads;
+}
+
+static void query_indexed(const history_ring_t *r, uint32_t from_s, uint32_t to_s, bench_result_t *res)
+{
+    history_ring_iter_t it;
+    history_ring_iter_begin(r, &it, from_s, to_s, BENCH_SLACK_S);
+    const history_record_t *rec;
+    while ((rec = history_ring_iter_next(r, &it)) != NULL) {
+        if (rec->sensor_id == 0) {
+            res->records++;
+        }
+    }
+    res->flash_reads += it.flash_reads;
+}
+
+static void run(uint16_t sectors, int queries, uint32_t window_s, const char *path)
+{
+    esp_partition_t part;
+    if (partition_file_open(&part, path, (uint32_t)sectors * HISTORY_SECTOR_SIZE) != ESP_OK) {
+        perror(path);
+        exit(1);
+    }
+    esp_partition_erase_range(&part, 0, part.size);
+
+    uint32_t *first_t = calloc(sectors, sizeof(uint32_t));
+    history_ring_t ring = {.part = &part, .first_t = first_t, .sectors = sectors};
+    history_ring_recover(&ring);
+    uint32_t records = (uint32_t)sectors * HISTORY_RECORDS_PER_SECTOR * 5 / 4;
+    uint32_t last_s = fill(&ring, records);
+
+    // 模拟重启：重建写入位置与时间索引
+    ring = (history_ring_t){.part = &part, .first_t = first_t, .sectors = sectors};
+    double t = now_us();
+    history_ring_recover(&ring);
+    double recover_ms = (now_us() - t) / 1000;
+
+    uint32_t oldest_s = last_s - (uint32_t)(sectors - 1) * HISTORY_RECORDS_PER_SECTOR / BENCH_SENSORS;
+    uint32_t span_s = last_s - oldest_s;
+    uint32_t window = window_s < span_s ? window_s : span_s / 2;
+    bench_result_t idx = {0}, scan = {0};
+    srand(sectors);
+    for (int q = 0; q < queries; q++) {
+        uint32_t from_s = oldest_s + (uint32_t)rand() % (span_s - window);
+        t = now_us();
+        query_indexed(&ring, from_s, from_s + window, &idx);
+        idx.us += now_us() - t;
+        t = now_us();
+        query_scan(&ring, from_s, from_s + window, &scan);
+        scan.us += now_us() - t;
+    }
+    if (idx.records != scan.records) {
+        fprintf(stderr, "mismatch: indexed %llu scan %llu\n", (unsigned long long)idx.records,
+                (unsigned long long)scan.records);
+        exit(1);
+    }
+
+    printf("%7u %8u %9u %8.2f %7u %10.1f %9.1f %10.1f %9.1f %7.1f\n", sectors, sectors * 4, ring.sectors *
+           (uint32_t)HISTORY_RECORDS_PER_SECTOR, recover_ms, window, idx.us / queries,
+           (double)idx.flash_reads / queries, scan.us / queries, (double)scan.flash_reads / queries,
+           (double)idx.records / queries);
+    free(first_t);
+    partition_file_close(&part);
+}
+
+int main(int argc, char **argv)
+{
+    const char *sizes = "32,256,1024,4096";
+    const char *path = "history_bench.img";
+    int queries = 200;
+    uint32_t window_s = 3600;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:q:w:f:")) != -1) {
+        switch (opt) {
+        case 's': sizes = optarg; break;
+        case 'q': queries = atoi(optarg); break;
+        case 'w': window_s = (uint32_t)atoi(optarg); break;
+        case 'f': path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-s sectors,...] [-q queries] [-w window_s] [-f image]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("sectors  size_KB   records recov_ms  window  index_us idx_reads    scan_us scan_reads   hits\n");
+    char *list = strdup(sizes);
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        int sectors = atoi(tok);
+        if (sectors < 2 || sectors > UINT16_MAX) {
+            fprintf(stderr, "skip invalid sector count %s\n", tok);
+            continue;
+        }
+        run((uint16_t)sectors, queries, window_s, path);
+    }
+    free(list);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef __HOST_ESP_ERR_H__
+#define __HOST_ESP_ERR_H__
+
+// 主机构建用的最小 esp_err.h
+
+typedef int esp_err_t;
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_INVALID_SIZE    0x104
+
+#endif // __HOST_ESP_ERR_H__
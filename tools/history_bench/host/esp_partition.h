@@ -0,0 +1,29 @@
+#ifndef __HOST_ESP_PARTITION_H__
+#define __HOST_ESP_PARTITION_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/**
+ * 主机构建用的 esp_partition 接口，分区内容是一个镜像文件（见 partition_file.c）
+ * 写入按 NOR flash 的语义只能把 1 变成 0，擦除后全为 0xFF。
+ */
+
+typedef struct {
+    int fd;
+    uint32_t size;
+} esp_partition_t;
+
+/**
+ * @brief 打开（不存在则创建）镜像文件并截断为 size 字节，内容不变
+ */
+esp_err_t partition_file_open(esp_partition_t *part, const char *path, uint32_t size);
+
+void partition_file_close(esp_partition_t *part);
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size);
+
+#endif // __HOST_ESP_PARTITION_H__
@@ -0,0 +1,76 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_partition.h"
+
+#define PARTITION_FILE_CHUNK    4096
+
+esp_err_t partition_file_open(esp_partition_t *part, const char *path, uint32_t size)
+{
+    part->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (part->fd < 0 || ftruncate(part->fd, size) != 0) {
+        return ESP_FAIL;
+    }
+    part->size = size;
+    return ESP_OK;
+}
+
+void partition_file_close(esp_partition_t *part)
+{
+    close(part->fd);
+    part->fd = -1;
+}
+
+static inline bool in_range(const esp_partition_t *part, size_t offset, size_t size)
+{
+    return offset <= part->size && size <= part->size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size)
+{
+    if (!in_range(part, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return pread(part->fd, dst, size, offset) == (ssize_t)size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size)
+{
+    if (!in_range(part, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t cur[PARTITION_FILE_CHUNK];
+    const uint8_t *in = src;
+    while (size) {
+        size_t n = size < sizeof(cur) ? size : sizeof(cur);
+        if (pread(part->fd, cur, n, offset) != (ssize_t)n) {
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < n; i++) {
+            cur[i] &= in[i];
+        }
+        if (pwrite(part->fd, cur, n, offset) != (ssize_t)n) {
+            return ESP_FAIL;
+        }
+        in += n;
+        offset += n;
+        size -= n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size)
+{
+    if (!in_range(part, offset, size) || offset % PARTITION_FILE_CHUNK || size % PARTITION_FILE_CHUNK) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t ff[PARTITION_FILE_CHUNK];
+    memset(ff, 0xFF, sizeof(ff));
+    for (size_t done = 0; done < size; done += sizeof(ff)) {
+        if (pwrite(part->fd, ff, sizeof(ff), offset + done) != (ssize_t)sizeof(ff)) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
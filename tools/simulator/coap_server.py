@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+本地 CoAP 遥测服务器
+
+接收固件 CONFIG_TELEMETRY_COAP 发出的 POST：对 CON 请求回复携带 2.04 Changed 的 ACK，
+NON 请求不回复。解码 12 字节样本与时间参考点文本，按固定间隔输出报文数、
+UDP/IP 字节数与每条消息的平均开销，可与固件 TELEMETRY_BENCH 日志对照。
+"""
+
+import argparse
+import random
+import socket
+import struct
+import time
+
+COAP_VERSION = 1
+TYPE_NAMES = {0: "CON", 1: "NON", 2: "ACK", 3: "RST"}
+TYPE_CON, TYPE_ACK, TYPE_RST = 0, 2, 3
+CODE_POST = 0x02
+CODE_CHANGED = 0x44              # 2.04
+OPTION_URI_PATH = 11
+UDP_IP_OVERHEAD = 28
+SAMPLE = struct.Struct("<IiHBB")
+# 通道号 -> (名称, 单位, 定点缩放)，与固件 sensor_channel.c 一致
+CHANNELS = {0: ("hcho", "ppb", 10), 1: ("co2", "ppm", 1), 2: ("pm25", "ug/m3", 10), 3: ("tvoc", "ppb", 1)}
+
+
+def parse_message(data):
+    """解析 CoAP 报文，返回 (type, code, mid, token, options, payload)"""
+    if len(data) < 4 or data[0] >> 6 != COAP_VERSION:
+        raise ValueError("not a CoAP v1 message")
+    mtype = (data[0] >> 4) & 0x03
+    tkl = data[0] & 0x0F
+    code = data[1]
+    mid = (data[2] << 8) | data[3]
+    token = data[4:4 + tkl]
+    pos = 4 + tkl
+    number = 0
+    options = []
+    payload = b""
+    while pos < len(data):
+        if data[pos] == 0xFF:
+            payload = data[pos + 1:]
+            break
+        delta, length = data[pos] >> 4, data[pos] & 0x0F
+        pos += 1
+        for name in ("delta", "length"):
+            value = delta if name == "delta" else length
+            if value == 13:
+                value = data[pos] + 13
+                pos += 1
+            elif value == 14:
+                value = ((data[pos] << 8) | data[pos + 1]) + 269
+                pos += 2
+            if name == "delta":
+                delta = value
+            else:
+                length = value
+        number += delta
+        options.append((number, data[pos:pos + length]))
+        pos += length
+    return mtype, code, mid, token, options, payload
+
+
+def describe(path, payload):
+    if len(payload) == SAMPLE.size:
+        ts, value, seq, ids, flags = SAMPLE.unpack(payload)
+        name, unit, scale = CHANNELS.get(ids & 0x0F, ("ch%d" % (ids & 0x0F), "", 1))
+        return "%s sensor %d %s seq %d t=%d ms value %g %s flags 0x%02x" % (
+            path, ids >> 4, name, seq, ts, value / scale, unit, flags)
+    return "%s %s" % (path, payload.decode(errors="replace"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="本地 CoAP 遥测服务器")
+    parser.add_argument("--host", default="0.0.0.0", help="监听地址（默认 0.0.0.0）")
+    parser.add_argument("--port", type=int, default=5683, help="监听端口（默认 5683）")
+    parser.add_argument("--interval", type=float, default=60.0, help="统计输出间隔秒数（默认 60）")
+    parser.add_argument("--drop", type=float, default=0.0, help="故意不回复 CON 的比例，用于观察重传（默认 0）")
+    parser.add_argument("--verbose", action="store_true", help="逐条打印解码后的消息")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.host, args.port))
+    sock.settimeout(1.0)
+    print("监听 coap://%s:%d" % (args.host, args.port))
+
+    stats = {"rx": 0, "rx_bytes": 0, "tx": 0, "tx_bytes": 0, "dup": 0, "payload": 0}
+    seen = {}
+    next_report = time.monotonic() + args.interval
+    while True:
+        try:
+            data, addr = sock.recvfrom(1500)
+        except socket.timeout:
+            data = None
+        except KeyboardInterrupt:
+            break
+        if data is not None:
+            stats["rx"] += 1
+            stats["rx_bytes"] += len(data) + UDP_IP_OVERHEAD
+            try:
+                mtype, code, mid, token, options, payload = parse_message(data)
+            except (ValueError, IndexError) as exc:
+                print("无法解析 %d 字节: %s" % (len(data), exc))
+                continue
+            # 按 (来源, 消息 ID) 去重，重传的 CON 只再回 ACK 不重复计数
+            key = (addr, mid)
+            duplicate = key in seen
+            seen[key] = time.monotonic()
+            if duplicate:
+                stats["dup"] += 1
+            else:
+                stats["payload"] += len(payload)
+                if args.verbose:
+                    path = "/".join(v.decode(errors="replace") for n, v in options if n == OPTION_URI_PATH)
+                    print("%s %s" % (TYPE_NAMES[mtype], describe(path, payload)))
+            if mtype == TYPE_CON:
+                if random.random() < args.drop:
+                    continue
+                reply = bytes([(COAP_VERSION << 6) | (TYPE_ACK << 4) | len(token), CODE_CHANGED,
+                               mid >> 8, mid & 0xFF]) + token
+                sock.sendto(reply, addr)
+                stats["tx"] += 1
+                stats["tx_bytes"] += len(reply) + UDP_IP_OVERHEAD
+
+        now = time.monotonic()
+        if now >= next_report:
+            unique = stats["rx"] - stats["dup"]
+            print("%d 条（重传 %d），收 %d B，回 ACK %d 条 %d B，负载 %d B，平均每条 %.1f B 上行" % (
+                unique, stats["dup"], stats["rx_bytes"], stats["tx"], stats["tx_bytes"], stats["payload"],
+                stats["rx_bytes"] / max(stats["rx"], 1)))
+            stats = dict.fromkeys(stats, 0)
+            seen = {k: t for k, t in seen.items() if now - t < 300}
+            next_report = now + args.interval
+
+
+if __name__ == "__main__":
+    main()
@@ -17,16 +17,19 @@ from typing import List, Optional
 class DartSensorSimulator:
     """Dart传感器模拟器"""
     
-    def __init__(self, port: str, baudrate: int = 9600):
+    def __init__(self, port: str, baudrate: int = 9600, spike_rate: float = 0.0):
         """
         初始化模拟器
         
         Args:
             port: 串口端口
             baudrate: 波特率
+            spike_rate: 每个样本注入单点尖峰的概率 (0~1)，用于验证固件滤波
         """
         self.port = port
         self.baudrate = baudrate
+        self.spike_rate = spike_rate
+        self.spike_count = 0
         self.mode = "active"  # 默认主动上传模式
         self.serial_conn = None
         self.running = False
@@ -63,13 +66,25 @@ class DartSensorSimulator:
         checksum = (~checksum + 1) & 0xFF
         return checksum
     
+    def sample_concentration(self) -> int:
+        """
+        返回本次上报的浓度值，按 spike_rate 随机叠加一个单点尖峰
+        """
+        if self.spike_rate > 0 and random.random() < self.spike_rate:
+            self.spike_count += 1
+            spike = self.current_concentration + random.randint(200, 800)
+            print(f"⚡ 注入尖峰 #{self.spike_count}: {spike} ppb")
+            return min(spike, 0xFFFF)
+        return self.current_concentration
+
     def generate_active_upload_data(self) -> bytes:
         """
         生成主动上传数据包
         """
+        concentration = self.sample_concentration()
         # 将浓度值分解为高低字节
-        concentration_high = (self.current_concentration >> 8) & 0xFF
-        concentration_low = self.current_concentration & 0xFF
+        concentration_high = (concentration >> 8) & 0xFF
+        concentration_low = concentration & 0xFF
         
         data = [
             0xFF,  # 起始位
@@ -86,7 +101,7 @@ class DartSensorSimulator:
         # 计算校验和
         data[8] = self.calculate_checksum(data)
         
-        print(f"📤 主动上传: 浓度={self.current_concentration} ppb, "
+        print(f"📤 主动上传: 浓度={concentration} ppb, "
               f"数据包={' '.join([f'0x{x:02X}' for x in data])}")
         
         return bytes(data)
@@ -177,7 +192,7 @@ class DartSensorSimulator:
         elif data[1] == 0x01 and data[2] == 0x86:  # 读取气体浓度命令
             if self.mode == "qa":
                 print("📖 收到读取浓度命令")
-                return self.generate_qa_response(self.current_concentration)
+                return self.generate_qa_response(self.sample_concentration())
             else:
                 print("⚠️  当前为主动上传模式，忽略读取命令")
         
@@ -288,6 +303,8 @@ def main():
     parser = argparse.ArgumentParser(description="Dart WZ-S-K 甲醛传感器模拟器")
     parser.add_argument("--port", help="串口端口 (例如: COM3, /dev/ttyUSB0)")
     parser.add_argument("--baudrate", "-b", type=int, default=9600, help="波特率 (默认: 9600)")
+    parser.add_argument("--spike-rate", type=float, default=0.0,
+                        help="每个样本注入单点尖峰的概率 0~1 (默认: 0，不注入)")
     
     args = parser.parse_args()
     
@@ -295,7 +312,7 @@ def main():
     print("=" * 50)
     
     # 创建并启动模拟器
-    simulator = DartSensorSimulator(args.port, args.baudrate)
+    simulator = DartSensorSimulator(args.port, args.baudrate, args.spike_rate)
     simulator.start()
 
 
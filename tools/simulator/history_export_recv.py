@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""
+长期历史导出接收端
+
+接收固件以 chunked POST 上传的 storage 分区扇区（CONFIG_HISTORY_EXPORT_URL），
+按扇区头解析记录，打印各层的扇区数、记录数、时间范围以及接收端测得的吞吐。
+
+扇区格式（小端）：
+    扇区头 16B: magic "HIST", seq u32, tier u8, 保留 u8, first_sector u16, sectors u16, 保留 u16
+    记录   16B: t_s u32, mean i32, min i16, max i16, count u16, sensor_id:4|channel:4 u8, flags u8
+"""
+
+import argparse
+import struct
+import time
+from http.server import BaseHTTPRequestHandler, HTTPServer
+
+SECTOR_MAGIC = 0x54534948
+HEADER = struct.Struct("<IIBBHHH")
+RECORD = struct.Struct("<IihhHBB")
+TIER_NAMES = ["raw", "1min", "1h"]
+
+
+def parse_sector(data):
+    """解析一个扇区负载，返回 (tier, seq, records)"""
+    magic, seq, tier, _, _, _, _ = HEADER.unpack_from(data, 0)
+    if magic != SECTOR_MAGIC:
+        raise ValueError("bad sector magic 0x%08x" % magic)
+    records = []
+    for off in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        t_s, mean, vmin, vmax, count, ids, flags = RECORD.unpack_from(data, off)
+        records.append((t_s, ids & 0x0F, ids >> 4, mean, vmin, vmax, count, flags))
+    return tier, seq, records
+
+
+class ExportHandler(BaseHTTPRequestHandler):
+    def read_chunks(self):
+        """逐个读取 chunked 编码的块，每块即一个扇区"""
+        while True:
+            size = int(self.rfile.readline().split(b";")[0], 16)
+            if size == 0:
+                self.rfile.readline()
+                return
+            chunk = self.rfile.read(size)
+            self.rfile.readline()
+            yield chunk
+
+    def do_POST(self):
+        start = time.monotonic()
+        total = 0
+        tiers = {}
+        for chunk in self.read_chunks():
+            total += len(chunk)
+            tier, seq, records = parse_sector(chunk)
+            info = tiers.setdefault(tier, {"sectors": 0, "records": 0, "first": None, "last": None})
+            info["sectors"] += 1
+            info["records"] += len(records)
+            if records:
+                first, last = records[0][0], records[-1][0]
+                info["first"] = first if info["first"] is None else min(info["first"], first)
+                info["last"] = last if info["last"] is None else max(info["last"], last)
+            if self.server.out:
+                self.server.out.write(chunk)
+        elapsed = time.monotonic() - start
+
+        self.send_response(200)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+        print("收到 %d 字节，用时 %.2f s，%.1f KB/s" % (total, elapsed, total / 1024 / max(elapsed, 1e-6)))
+        for tier in sorted(tiers):
+            info = tiers[tier]
+            name = TIER_NAMES[tier] if tier < len(TIER_NAMES) else str(tier)
+            span = ""
+            if info["first"] is not None:
+                span = "  %s ~ %s" % (time.strftime("%Y-%m-%d %H:%M:%S", time.gmtime(info["first"])),
+                                      time.strftime("%Y-%m-%d %H:%M:%S", time.gmtime(info["last"])))
+            print("  %-5s %3d 扇区 %7d 条%s" % (name, info["sectors"], info["records"], span))
+
+    def log_message(self, fmt, *args):
+        pass
+
+
+def main():
+    parser = argparse.ArgumentParser(description="接收并解析固件导出的长期历史")
+    parser.add_argument("--host", default="0.0.0.0", help="监听地址（默认 0.0.0.0）")
+    parser.add_argument("--port", type=int, default=8080, help="监听端口（默认 8080）")
+    parser.add_argument("--out", help="把收到的扇区原样追加写入该文件")
+    args = parser.parse_args()
+
+    server = HTTPServer((args.host, args.port), ExportHandler)
+    server.out = open(args.out, "ab") if args.out else None
+    print("等待导出: http://%s:%d/history" % (args.host, args.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if server.out:
+            server.out.close()
+
+
+if __name__ == "__main__":
+    main()
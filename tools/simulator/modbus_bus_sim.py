@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RS-485 Modbus RTU 多点总线轮询基准（主机端离散事件仿真）
+
+按固件 sensor_bus.c 的时序模型计算一条总线每秒能轮询到的传感器数：
+  - 请求 8 字节、读单寄存器应答 7 字节，8N1 每字节 10 位
+  - 从站转向时间在给定范围内随机
+  - 无应答时主站等满应答超时
+对比三种轮询策略：
+  naive      串行的请求/应答循环：t3.5 静默、传输、解析/发布依次进行，死节点每轮都等满超时
+  pipelined  收到应答后先发下一个请求再处理（处理与传输重叠）
+  backoff    pipelined + 健康监督的指数退避，FAILED 节点按 1s, 2s, 4s ... 探测
+
+固件在加入 sensor_bus.c 之前没有总线轮询，naive 是同样帧间静默与超时下最直接的实现，默认不加额外延时；
+--naive-gap-ms 可模拟在循环中加固定 vTaskDelay 的写法。
+本脚本只按上述参数计算时序，不运行 modbus_rtu.c / sensor_bus.c 的代码，结果需与固件日志中的实测 sensors/s 对照。
+"""
+
+import argparse
+import random
+from typing import Dict, List, Tuple
+
+REQ_BYTES = 8
+RESP_BYTES = 7
+BITS_PER_BYTE = 10
+
+
+def t35_s(baud: int) -> float:
+    """帧间静默 t3.5，与 modbus_t35_us() 一致"""
+    if baud > 19200:
+        return 1750e-6
+    return 3.5 * 11 / baud
+
+
+class NodeHealth:
+    """sensor_health.c 中与退避相关的最小子集"""
+
+    def __init__(self, fail_count: int, backoff_min: float, backoff_max: float):
+        self.fail_count = fail_count
+        self.backoff_min = backoff_min
+        self.backoff_max = backoff_max
+        self.failed = False
+        self.consecutive_ok = 0
+        self.consecutive_fail = 0
+        self.backoff = backoff_min
+        self.next_recovery = 0.0
+
+    def skipped(self, now: float) -> bool:
+        return self.failed and self.consecutive_ok == 0 and now < self.next_recovery
+
+    def update(self, ok: bool, now: float):
+        probing = self.failed and now >= self.next_recovery
+        if ok:
+            self.consecutive_fail = 0
+            self.consecutive_ok += 1
+        else:
+            self.consecutive_ok = 0
+            self.consecutive_fail += 1
+        if not self.failed and self.consecutive_fail >= self.fail_count:
+            self.failed = True
+            self.backoff = self.backoff_min
+            self.next_recovery = now
+        elif self.failed and self.consecutive_ok >= 2:
+            self.failed = False
+        if probing:
+            self.next_recovery = now + self.backoff
+            self.backoff = min(self.backoff * 2, self.backoff_max)
+
+
+class BusSimulator:
+    """单条总线的轮询仿真"""
+
+    def __init__(self, args: argparse.Namespace, nodes: int, strategy: str, seed: int):
+        self.args = args
+        self.nodes = nodes
+        self.strategy = strategy
+        self.rng = random.Random(seed)
+        self.byte_s = BITS_PER_BYTE / args.baud
+        # 至少保留一个活节点，死节点排在总线末尾
+        self.dead = set(range(nodes - min(args.dead, nodes - 1), nodes))
+        self.health = [NodeHealth(args.fail_count, args.backoff_min_ms / 1000, args.backoff_max_ms / 1000)
+                       for _ in range(nodes)]
+
+    def transaction(self, node: int) -> Tuple[float, bool]:
+        """一次请求/应答占用总线的时间，以及是否收到有效应答"""
+        tx = REQ_BYTES * self.byte_s
+        if node in self.dead or self.rng.random() < self.args.loss:
+            return tx + self.args.timeout_ms / 1000, False
+        turn = self.rng.uniform(self.args.turnaround_min_ms, self.args.turnaround_max_ms) / 1000
+        return tx + turn + RESP_BYTES * self.byte_s, True
+
+    def run(self) -> Dict[str, float]:
+        args = self.args
+        now = 0.0
+        ok_polls = 0
+        timeouts = 0
+        cycles = 0
+        process = args.process_ms / 1000
+        gap = t35_s(args.baud)
+        while now < args.duration_s:
+            cycle_start = now
+            for node in range(self.nodes):
+                health = self.health[node]
+                if self.strategy == "backoff" and health.skipped(now):
+                    continue
+                busy, ok = self.transaction(node)
+                if self.strategy == "naive":
+                    # 处理与发布串行执行，完成后再等 t3.5（及可选的固定延时）发下一个请求
+                    now += gap + busy + process + args.naive_gap_ms / 1000
+                else:
+                    # 下一个请求在 t3.5 后立即发出，处理与下一次传输并行，只有超出部分会拖慢总线
+                    now += gap + busy + max(0.0, process - (REQ_BYTES * self.byte_s + gap))
+                health.update(ok, now)
+                ok_polls += ok
+                timeouts += not ok
+            cycles += 1
+            if args.cycle_ms > 0:
+                # 固件按固定周期调度，轮询提前结束时等到下一个节拍
+                now = max(now, cycle_start + args.cycle_ms / 1000)
+        return {
+            "sensors_per_s": ok_polls / now,
+            "timeouts_per_s": timeouts / now,
+            "cycle_ms": now / cycles * 1000,
+        }
+
+
+def parse_nodes(text: str) -> List[int]:
+    return [int(x) for x in text.split(",") if x.strip()]
+
+
+def main():
+    """命令行入口"""
+    parser = argparse.ArgumentParser(description="RS-485 Modbus 多点总线轮询基准")
+    parser.add_argument("--nodes", type=parse_nodes, default=[1, 2, 4, 8, 14],
+                        help="逗号分隔的节点数列表 (默认: 1,2,4,8,14)")
+    parser.add_argument("--baud", type=int, default=19200, help="波特率 (默认: 19200)")
+    parser.add_argument("--dead", type=int, default=1, help="不应答的死节点数 (默认: 1)")
+    parser.add_argument("--loss", type=float, default=0.01, help="活节点单次应答丢失概率 (默认: 0.01)")
+    parser.add_argument("--turnaround-min-ms", type=float, default=2.0, help="从站最短转向时间 (默认: 2)")
+    parser.add_argument("--turnaround-max-ms", type=float, default=8.0, help="从站最长转向时间 (默认: 8)")
+    parser.add_argument("--timeout-ms", type=float, default=50.0,
+                        help="应答超时，对应 CONFIG_SENSOR_BUS_RESPONSE_TIMEOUT_MS (默认: 50)")
+    parser.add_argument("--process-ms", type=float, default=2.0, help="主站解析+入队耗时 (默认: 2)")
+    parser.add_argument("--naive-gap-ms", type=float, default=0.0, help="naive 策略每次轮询后的额外固定延时 (默认: 0)")
+    parser.add_argument("--cycle-ms", type=float, default=0.0,
+                        help="轮询周期，0 表示背靠背测最大吞吐 (默认: 0)")
+    parser.add_argument("--fail-count", type=int, default=2,
+                        help="判定 FAILED 的连续失败次数，对应 CONFIG_SENSOR_HEALTH_FAIL_COUNT (默认: 2)")
+    parser.add_argument("--backoff-min-ms", type=float, default=1000.0, help="初始退避 (默认: 1000)")
+    parser.add_argument("--backoff-max-ms", type=float, default=60000.0, help="最大退避 (默认: 60000)")
+    parser.add_argument("--duration-s", type=float, default=600.0, help="仿真时长 (默认: 600)")
+    parser.add_argument("--seed", type=int, default=1, help="随机种子 (默认: 1)")
+    args = parser.parse_args()
+
+    print(f"baud {args.baud}, t3.5 {t35_s(args.baud) * 1e6:.0f} us, dead nodes {args.dead}, "
+          f"loss {args.loss:.2%}, timeout {args.timeout_ms:.0f} ms")
+    print(f"{'nodes':>5} {'strategy':>10} {'sensors/s':>10} {'timeouts/s':>11} {'cycle ms':>9} {'speedup':>8}")
+    for nodes in args.nodes:
+        baseline = None
+        for strategy in ("naive", "pipelined", "backoff"):
+            r = BusSimulator(args, nodes, strategy, args.seed).run()
+            if baseline is None:
+                baseline = r["sensors_per_s"]
+            speedup = r["sensors_per_s"] / baseline if baseline else float("nan")
+            print(f"{nodes:>5} {strategy:>10} {r['sensors_per_s']:>10.1f} {r['timeouts_per_s']:>11.2f} "
+                  f"{r['cycle_ms']:>9.1f} {speedup:>7.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,25 @@
+#!/bin/sh
+# 生成本地测试用 CA 与 broker 证书，并把 CA 复制到固件默认的 CONFIG_MQTT_BROKER_CA_FILE
+# 用法：./gen_certs.sh <broker 的 IP 或主机名>
+set -e
+
+HOST=${1:?usage: $0 <broker ip or hostname>}
+cd "$(dirname "$0")"
+mkdir -p certs data
+
+case "$HOST" in
+    *[!0-9.]*) SAN="DNS:$HOST" ;;
+    *) SAN="IP:$HOST" ;;
+esac
+
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 3650 \
+    -subj "/CN=air-quality test CA" -keyout certs/ca.key -out certs/ca.crt
+openssl req -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes \
+    -subj "/CN=$HOST" -keyout certs/server.key -out certs/server.csr
+printf "subjectAltName=%s\n" "$SAN" > certs/server.ext
+openssl x509 -req -in certs/server.csr -CA certs/ca.crt -CAkey certs/ca.key -CAcreateserial \
+    -days 3650 -extfile certs/server.ext -out certs/server.crt
+
+mkdir -p ../../../certs
+cp certs/ca.crt ../../../certs/broker_ca.pem
+echo "CA copied to certs/broker_ca.pem in the project directory"
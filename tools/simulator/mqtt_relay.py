@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+MQTT 连接开销测量中继
+
+在固件与本地 mosquitto 之间转发 TCP 字节流（不解密 TLS），对每条连接分别统计：
+  - 建立阶段：从 TCP 连接到首次出现 --settle 毫秒空闲为止的上下行字节与耗时，
+    即 TLS 握手 + CONNECT/CONNACK + 重新订阅的开销
+  - 整条连接的上下行字节与持续时间
+可选 --cut 每隔若干秒主动断开连接，制造重连以对比完整握手与会话票据恢复、
+新会话与持久会话的差异。统计均为 TCP 负载字节，不含 IP/TCP 头。
+"""
+
+import argparse
+import asyncio
+import itertools
+import time
+
+CHUNK = 4096
+
+
+class Connection:
+    """一条被转发的连接的计数"""
+
+    def __init__(self, cid, peer):
+        self.cid = cid
+        self.peer = peer
+        self.opened = time.monotonic()
+        self.last_io = self.opened
+        self.up = 0
+        self.down = 0
+        self.setup = None  # (上行, 下行, 耗时秒)
+
+    def note(self, direction, count):
+        now = time.monotonic()
+        if direction == "up":
+            self.up += count
+        else:
+            self.down += count
+        self.last_io = now
+
+
+async def pump(reader, writer, conn, direction):
+    try:
+        while True:
+            data = await reader.read(CHUNK)
+            if not data:
+                break
+            conn.note(direction, len(data))
+            writer.write(data)
+            await writer.drain()
+    except (ConnectionError, asyncio.CancelledError):
+        pass
+    finally:
+        writer.close()
+
+
+async def watch_setup(conn, settle):
+    """首次空闲 settle 秒时记下建立阶段的字节数"""
+    while conn.setup is None:
+        await asyncio.sleep(settle / 4)
+        now = time.monotonic()
+        if (conn.up or conn.down) and now - conn.last_io >= settle:
+            conn.setup = (conn.up, conn.down, conn.last_io - conn.opened)
+            print("#%d %s 建立阶段：上行 %d B，下行 %d B，%.0f ms" % (
+                conn.cid, conn.peer, conn.setup[0], conn.setup[1], conn.setup[2] * 1000))
+
+
+async def handle(client_reader, client_writer, args, counter, totals):
+    conn = Connection(next(counter), "%s:%d" % client_writer.get_extra_info("peername")[:2])
+    try:
+        server_reader, server_writer = await asyncio.open_connection(args.broker_host, args.broker_port)
+    except OSError as exc:
+        print("#%d 无法连接 broker: %s" % (conn.cid, exc))
+        client_writer.close()
+        return
+    print("#%d %s 已连接" % (conn.cid, conn.peer))
+    tasks = [
+        asyncio.ensure_future(pump(client_reader, server_writer, conn, "up")),
+        asyncio.ensure_future(pump(server_reader, client_writer, conn, "down")),
+    ]
+    watcher = asyncio.ensure_future(watch_setup(conn, args.settle / 1000.0))
+    timeout = args.cut if args.cut > 0 else None
+    done, pending = await asyncio.wait(tasks, timeout=timeout, return_when=asyncio.FIRST_COMPLETED)
+    for task in pending:
+        task.cancel()
+    watcher.cancel()
+    client_writer.close()
+    server_writer.close()
+
+    duration = time.monotonic() - conn.opened
+    reason = "主动断开" if not done else "对端关闭"
+    print("#%d %s %s：共 %.1f s，上行 %d B，下行 %d B" % (
+        conn.cid, conn.peer, reason, duration, conn.up, conn.down))
+    if conn.setup:
+        totals.append(conn.setup)
+        n = len(totals)
+        print("   建立阶段累计 %d 次：平均上行 %.0f B，下行 %.0f B，%.0f ms" % (
+            n, sum(s[0] for s in totals) / n, sum(s[1] for s in totals) / n,
+            sum(s[2] for s in totals) / n * 1000))
+
+
+async def serve(args):
+    counter = itertools.count(1)
+    totals = []
+    server = await asyncio.start_server(
+        lambda r, w: handle(r, w, args, counter, totals), args.host, args.port)
+    print("监听 %s:%d -> %s:%d" % (args.host, args.port, args.broker_host, args.broker_port))
+    async with server:
+        await server.serve_forever()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="MQTT 连接开销测量中继")
+    parser.add_argument("--host", default="0.0.0.0", help="监听地址（默认 0.0.0.0）")
+    parser.add_argument("--port", type=int, default=18883, help="监听端口（默认 18883）")
+    parser.add_argument("--broker-host", default="127.0.0.1", help="mosquitto 地址（默认 127.0.0.1）")
+    parser.add_argument("--broker-port", type=int, default=8883, help="mosquitto 端口（默认 8883）")
+    parser.add_argument("--settle", type=float, default=500.0,
+                        help="判定建立阶段结束的空闲毫秒数（默认 500）")
+    parser.add_argument("--cut", type=float, default=0.0,
+                        help="每条连接保持多少秒后主动断开以触发重连，0 为不断开（默认 0）")
+    args = parser.parse_args()
+    try:
+        asyncio.run(serve(args))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()